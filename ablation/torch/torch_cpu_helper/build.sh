@@ -12,6 +12,7 @@ clang++ -fsanitize=fuzzer \
          -std=c++17 \
          -I/. \
          main.cpp fuzzer_utils.cpp \
+         -Wl,--wrap=LLVMFuzzerTestOneInput \
          -Wl,-rpath,/root/pytorch/build-fuzz/caffe2/CMakeFiles/torch_cpu.dir/__/aten/src/ATen \
          -L/root/pytorch/build-fuzz/caffe2/CMakeFiles/torch_cpu.dir/__/aten/src/ATen \
          -Wl,-rpath,/root/pytorch/build-fuzz/c10/CMakeFiles/c10.dir/core/ \
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""
+Measure per-API fuzzing throughput (exec/s) under different build variants.
+
+Each variant is a set of extra compiler flags passed to the API's build.sh
+through EXTRA_CXXFLAGS. For every API and variant the harness is rebuilt,
+run for a fixed number of inputs on a fresh copy of its seed corpus, and the
+`stat::average_exec_per_sec` reported by libFuzzer is recorded.
+
+Run it from the fuzz root inside the container (where build_test_harness.py
+placed the API directories), e.g.:
+  python3 bench_exec_rate.py --preset graph_opt --apis tf.raw_ops.Add tf.raw_ops.Abs
+  python3 bench_exec_rate.py --preset inference_mode --apis torch.add torch.matmul
+  python3 bench_exec_rate.py --preset structured_matrix --apis torch.linalg.inv torch.linalg.cholesky
+  python3 bench_exec_rate.py --variant base= --variant kernel=-DTF_FUZZ_BACKEND=1 --apis tf.raw_ops.Add
+
+Outputs:
+  - Prints one line per API with exec/s per variant and the speedup over the first variant
+    (plus the share of inputs the harness accepted, for torch harnesses)
+  - Writes `exec_rate.csv` under the fuzz root
+"""
+
+import argparse
+import csv
+import glob
+import os
+import re
+import shutil
+import subprocess
+import tempfile
+from typing import Dict, List, Optional, Tuple
+
+
+PRESETS: Dict[str, List[Tuple[str, str]]] = {
+    # Grappler / graph optimizer on vs. off in every TF session.
+    "graph_opt": [
+        ("graph-opt", "-DTF_FUZZ_DISABLE_GRAPH_OPTIMIZATION=0"),
+        ("no-graph-opt", "-DTF_FUZZ_DISABLE_GRAPH_OPTIMIZATION=1"),
+    ],
+    # Torch inputs with autograd dispatch vs. the default c10::InferenceMode.
+    "inference_mode": [
+        ("autograd", "-DFUZZ_AUTOGRAD="),
+        ("inference-mode", ""),
+    ],
+    # Raw input bytes vs. structured (SPD, invertible, ...) linalg matrices.
+    "structured_matrix": [
+        ("raw-matrix", "-DFUZZ_STRUCTURED_MATRICES=0"),
+        ("structured-matrix", ""),
+    ],
+}
+
+EXEC_RATE_RE = re.compile(r"stat::average_exec_per_sec:\s*(\d+)")
+EXEC_UNITS_RE = re.compile(r"stat::number_of_executed_units:\s*(\d+)")
+VALID_RATIO_RE = re.compile(r"stat::fuzz_valid_input_ratio:\s*([\d.]+)")
+
+
+def parse_variant(text: str) -> Tuple[str, str]:
+    name, _, flags = text.partition("=")
+    if not name:
+        raise argparse.ArgumentTypeError(f"Variant must look like name=flags, got '{text}'")
+    return name, flags
+
+
+def build_api(api_dir: str, flags: str) -> bool:
+    env = os.environ.copy()
+    env["EXTRA_CXXFLAGS"] = flags
+    with open(os.path.join(api_dir, "build.log"), "w") as log:
+        result = subprocess.run(["bash", "build.sh"], cwd=api_dir, env=env, stdout=log, stderr=subprocess.STDOUT)
+    return result.returncode == 0 and os.path.exists(os.path.join(api_dir, "fuzz"))
+
+
+def ensure_seeds(api_dir: str) -> str:
+    corpus = os.path.join(api_dir, "corpus")
+    if not glob.glob(os.path.join(corpus, "*")):
+        subprocess.run(["python3", "random_seed.py"], cwd=api_dir, stdout=subprocess.DEVNULL, check=False)
+    return corpus
+
+
+def run_api(api_dir: str, seeds: str, runs: int, timeout: int) -> Tuple[Optional[int], Optional[int], Optional[float]]:
+    """Return (exec_per_sec, executed_units, valid_input_ratio) for one run of the current binary.
+
+    The valid input ratio (inputs the harness did not reject) is only reported by the torch runtime.
+    """
+    env = os.environ.copy()
+    env.setdefault("OMP_NUM_THREADS", "1")
+    env.setdefault("TF_NUM_INTRAOP_THREADS", "1")
+    env.setdefault("TF_NUM_INTEROP_THREADS", "1")
+    env.setdefault("TF_CPP_MIN_LOG_LEVEL", "3")
+    env.setdefault("ASAN_OPTIONS", "detect_leaks=0")
+    env["FUZZ_INPUT_STATS"] = "1"
+    with tempfile.TemporaryDirectory(prefix="bench_corpus_") as corpus:
+        for seed in glob.glob(os.path.join(seeds, "*")):
+            shutil.copy2(seed, corpus)
+        cmd = ["./fuzz", corpus, f"-runs={runs}", "-seed=1", "-max_len=128", "-timeout=2",
+               "-print_final_stats=1", "-ignore_crashes=1"]
+        try:
+            result = subprocess.run(cmd, cwd=api_dir, env=env, stdout=subprocess.DEVNULL,
+                                    stderr=subprocess.PIPE, text=True, errors="ignore", timeout=timeout)
+            output = result.stderr
+        except subprocess.TimeoutExpired:
+            return None, None, None
+    rate = EXEC_RATE_RE.search(output)
+    units = EXEC_UNITS_RE.search(output)
+    valid = VALID_RATIO_RE.search(output)
+    return ((int(rate.group(1)) if rate else None), (int(units.group(1)) if units else None),
+            (float(valid.group(1)) if valid else None))
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Compare per-API exec/s across build variants.")
+    ap.add_argument("--root", default=".", help="Fuzz root containing the API directories (default: .)")
+    ap.add_argument("--apis", nargs="*", default=None, help="APIs to benchmark (default: all tf.*/torch.* dirs)")
+    ap.add_argument("--preset", choices=sorted(PRESETS), help="Use a predefined set of variants")
+    ap.add_argument("--variant", action="append", type=parse_variant, default=[],
+                    help="Variant as name=extra_cxxflags; may be repeated")
+    ap.add_argument("--runs", type=int, default=2000, help="Inputs executed per measurement (default: 2000)")
+    ap.add_argument("--timeout", type=int, default=600, help="Wall-clock limit per measurement in seconds")
+    ap.add_argument("--csv", default="exec_rate.csv", help="CSV filename to write under root")
+    args = ap.parse_args()
+
+    variants = list(PRESETS[args.preset]) if args.preset else []
+    variants += args.variant
+    if not variants:
+        ap.error("Give --preset or at least one --variant")
+
+    root = os.path.abspath(args.root)
+    apis = args.apis or sorted(os.path.basename(d) for d in glob.glob(os.path.join(root, "tf.*")) +
+                               glob.glob(os.path.join(root, "torch.*")) if os.path.isdir(d))
+
+    rows: List[Dict[str, object]] = []
+    for api in apis:
+        api_dir = os.path.join(root, api)
+        seeds = ensure_seeds(api_dir)
+        rates: List[Optional[int]] = []
+        valid_ratios: List[Optional[float]] = []
+        for name, flags in variants:
+            if not build_api(api_dir, flags):
+                print(f"Build failed for {api} ({name}); see {api_dir}/build.log")
+                rates.append(None)
+                valid_ratios.append(None)
+                continue
+            rate, units, valid = run_api(api_dir, seeds, args.runs, args.timeout)
+            rates.append(rate)
+            valid_ratios.append(valid)
+            rows.append({"api": api, "variant": name, "flags": flags, "exec_per_sec": rate,
+                         "executed_units": units, "valid_input_ratio": valid})
+
+        base = rates[0]
+        cells = []
+        for (name, _), rate, valid in zip(variants, rates, valid_ratios):
+            speedup = f" x{rate / base:.2f}" if rate and base else ""
+            validity = f" valid={valid:.0%}" if valid is not None else ""
+            cells.append(f"{name}={rate if rate is not None else 'n/a'}{speedup}{validity}")
+        print(f"- {api}: " + " ".join(cells))
+
+        # Leave the default binary behind for regular fuzzing runs.
+        build_api(api_dir, "")
+
+    csv_path = os.path.join(root, args.csv)
+    try:
+        with open(csv_path, "w", newline="") as cf:
+            writer = csv.DictWriter(cf, fieldnames=["api", "variant", "flags", "exec_per_sec", "executed_units",
+                                                    "valid_input_ratio"])
+            writer.writeheader()
+            for row in rows:
+                writer.writerow(row)
+        print(f"Wrote: {csv_path}")
+    except Exception as e:
+        print(f"Failed to write CSV: {e}")
+
+
+if __name__ == "__main__":
+    main()
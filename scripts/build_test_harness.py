@@ -49,6 +49,11 @@ def build_tf() -> None:
     print(f"Found {total_dirs} TensorFlow API directories to build in parallel.")
     success_count = 0
 
+    # The shared runtime is compiled once here and linked by every harness.
+    ret_code, output = run_command("bash build_runtime.sh", ".")
+    if ret_code != 0:
+        print(f"Error building tf_fuzzer_utils runtime, harnesses will build their own copy: {output}")
+
     with concurrent.futures.ProcessPoolExecutor(max_workers=64) as executor:
         futures = [executor.submit(build_one_tf_api, tf_dir) for tf_dir in tf_dirs]
 
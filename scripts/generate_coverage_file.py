@@ -1,11 +1,13 @@
 import argparse
 import os
 import glob
+import re
 import multiprocessing
 # from functools import partial  # removed: no longer used
 # Added imports for performance and robustness
 import subprocess
 import shutil
+import tempfile
 from concurrent.futures import ProcessPoolExecutor, ThreadPoolExecutor
 
 
@@ -68,6 +70,75 @@ def run_fuzzer_for_seed(seed: str, dir_path: str, timeout: int | None = None) ->
         return 1
 
 
+def single_op_harness(source: str = "fuzz.cpp") -> bool:
+    """Whether the harness has exactly one runOp call site.
+
+    A deferred runOp returns before the op has run, so the harness stops there and any later op of the
+    seed never runs. Only such harnesses have their ops batched; the others are replayed one seed at a
+    time in the same process.
+    """
+    try:
+        with open(source) as f:
+            return len(re.findall(r'\brunOp\s*\(', f.read())) == 1
+    except OSError:
+        return False
+
+
+def run_fuzzer_for_batch(seeds: list[str], dir_path: str, batch: int, index: int,
+                         timeout: int | None = None) -> int:
+    """Replay many seeds in one fuzzer process through the TF runtime's TF_FUZZ_REPLAY mode.
+
+    Returns the exit code of that process.
+    """
+    env = os.environ.copy()
+    env['LLVM_PROFILE_FILE'] = f"replay_{index}.profraw"
+    env['TF_FUZZ_REPLAY_BATCH'] = str(batch)
+    env.setdefault('OMP_NUM_THREADS', '1')
+    env.setdefault('TF_NUM_INTRAOP_THREADS', '1')
+    env.setdefault('TF_NUM_INTEROP_THREADS', '1')
+    env.setdefault('TF_CPP_MIN_LOG_LEVEL', '3')
+    # The list lives outside dir_path so it is never mistaken for a seed
+    fd, list_path = tempfile.mkstemp(prefix='replay_', suffix='.list')
+    try:
+        with os.fdopen(fd, 'w') as lf:
+            lf.write('\n'.join(os.path.join(os.path.abspath(dir_path), s) for s in seeds) + '\n')
+        env['TF_FUZZ_REPLAY'] = list_path
+        with open(os.devnull, 'wb') as devnull:
+            result = subprocess.run(
+                ['./fuzz'],
+                cwd=dir_path,
+                env=env,
+                stdout=devnull,
+                stderr=devnull,
+                timeout=timeout * len(seeds) if timeout and timeout > 0 else None,
+                check=False,
+            )
+        return result.returncode
+    except subprocess.TimeoutExpired:
+        return 124
+    except Exception:
+        return 1
+    finally:
+        for path in (list_path, list_path + '.out'):
+            try:
+                os.remove(path)
+            except OSError:
+                pass
+
+
+def batch_task(task: tuple[list[str], str, int, int, int | None]) -> list[tuple[str, str, int]]:
+    """Picklable wrapper for one replay batch: (seeds, dir_path, batch, index, timeout).
+
+    A crashed or timed-out batch leaves no profile behind, so its seeds are replayed one process
+    each like without --batch.
+    """
+    seeds, d, batch, index, timeout = task
+    rc = run_fuzzer_for_batch(seeds, d, batch, index, timeout=timeout)
+    if rc == 0:
+        return [(d, s, 0) for s in seeds]
+    return [(d, s, run_fuzzer_for_seed(s, d, timeout=timeout)) for s in seeds]
+
+
 def worker_task(task: tuple[str, str, int | None]) -> tuple[str, str, int]:
     """Top-level picklable worker wrapper for ProcessPoolExecutor.
     task: (seed, dir_path, timeout)
@@ -86,6 +157,9 @@ def main():
     # New performance-related options
     parser.add_argument("--workers", type=int, default=None, help="Parallel workers (default: CPU count)")
     parser.add_argument("--timeout", type=int, default=None, help="Per-seed timeout in seconds")
+    parser.add_argument("--batch", type=int, default=0,
+                        help="Replay up to this many seeds per fuzzer process and run their stateless ops in "
+                             "one TF graph (default: 0, one process per seed)")
     args = parser.parse_args()
 
     if args.dll == "tf" and args.api != "all":
@@ -153,9 +227,23 @@ def main():
         chunksize = max(1, len(tasks) // (max_workers * 4) if max_workers else 1)
 
         results: list[tuple[str, str, int]] = []
-        with ProcessPoolExecutor(max_workers=max_workers) as pool:
-            for res in pool.map(worker_task, tasks, chunksize=chunksize):
-                results.append(res)
+        if args.batch > 0:
+            # TF_FUZZ_REPLAY_BATCH=1 runs every op in place
+            op_batch = args.batch if single_op_harness() else 1
+            batch_tasks: list[tuple[list[str], str, int, int, int | None]] = []
+            for d, seeds in seeds_per_dir.items():
+                for start in range(0, len(seeds), args.batch):
+                    batch_tasks.append((seeds[start:start + args.batch], d, op_batch, start // args.batch,
+                                        args.timeout))
+            print(f"Replaying in {len(batch_tasks)} batches of up to {args.batch} seeds"
+                  f"{'' if op_batch > 1 else ', ops run in place (more than one runOp call site)'}...")
+            with ProcessPoolExecutor(max_workers=max_workers) as pool:
+                for res in pool.map(batch_task, batch_tasks):
+                    results.extend(res)
+        else:
+            with ProcessPoolExecutor(max_workers=max_workers) as pool:
+                for res in pool.map(worker_task, tasks, chunksize=chunksize):
+                    results.append(res)
 
         # Optional: basic summary
         failures = [(d, s, rc) for (d, s, rc) in results if rc != 0]
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Compile tf_fuzzer_utils once at -O2 into libtf_fuzzer_utils.a in the fuzz
+# root. Every API's build.sh links this archive instead of recompiling the
+# runtime at -O0. It is not instrumented, so runtime code adds no coverage.
+clang++ -c tf_fuzzer_utils.cpp \
+-std=c++17 \
+    -g \
+    -O2 \
+    $EXTRA_CXXFLAGS \
+-I /root/tensorflow \
+-I /root/tensorflow/bazel-tensorflow \
+-I /root/tensorflow/bazel-bin \
+-I /root/tensorflow/bazel-tensorflow/external/com_google_absl \
+-I /root/tensorflow/bazel-tensorflow/external/com_google_protobuf/src \
+-I /root/tensorflow/bazel-tensorflow/external/eigen_archive \
+-I /root/tensorflow/bazel-tensorflow/external/local_tsl \
+-I /root/tensorflow/bazel-bin/external/local_tsl \
+-I /root/tensorflow/bazel-tensorflow/external/nsync/public \
+-I /root/tensorflow/bazel-tensorflow/external \
+-o tf_fuzzer_utils.o
+
+if [ $? -ne 0 ]; then
+    echo "Error: Runtime compilation failed!"
+    exit 1
+fi
+
+rm -f libtf_fuzzer_utils.a
+ar rcs libtf_fuzzer_utils.a tf_fuzzer_utils.o
+rm -f tf_fuzzer_utils.o
@@ -0,0 +1,368 @@
+#ifndef TF_FUZZER_UTILS_H
+#define TF_FUZZER_UTILS_H
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/public/session_options.h"
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Keep the graph and session of every (op, dtype, rank, attr) signature alive
+// across inputs. Build with -DTF_FUZZ_PERSISTENT_GRAPH=0 to rebuild them for
+// every input instead, which matches the original per-exec behaviour.
+#ifndef TF_FUZZ_PERSISTENT_GRAPH
+#define TF_FUZZ_PERSISTENT_GRAPH 1
+#endif
+// Number of signatures kept alive before the cache is flushed.
+#ifndef TF_FUZZ_MAX_CACHED_GRAPHS
+#define TF_FUZZ_MAX_CACHED_GRAPHS 64
+#endif
+
+// Execution backend used by runOp (e.g. -DTF_FUZZ_BACKEND=TF_FUZZ_BACKEND_SESSION).
+#define TF_FUZZ_BACKEND_SESSION 0 // Placeholder graph run by a DirectSession
+#define TF_FUZZ_BACKEND_KERNEL 1  // OpKernel::Compute on a shared CPU device
+#define TF_FUZZ_BACKEND_EAGER 2   // TFE C API with one context per process
+#ifndef TF_FUZZ_BACKEND
+#define TF_FUZZ_BACKEND TF_FUZZ_BACKEND_KERNEL
+#endif
+
+// Intra-op threads used by every session, kernel device and eager context.
+// Raise it (or set TF_FUZZ_INTRA_OP_THREADS in the environment) to exercise
+// the parallel paths of kernels deliberately.
+#ifndef TF_FUZZ_INTRA_OP_THREADS
+#define TF_FUZZ_INTRA_OP_THREADS 1
+#endif
+
+// Turn off Grappler and the classic graph optimizer (L0, no constant
+// folding) in every session. Harnesses feed data as Const nodes, so with
+// folding enabled the kernel under test may run inside the optimizer instead
+// of, or in addition to, the executor. Build with 0 to restore TF defaults.
+#ifndef TF_FUZZ_DISABLE_GRAPH_OPTIMIZATION
+#define TF_FUZZ_DISABLE_GRAPH_OPTIMIZATION 1
+#endif
+
+// Serve tensor buffers from power-of-two size-class free lists registered as
+// the process CPU allocator, so buffers are recycled across inputs instead
+// of going through malloc every time. Off under ASan, which needs freed
+// buffers to reach its own allocator to report use-after-free.
+#ifndef TF_FUZZ_RECYCLING_ALLOCATOR
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define TF_FUZZ_RECYCLING_ALLOCATOR 0
+#endif
+#endif
+#endif
+#ifndef TF_FUZZ_RECYCLING_ALLOCATOR
+#define TF_FUZZ_RECYCLING_ALLOCATOR 1
+#endif
+// Free bytes kept in the size-class lists between inputs; anything above is
+// returned to the system at the next runOp.
+#ifndef TF_FUZZ_ALLOCATOR_CACHE_MB
+#define TF_FUZZ_ALLOCATOR_CACHE_MB 256
+#endif
+
+// LLVMFuzzerInitialize creates the CPU device or eager context of the
+// selected backend up front and, unless FUZZ_WARMUP is 0 (at build time or in
+// the environment), runs the harness once on a built-in zeroed input so op
+// registration, kernel lookup and allocator caches are warm before the first
+// measured input. There is no warm-up when libFuzzer is given input files to
+// run. An exception escaping the warm-up run is printed, not swallowed.
+#ifndef FUZZ_WARMUP
+#define FUZZ_WARMUP 1
+#endif
+
+// runDataset pulls at most this many elements from a pipeline per input, so
+// infinite (repeat) or slow pipelines stay well inside the 2s -timeout.
+#ifndef TF_FUZZ_DATASET_MAX_ELEMENTS
+#define TF_FUZZ_DATASET_MAX_ELEMENTS 16
+#endif
+
+// Stateful ops run by runOp keep their resources (queues, accumulators,
+// variables, ...) in one per-input container, whatever container attr the
+// harness gives them, and that container is dropped when the input ends. The CPU device and cached sessions stay alive; only the
+// resources go. Set TF_FUZZ_RESOURCE_STATS=1 to print at exit how many
+// resources and bytes inputs left behind and how much memory grew anyway.
+// Build with 0 to keep resources in the containers the harness names.
+#ifndef TF_FUZZ_INPUT_CONTAINER
+#define TF_FUZZ_INPUT_CONTAINER 1
+#endif
+
+// Every input gets this many milliseconds, well inside libFuzzer's
+// -timeout=2. The runtime's cached callables carry it as their run timeout
+// (sessions harnesses build themselves are left to libFuzzer's -timeout),
+// async kernels on the kernel device are cancelled when it passes, and once
+// it has passed runOp and runDataset return DeadlineExceeded without
+// running. An input that ran past it is saved to slow_inputs/ together with
+// its slowest op, instead of libFuzzer killing the process.
+// $TF_FUZZ_INPUT_TIMEOUT_MS overrides it; 0 turns the deadline off.
+#ifndef TF_FUZZ_INPUT_TIMEOUT_MS
+#define TF_FUZZ_INPUT_TIMEOUT_MS 1000
+#endif
+
+// Set TF_FUZZ_STEP_STATS=N in the environment to sample every Nth input.
+// The sampled inputs run their cached callables with FULL_TRACE and their
+// kernels with allocation tracking. At exit, step_stats.txt (next to
+// fuzz-0.log) splits their wall time into harness, framework and kernel time
+// and lists compute time, scheduling delay and allocated bytes per op.
+
+// Batched replay: with TF_FUZZ_REPLAY=<list file> in the environment the
+// harness runs every seed listed in the file (one path per line) in one
+// process and exits, instead of fuzzing. Stateless runOp calls are deferred
+// (runOp returns Unavailable, so the harness stops there) and run
+// TF_FUZZ_REPLAY_BATCH at a time (default 64; 0 or 1 runs them in place) as
+// independent subgraphs of one graph in a single Session::Run. A failing
+// batch is bisected until every failing op is isolated, so one bad seed
+// does not keep the others from running. Per-seed results go to
+// <list file>.out. Since the harness stops at its first deferred runOp,
+// only harnesses that run a single op should be replayed with batching;
+// others need TF_FUZZ_REPLAY_BATCH=1.
+
+// fillMatrixByType builds matrices with a known structure (SPD, invertible,
+// orthogonal, ...) from a few seed bytes. Build with
+// -DFUZZ_STRUCTURED_MATRICES=0 to fill them with raw input bytes instead,
+// e.g. to compare how many inputs a linalg op rejects.
+#ifndef FUZZ_STRUCTURED_MATRICES
+#define FUZZ_STRUCTURED_MATRICES 1
+#endif
+
+// Tracing (e.g. -DFUZZ_TRACE_LEVEL=1 -DFUZZ_TRACE_RING=1 via EXTRA_CXXFLAGS).
+// FUZZ_TRACE(level, ...) statements above FUZZ_TRACE_LEVEL are compiled out:
+// 0 = off, 1 = one line per input, 2 = details.
+#ifndef FUZZ_TRACE_LEVEL
+#define FUZZ_TRACE_LEVEL 0
+#endif
+// With FUZZ_TRACE_RING=1, traced lines go to an in-memory ring of the last
+// FUZZ_TRACE_RING_SIZE lines instead of stdout. The ring is written to stderr
+// only on a crash or when an input runs longer than $FUZZ_TRACE_TIMEOUT
+// seconds (default 2, fuzz.sh's -timeout).
+#ifndef FUZZ_TRACE_RING
+#define FUZZ_TRACE_RING 0
+#endif
+#ifndef FUZZ_TRACE_RING_SIZE
+#define FUZZ_TRACE_RING_SIZE 256
+#endif
+
+#define FUZZ_TRACE(level, ...)                                       \
+    do {                                                             \
+        if constexpr ((level) <= FUZZ_TRACE_LEVEL) {                 \
+            std::ostringstream fuzz_trace_stream_;                   \
+            fuzz_trace_stream_ << __VA_ARGS__;                       \
+            tf_fuzzer_utils::traceMessage(fuzz_trace_stream_.str()); \
+        }                                                            \
+    } while (0)
+
+// Marks the start of an input in place of the per-exec "Start Fuzzing" print.
+#if FUZZ_TRACE_LEVEL > 0 || FUZZ_TRACE_RING
+#define FUZZ_TRACE_INPUT() tf_fuzzer_utils::traceInput()
+#else
+#define FUZZ_TRACE_INPUT() \
+    do {                   \
+    } while (0)
+#endif
+
+namespace tf_fuzzer_utils {
+
+    // --- Tracing ---
+    void traceMessage(const std::string& msg);
+    void traceInput();
+    // Prints `message` to stderr. Weak, so a harness may still define its own.
+    void logError(const std::string& message, const uint8_t* data, size_t size);
+
+    // --- Input scoping ---
+    // The runtime defines __wrap_LLVMFuzzerTestOneInput, and build.sh links
+    // with -Wl,--wrap=LLVMFuzzerTestOneInput, so every input the harness
+    // runs (fuzzing, replay or warm-up) is bracketed by these two calls.
+    // beginInput starts the TF_FUZZ_INPUT_TIMEOUT_MS deadline of `data`.
+    // endInput records the input if it was slow and cleans up what it left
+    // on the kernel device and in the cached sessions it ran: the step
+    // container shared by all runOp calls of the input (TensorArrays,
+    // stacks, ...) and, with TF_FUZZ_INPUT_CONTAINER, the per-input and
+    // default resource containers.
+    void beginInput(const uint8_t* data, size_t size);
+    void endInput();
+
+    // --- Session configuration ---
+    // Single-threaded options shared by all harnesses: one inter-op thread
+    // from a process-wide pool and TF_FUZZ_INTRA_OP_THREADS intra-op threads,
+    // so no session creates or tears down threads of its own. Graph
+    // optimizations follow TF_FUZZ_DISABLE_GRAPH_OPTIMIZATION.
+    tensorflow::SessionOptions makeSessionOptions();
+
+    // --- Input parsing ---
+    // Shared, optimised versions of the helpers every harness used to define
+    // inline. They consume the fuzzer input byte for byte like those copies.
+    uint8_t parseRank(uint8_t byte, uint8_t min_rank, uint8_t max_rank);
+
+    // Reads one int64 per dimension and maps it into [min_dim, max_dim];
+    // dimensions past the end of the input are 1.
+    std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size,
+                                    uint8_t rank, int64_t min_dim, int64_t max_dim);
+
+    // Copies as many whole elements as the input still holds straight into
+    // the tensor buffer and zero-fills the rest. Covers every numeric,
+    // bfloat16, half, complex, quantized and bool dtype (bools are stored as
+    // 0/1); strings take a length byte (1-10) followed by their characters.
+    // Other dtypes are left untouched.
+    void fillTensorWithDataByType(tensorflow::Tensor& tensor, tensorflow::DataType dtype,
+                                  const uint8_t* data, size_t& offset, size_t total_size);
+
+    template <typename T>
+    void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
+                            size_t& offset, size_t total_size) {
+        fillTensorWithDataByType(tensor, tensorflow::DataTypeToEnum<T>::value, data, offset, total_size);
+    }
+
+    // --- Quantized tensors ---
+    // Float range of an affine quantization of `dtype` (qint8, quint8,
+    // qint16, quint16 or qint32), decoded from two scale bytes (2^-12 .. 2^4)
+    // and a zero-point byte: min = (qmin - z) * scale, max = (qmax - z) * scale,
+    // so min <= 0 <= max and min < max always hold.
+    void parseQuantizedRange(tensorflow::DataType dtype, const uint8_t* data, size_t& offset, size_t total_size,
+                             float* min_range, float* max_range);
+
+    // A quantized payload and the min/max tensors describing it.
+    struct QuantizedTensor {
+        tensorflow::Tensor value;
+        tensorflow::Tensor min_range;
+        tensorflow::Tensor max_range;
+    };
+
+    // Copies the integer payload straight from the input (no float round
+    // trip), then reads one range per tensor (axis < 0, scalar min/max) or
+    // one per slice along `axis` (min/max of shape [shape.dim_size(axis)]).
+    QuantizedTensor makeQuantizedTensor(tensorflow::DataType dtype, const tensorflow::TensorShape& shape, int axis,
+                                        const uint8_t* data, size_t& offset, size_t total_size);
+
+    // --- Structured matrices ---
+    enum class MatrixKind : uint8_t {
+        SPD,          // B*B^H + eps*I from an n x r seed block
+        Invertible,   // strictly diagonally dominant
+        Orthogonal,   // product of 1-3 Householder reflectors (unitary if complex)
+        Banded,       // diagonally dominant with random lower/upper bandwidth
+        Triangular,   // diagonally dominant upper or lower triangle
+        NearSingular, // Q*diag(s)*Q^H with smallest s in [1e-15, 1e-1], or 0
+    };
+    MatrixKind parseMatrixKind(uint8_t byte);
+
+    // Fills every innermost n x n matrix of `tensor` with a matrix of the
+    // given kind, read as one parameter byte followed by at most n*n seed
+    // bytes per matrix (twice that for complex). Float, double, half,
+    // bfloat16 and complex dtypes only; other dtypes and non-square shapes
+    // are filled like fillTensorWithDataByType.
+    void fillMatrixByType(tensorflow::Tensor& tensor, tensorflow::DataType dtype, MatrixKind kind,
+                          const uint8_t* data, size_t& offset, size_t total_size);
+
+    // --- Allocator ---
+    // Counters of the recycling CPU allocator (all zero when it is disabled).
+    // Set TF_FUZZ_ALLOCATOR_STATS=1 to print them to stderr at exit.
+    struct AllocatorStats {
+        uint64_t allocations = 0;
+        uint64_t pool_hits = 0;
+        size_t bytes_in_use = 0;
+        size_t peak_bytes_in_use = 0;
+        size_t cached_bytes = 0;
+
+        double hitRate() const {
+            return allocations == 0 ? 0.0 : static_cast<double>(pool_hits) / allocations;
+        }
+    };
+
+    AllocatorStats allocatorStats();
+
+    // --- Op description ---
+    // The raw op under test plus its attrs. Type attrs that can be inferred
+    // from the inputs (T, N, ...) may be omitted.
+    struct OpSpec {
+        std::string op;
+        std::vector<std::pair<std::string, tensorflow::AttrValue>> attrs;
+
+        explicit OpSpec(std::string op_name) : op(std::move(op_name)) {}
+
+        template <typename T>
+        OpSpec& attr(const std::string& name, const T& value) {
+            tensorflow::AttrValue attr_value;
+            tensorflow::SetAttrValue(value, &attr_value);
+            attrs.emplace_back(name, std::move(attr_value));
+            return *this;
+        }
+    };
+
+    // --- Execution ---
+    // Runs `spec` on `inputs` and returns every output of the op, using the
+    // backend selected by TF_FUZZ_BACKEND. Ops that take or return resource
+    // handles or refs run through runOpKernel on every backend, so a handle
+    // created by one call resolves in the next.
+    tensorflow::Status runOp(const OpSpec& spec,
+                             const std::vector<tensorflow::Tensor>& inputs,
+                             std::vector<tensorflow::Tensor>* outputs);
+
+    // Inputs are fed through Placeholders, so the graph only depends on the
+    // dtypes and ranks of the inputs and on the attrs; it is built once per
+    // signature and later inputs only feed tensors into the cached callable.
+    // Deprecated ops are built at the last GraphDef version that accepts them.
+    tensorflow::Status runOpInSession(const OpSpec& spec,
+                                      const std::vector<tensorflow::Tensor>& inputs,
+                                      std::vector<tensorflow::Tensor>* outputs);
+
+    // Instantiates the kernel once per signature via CreateOpKernel and calls
+    // Compute directly, skipping graph construction, placement and executor
+    // setup. Ops with function attrs fall back to the session. Deprecated ops
+    // (TensorArray, TensorArrayV2) are created at the last GraphDef version
+    // that accepts them. All kernels
+    // share one device, so a resource handle returned by one call
+    // (FIFOQueueV2, StackV2, VarHandleOp, ...) can be fed to the next within
+    // the same input. The same holds for the string handles of ref-typed ops
+    // (FIFOQueue, Stack, TensorArray, ConditionalAccumulator): a ref input is
+    // passed as a ref to the caller's tensor, so ops such as ApplyAdam update
+    // it in place.
+    tensorflow::Status runOpKernel(const OpSpec& spec,
+                                   const std::vector<tensorflow::Tensor>& inputs,
+                                   std::vector<tensorflow::Tensor>* outputs);
+
+    // Executes the op through the TFE C API on a process-wide TFE_Context,
+    // reusing one TFE_Op per op name via TFE_OpReset. Inputs with dtypes that
+    // cannot be copied into a TF_Tensor (string, resource, variant) and
+    // deprecated ops fall back to runOpKernel.
+    tensorflow::Status runOpEager(const OpSpec& spec,
+                                  const std::vector<tensorflow::Tensor>& inputs,
+                                  std::vector<tensorflow::Tensor>* outputs);
+
+    // --- Dataset pipelines ---
+    // A tf.data op under test. If its first input is a variant dataset, it
+    // reads from a TensorSliceDataset over the `components` given to
+    // runDataset; its other inputs are fed in op order. output_types and
+    // output_shapes default to the component types with unknown shapes.
+    // Functions named by func attrs go in `functions`.
+    struct DatasetSpec {
+        OpSpec op;
+        std::vector<tensorflow::FunctionDef> functions;
+
+        explicit DatasetSpec(OpSpec op_spec) : op(std::move(op_spec)) {}
+
+        DatasetSpec& function(tensorflow::FunctionDef fdef) {
+            functions.push_back(std::move(fdef));
+            return *this;
+        }
+    };
+
+    // The pipeline graph, its function library and the session running it
+    // are built once per signature. Each call feeds the tensors, binds the
+    // dataset to a fresh AnonymousIteratorV3 with MakeIterator and pulls at
+    // most TF_FUZZ_DATASET_MAX_ELEMENTS elements with IteratorGetNext; their
+    // tensors are appended to `elements`. Reaching the end is not an error.
+    tensorflow::Status runDataset(const DatasetSpec& spec,
+                                  const std::vector<tensorflow::Tensor>& components,
+                                  const std::vector<tensorflow::Tensor>& inputs,
+                                  std::vector<tensorflow::Tensor>* elements);
+
+} // namespace tf_fuzzer_utils
+
+#endif // TF_FUZZER_UTILS_H
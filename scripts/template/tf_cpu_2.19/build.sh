@@ -1,10 +1,19 @@
 #!/bin/bash
 
-clang++ fuzz.cpp \
+# Link the runtime built by build_runtime.sh; build it here when it is missing
+# or EXTRA_CXXFLAGS may change its configuration.
+RUNTIME=../libtf_fuzzer_utils.a
+if [ -n "$EXTRA_CXXFLAGS" ] || [ ! -f "$RUNTIME" ]; then
+    RUNTIME=libtf_fuzzer_utils.a
+    bash build_runtime.sh || exit 1
+fi
+
+clang++ fuzz.cpp $RUNTIME \
 -std=c++17 \
     -g \
     -O0 \
     -fsanitize=fuzzer \
+    $EXTRA_CXXFLAGS \
 -I /root/tensorflow \
 -I /root/tensorflow/bazel-tensorflow \
 -I /root/tensorflow/bazel-bin \
@@ -20,6 +29,7 @@ clang++ fuzz.cpp \
 -I /root/tensorflow/bazel-tensorflow/external \
 -L /root/tensorflow/bazel-bin/tensorflow \
 -Wl,-rpath,'$ORIGIN' \
+-Wl,--wrap=LLVMFuzzerTestOneInput \
 -ltensorflow_cc \
 -ltensorflow_framework \
 -lpthread \
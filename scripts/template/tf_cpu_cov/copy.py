@@ -33,8 +33,11 @@ def copy_fuzz_utils(time_budget: int = 180):
     # Source files
     fuzz_sh = "fuzz.sh"
     build_sh = "build.sh"
+    build_runtime_sh = "build_runtime.sh"
     build = "BUILD"
     random_seed = "random_seed.py"
+    tf_fuzzer_utils_h = "tf_fuzzer_utils.h"
+    tf_fuzzer_utils_cpp = "tf_fuzzer_utils.cpp"
     coverage_py = "coverage_fuzzing.py"
     # Find all directories starting with torch
     torch_dirs = [d for d in glob.glob("tf.*") if os.path.isdir(d)]
@@ -53,19 +56,26 @@ def copy_fuzz_utils(time_budget: int = 180):
         target_fuzz_sh = os.path.join(torch_dir, "fuzz.sh")
 
         target_build_sh = os.path.join(torch_dir, "build.sh")
+        target_build_runtime_sh = os.path.join(torch_dir, "build_runtime.sh")
 
         target_build = os.path.join(torch_dir, "BUILD")
 
         target_random_seed = os.path.join(torch_dir, "random_seed.py")
 
+        target_tf_fuzzer_utils_h = os.path.join(torch_dir, "tf_fuzzer_utils.h")
+        target_tf_fuzzer_utils_cpp = os.path.join(torch_dir, "tf_fuzzer_utils.cpp")
+
         target_coverage_py = os.path.join(torch_dir, "coverage_fuzzing.py")
 
         # Copy the files (overwriting if they exist)
         try:
             shutil.copy2(fuzz_sh, target_fuzz_sh)
             shutil.copy2(build_sh, target_build_sh)
+            shutil.copy2(build_runtime_sh, target_build_runtime_sh)
             shutil.copy2(build, target_build)
             shutil.copy2(random_seed, target_random_seed)
+            shutil.copy2(tf_fuzzer_utils_h, target_tf_fuzzer_utils_h)
+            shutil.copy2(tf_fuzzer_utils_cpp, target_tf_fuzzer_utils_cpp)
             shutil.copy2(coverage_py, target_coverage_py)
             replace_file_content(target_fuzz_sh, "{api_name}", api_name)
             replace_file_content(target_build_sh, "{api_name}", api_name)
@@ -0,0 +1,2422 @@
+#include "tf_fuzzer_utils.h"
+#include "absl/strings/match.h"
+#include "tensorflow/c/eager/c_api.h"
+#include "tensorflow/c/eager/c_api_experimental.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/allocator_registry.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tracking_allocator.h"
+#include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unistd.h>
+
+// Defined by every harness. With -Wl,--wrap=LLVMFuzzerTestOneInput the
+// linker binds the harness's definition to __real_LLVMFuzzerTestOneInput and
+// every call, libFuzzer's and the runtime's, to __wrap_LLVMFuzzerTestOneInput.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+extern "C" int __real_LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace
+{ // Keep internal helpers in anonymous namespace
+
+    constexpr char kTargetNode[] = "target";
+    constexpr char kInterOpPoolName[] = "tf_fuzz_inter_op";
+    constexpr char kInputContainer[] = "tf_fuzz_input";
+
+    int intraOpThreads() {
+        static const int threads = [] {
+            const char* env = std::getenv("TF_FUZZ_INTRA_OP_THREADS");
+            const int value = env ? std::atoi(env) : 0;
+            return value > 0 ? value : TF_FUZZ_INTRA_OP_THREADS;
+        }();
+        return threads;
+    }
+
+    // Per-input budget; TF_FUZZ_INPUT_TIMEOUT_MS in the environment overrides
+    // the build default and 0 turns the deadline off.
+    int64_t inputTimeoutMs() {
+        static const int64_t timeout = [] {
+            const char* env = std::getenv("TF_FUZZ_INPUT_TIMEOUT_MS");
+            const int64_t value = env ? std::atoll(env) : TF_FUZZ_INPUT_TIMEOUT_MS;
+            return std::max<int64_t>(value, 0);
+        }();
+        return timeout;
+    }
+
+    int64_t monotonicNs() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    // --- Trace ring ---
+#if FUZZ_TRACE_RING
+    // Fixed-size storage so the crash handlers can dump it with write(2) only.
+    constexpr size_t kTraceLineMax = 256;
+    char trace_lines[FUZZ_TRACE_RING_SIZE][kTraceLineMax];
+    size_t trace_lengths[FUZZ_TRACE_RING_SIZE];
+    std::atomic<uint64_t> trace_next{0};
+    std::atomic<int64_t> input_start_ns{0};
+    std::atomic<bool> trace_dumped{false};
+    double trace_timeout_sec = 2.0;
+    const int trace_signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGALRM};
+    struct sigaction previous_actions[NSIG];
+
+    void writeAll(int fd, const char* buf, size_t len) {
+        while (len > 0) {
+            const ssize_t written = write(fd, buf, len);
+            if (written <= 0) {
+                return;
+            }
+            buf += written;
+            len -= static_cast<size_t>(written);
+        }
+    }
+
+    void dumpTraceRing(const char* reason) {
+        if (trace_dumped.exchange(true)) {
+            return;
+        }
+        const uint64_t end = trace_next.load();
+        const uint64_t begin = end > FUZZ_TRACE_RING_SIZE ? end - FUZZ_TRACE_RING_SIZE : 0;
+        writeAll(STDERR_FILENO, "==== fuzz trace (", 17);
+        writeAll(STDERR_FILENO, reason, strlen(reason));
+        writeAll(STDERR_FILENO, ") ====\n", 7);
+        for (uint64_t i = begin; i < end; ++i) {
+            const size_t slot = i % FUZZ_TRACE_RING_SIZE;
+            writeAll(STDERR_FILENO, trace_lines[slot], trace_lengths[slot]);
+            writeAll(STDERR_FILENO, "\n", 1);
+        }
+        writeAll(STDERR_FILENO, "==== end of fuzz trace ====\n", 28);
+    }
+
+    void traceSignalHandler(int sig, siginfo_t* info, void* context) {
+        // libFuzzer's SIGALRM also fires while inputs are fine; only dump once
+        // the current input has run past the timeout.
+        const bool timed_out = sig == SIGALRM &&
+                               (monotonicNs() - input_start_ns.load()) / 1e9 >= trace_timeout_sec;
+        if (sig != SIGALRM || timed_out) {
+            dumpTraceRing(sig == SIGALRM ? "timeout" : "crash");
+        }
+
+        const struct sigaction& previous = previous_actions[sig];
+        if (previous.sa_flags & SA_SIGINFO) {
+            if (previous.sa_sigaction) {
+                previous.sa_sigaction(sig, info, context);
+            }
+        } else if (previous.sa_handler == SIG_DFL) {
+            signal(sig, SIG_DFL);
+            raise(sig);
+        } else if (previous.sa_handler != SIG_IGN) {
+            previous.sa_handler(sig);
+        }
+    }
+
+    // Installed on the first input, after libFuzzer has set up its own
+    // handlers, which are chained to.
+    void installTraceHandlers() {
+        static const bool installed = [] {
+            const char* timeout = std::getenv("FUZZ_TRACE_TIMEOUT");
+            if (timeout && std::atof(timeout) > 0) {
+                trace_timeout_sec = std::atof(timeout);
+            }
+            for (int sig : trace_signals) {
+                struct sigaction action = {};
+                action.sa_sigaction = traceSignalHandler;
+                action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+                sigemptyset(&action.sa_mask);
+                sigaction(sig, &action, &previous_actions[sig]);
+            }
+            return true;
+        }();
+        (void)installed;
+    }
+#endif // FUZZ_TRACE_RING
+
+    // --- Recycling allocator ---
+    constexpr size_t kMinClassShift = 6;  // 64 bytes, Allocator::kAllocatorAlignment
+    constexpr size_t kMaxClassShift = 26; // 64 MiB; larger buffers bypass the pool
+    constexpr size_t kNumClasses = kMaxClassShift - kMinClassShift + 1;
+    constexpr size_t kUnpooled = kNumClasses;
+
+    // Size class of a request, or kUnpooled if it is too large for the pool.
+    size_t sizeClass(size_t num_bytes) {
+        size_t shift = kMinClassShift;
+        while (shift <= kMaxClassShift && (size_t{1} << shift) < num_bytes) {
+            ++shift;
+        }
+        return shift <= kMaxClassShift ? shift - kMinClassShift : kUnpooled;
+    }
+
+    size_t classBytes(size_t size_class) {
+        return size_t{1} << (size_class + kMinClassShift);
+    }
+
+    // Written just below every buffer, in padding of at least
+    // kAllocatorAlignment bytes, so a free needs no lookup.
+    struct BufferHeader {
+        size_t size_class;
+        size_t bytes;
+        size_t padding; // from the start of the allocation to the buffer
+    };
+    static_assert(sizeof(BufferHeader) <= tensorflow::Allocator::kAllocatorAlignment,
+                  "buffer header must fit in the alignment padding");
+
+    BufferHeader* bufferHeader(void* ptr) {
+        return static_cast<BufferHeader*>(ptr) - 1;
+    }
+
+    void freeBuffer(void* ptr) {
+        tensorflow::port::AlignedFree(static_cast<char*>(ptr) - bufferHeader(ptr)->padding);
+    }
+
+    class RecyclingAllocator : public tensorflow::Allocator {
+    public:
+        RecyclingAllocator() {
+            instance().store(this);
+            const char* env = std::getenv("TF_FUZZ_ALLOCATOR_STATS");
+            if (env && env[0] == '1') {
+                std::atexit([] {
+                    const tf_fuzzer_utils::AllocatorStats stats = tf_fuzzer_utils::allocatorStats();
+                    std::fprintf(stderr,
+                                 "stat::tf_fuzz_alloc_count: %llu\nstat::tf_fuzz_alloc_hit_rate: %.3f\n"
+                                 "stat::tf_fuzz_alloc_peak_bytes: %zu\n",
+                                 static_cast<unsigned long long>(stats.allocations), stats.hitRate(),
+                                 stats.peak_bytes_in_use);
+                });
+            }
+        }
+
+        static std::atomic<RecyclingAllocator*>& instance() {
+            static std::atomic<RecyclingAllocator*> allocator{nullptr};
+            return allocator;
+        }
+
+        std::string Name() override { return "tf_fuzz_recycling"; }
+
+        void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+            const size_t size_class =
+                alignment <= tensorflow::Allocator::kAllocatorAlignment ? sizeClass(num_bytes) : kUnpooled;
+            const size_t bytes = size_class == kUnpooled ? num_bytes : classBytes(size_class);
+
+            void* ptr = nullptr;
+            {
+                tensorflow::mutex_lock lock(mu_);
+                ++stats_.allocations;
+                if (size_class != kUnpooled && !free_lists_[size_class].empty()) {
+                    ptr = free_lists_[size_class].back();
+                    free_lists_[size_class].pop_back();
+                    stats_.cached_bytes -= bytes;
+                    ++stats_.pool_hits;
+                }
+                stats_.bytes_in_use += bytes;
+                stats_.peak_bytes_in_use = std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+            }
+            if (ptr != nullptr) {
+                return ptr;
+            }
+
+            const size_t padding = std::max(alignment, tensorflow::Allocator::kAllocatorAlignment);
+            void* block = tensorflow::port::AlignedMalloc(padding + bytes, static_cast<int>(padding));
+            if (block == nullptr) {
+                tensorflow::mutex_lock lock(mu_);
+                stats_.bytes_in_use -= bytes;
+                return nullptr;
+            }
+            ptr = static_cast<char*>(block) + padding;
+            *bufferHeader(ptr) = {size_class, bytes, padding};
+            return ptr;
+        }
+
+        void DeallocateRaw(void* ptr) override {
+            if (ptr == nullptr) {
+                return;
+            }
+            const BufferHeader header = *bufferHeader(ptr);
+            {
+                tensorflow::mutex_lock lock(mu_);
+                stats_.bytes_in_use -= header.bytes;
+                if (header.size_class != kUnpooled) {
+                    stats_.cached_bytes += header.bytes;
+                    free_lists_[header.size_class].push_back(ptr);
+                    return;
+                }
+            }
+            freeBuffer(ptr);
+        }
+
+        absl::optional<tensorflow::AllocatorStats> GetStats() override {
+            tensorflow::mutex_lock lock(mu_);
+            tensorflow::AllocatorStats stats;
+            stats.num_allocs = static_cast<int64_t>(stats_.allocations);
+            stats.bytes_in_use = static_cast<int64_t>(stats_.bytes_in_use);
+            stats.peak_bytes_in_use = static_cast<int64_t>(stats_.peak_bytes_in_use);
+            return stats;
+        }
+
+        tf_fuzzer_utils::AllocatorStats fuzzStats() {
+            tensorflow::mutex_lock lock(mu_);
+            return stats_;
+        }
+
+        // Hands cached buffers back to the system until at most `limit` free
+        // bytes remain, largest classes first.
+        void trim(size_t limit) {
+            std::vector<void*> released;
+            {
+                tensorflow::mutex_lock lock(mu_);
+                for (size_t c = kNumClasses; c-- > 0 && stats_.cached_bytes > limit;) {
+                    while (!free_lists_[c].empty() && stats_.cached_bytes > limit) {
+                        released.push_back(free_lists_[c].back());
+                        free_lists_[c].pop_back();
+                        stats_.cached_bytes -= classBytes(c);
+                    }
+                }
+            }
+            for (void* ptr : released) {
+                freeBuffer(ptr);
+            }
+        }
+
+    private:
+        tensorflow::mutex mu_;
+        std::array<std::vector<void*>, kNumClasses> free_lists_ TF_GUARDED_BY(mu_);
+        tf_fuzzer_utils::AllocatorStats stats_ TF_GUARDED_BY(mu_);
+    };
+
+    class RecyclingSubAllocator : public tensorflow::SubAllocator {
+    public:
+        RecyclingSubAllocator() : tensorflow::SubAllocator({}, {}) {}
+
+        void* Alloc(size_t alignment, size_t num_bytes, size_t* bytes_received) override {
+            *bytes_received = num_bytes;
+            return tensorflow::port::AlignedMalloc(num_bytes, static_cast<int>(alignment));
+        }
+
+        void Free(void* ptr, size_t num_bytes) override { tensorflow::port::AlignedFree(ptr); }
+
+        bool SupportsCoalescing() const override { return false; }
+    };
+
+    class RecyclingAllocatorFactory : public tensorflow::AllocatorFactory {
+    public:
+        tensorflow::Allocator* CreateAllocator() override { return new RecyclingAllocator(); }
+
+        tensorflow::SubAllocator* CreateSubAllocator(int numa_node) override {
+            return new RecyclingSubAllocator();
+        }
+    };
+
+#if TF_FUZZ_RECYCLING_ALLOCATOR
+    // Above the default CPU allocator (priority 100), so cpu_allocator() and
+    // every CPU device hand out recycled buffers.
+    REGISTER_MEM_ALLOCATOR("TFFuzzRecyclingAllocator", 300, RecyclingAllocatorFactory);
+#endif
+
+    void trimAllocatorCache() {
+        RecyclingAllocator* allocator = RecyclingAllocator::instance().load();
+        if (allocator != nullptr) {
+            allocator->trim(static_cast<size_t>(TF_FUZZ_ALLOCATOR_CACHE_MB) << 20);
+        }
+    }
+
+    // --- Step stats ---
+
+    // Per-op totals over the sampled inputs.
+    struct OpTiming {
+        uint64_t runs = 0;
+        int64_t compute_ns = 0;
+        int64_t scheduling_ns = 0;
+        int64_t alloc_bytes = 0;
+    };
+
+    // With TF_FUZZ_STEP_STATS=N every Nth input is sampled: its wall time,
+    // the time spent inside runOp/runDataset and the per-node step stats of
+    // every kernel it ran are added up and written to step_stats.txt at exit.
+    struct StepStatsSummary {
+        int64_t every = 0;
+        uint64_t inputs = 0;
+        uint64_t sampled_inputs = 0;
+        bool sampling = false;
+        int64_t input_start_ns = 0;
+        int64_t input_ns = 0;
+        int64_t run_ns = 0;
+        int64_t compute_ns = 0;
+        std::map<std::string, OpTiming> ops;
+    };
+
+    void writeStepStats();
+
+    StepStatsSummary& stepStats() {
+        static StepStatsSummary* summary = [] {
+            auto* created = new StepStatsSummary();
+            const char* env = std::getenv("TF_FUZZ_STEP_STATS");
+            created->every = env ? std::max<int64_t>(std::atoll(env), 0) : 0;
+            if (created->every > 0) {
+                std::atexit(writeStepStats);
+            }
+            return created;
+        }();
+        return *summary;
+    }
+
+    void addOpTiming(const std::string& op, int64_t compute_ns, int64_t scheduling_ns, int64_t alloc_bytes) {
+        StepStatsSummary& summary = stepStats();
+        OpTiming& timing = summary.ops[op];
+        ++timing.runs;
+        timing.compute_ns += compute_ns;
+        timing.scheduling_ns += scheduling_ns;
+        timing.alloc_bytes += alloc_bytes;
+        summary.compute_ns += compute_ns;
+    }
+
+    // Nodes are keyed by op type, taken from labels like "target = Add(input_0, input_1)".
+    void addStepStats(const tensorflow::StepStats& step_stats) {
+        for (const auto& device : step_stats.dev_stats()) {
+            for (const auto& node : device.node_stats()) {
+                if (node.node_name().empty() || node.node_name()[0] == '_') {
+                    continue;
+                }
+                std::string op = node.node_name();
+                const std::string& label = node.timeline_label();
+                const size_t eq = label.find(" = ");
+                const size_t paren = label.find('(', eq);
+                if (eq != std::string::npos && paren != std::string::npos) {
+                    op = label.substr(eq + 3, paren - eq - 3);
+                }
+                const int64_t scheduling_ns =
+                    node.scheduled_nanos() > 0 ? node.all_start_nanos() - node.scheduled_nanos() : 0;
+                int64_t alloc_bytes = 0;
+                for (const auto& memory : node.memory()) {
+                    alloc_bytes += memory.total_bytes();
+                }
+                addOpTiming(op, node.op_end_rel_nanos() - node.op_start_rel_nanos(), std::max<int64_t>(scheduling_ns, 0),
+                            alloc_bytes);
+            }
+        }
+    }
+
+    // Closes the previous sampled input and decides whether this one is sampled.
+    void sampleInput() {
+        StepStatsSummary& summary = stepStats();
+        if (summary.every == 0) {
+            return;
+        }
+        const int64_t now = monotonicNs();
+        if (summary.sampling) {
+            summary.input_ns += now - summary.input_start_ns;
+        }
+        // Counting from 1 leaves the warmup input out unless every input is sampled.
+        summary.sampling = ++summary.inputs % summary.every == 0;
+        if (summary.sampling) {
+            ++summary.sampled_inputs;
+            summary.input_start_ns = now;
+        }
+    }
+
+    // Totals first, split into harness (outside runOp), framework (runOp
+    // minus kernels) and kernel time, then one CSV row per op.
+    void writeStepStats() {
+        StepStatsSummary& summary = stepStats();
+        if (summary.sampling) {
+            summary.input_ns += monotonicNs() - summary.input_start_ns;
+            summary.sampling = false;
+        }
+        std::error_code ec;
+        const std::string api = std::filesystem::current_path(ec).filename().string();
+        std::ofstream out("step_stats.txt");
+        out << std::fixed << std::setprecision(3);
+        const double input_us = summary.input_ns / 1e3;
+        out << "api: " << api << "\nsampled_inputs: " << summary.sampled_inputs << " of " << summary.inputs
+            << " (every " << summary.every << ")\ninput_us: " << input_us
+            << "\nharness_us: " << (summary.input_ns - summary.run_ns) / 1e3
+            << "\nframework_us: " << (summary.run_ns - summary.compute_ns) / 1e3
+            << "\nkernel_us: " << summary.compute_ns / 1e3
+            << "\nkernel_share: " << (input_us > 0 ? summary.compute_ns / 1e3 / input_us : 0.0)
+            << "\n\nop,runs,compute_us,scheduling_us,alloc_bytes\n";
+        for (const auto& entry : summary.ops) {
+            const OpTiming& timing = entry.second;
+            out << entry.first << ',' << timing.runs << ',' << timing.compute_ns / 1e3 << ','
+                << timing.scheduling_ns / 1e3 << ',' << timing.alloc_bytes << '\n';
+        }
+    }
+
+    // A callable and, once a sampled input runs it, a FULL_TRACE copy whose
+    // step stats go into the summary.
+    struct CachedCallable {
+        tensorflow::CallableOptions options;
+        tensorflow::Session::CallableHandle handle = 0;
+        tensorflow::Session::CallableHandle traced = 0;
+        bool has_traced = false;
+
+        tensorflow::Status make(tensorflow::Session* session, tensorflow::CallableOptions callable_options) {
+            options = std::move(callable_options);
+            return session->MakeCallable(options, &handle);
+        }
+
+        void release(tensorflow::Session* session) {
+            session->ReleaseCallable(handle).IgnoreError();
+            if (has_traced) {
+                session->ReleaseCallable(traced).IgnoreError();
+            }
+        }
+
+        tensorflow::Status run(tensorflow::Session* session, const std::vector<tensorflow::Tensor>& feeds,
+                               std::vector<tensorflow::Tensor>* fetches) {
+            if (!stepStats().sampling) {
+                return session->RunCallable(handle, feeds, fetches, nullptr);
+            }
+            if (!has_traced) {
+                tensorflow::CallableOptions traced_options = options;
+                traced_options.mutable_run_options()->set_trace_level(tensorflow::RunOptions::FULL_TRACE);
+                TF_RETURN_IF_ERROR(session->MakeCallable(traced_options, &traced));
+                has_traced = true;
+            }
+            tensorflow::RunMetadata metadata;
+            tensorflow::Status status = session->RunCallable(traced, feeds, fetches, &metadata);
+            addStepStats(metadata.step_stats());
+            return status;
+        }
+    };
+
+    // --- Input deadline ---
+
+    // The input being run, when it started and the slowest op it ran. The
+    // bytes are libFuzzer's and only valid until endInput() returns; they are
+    // copied only when the input is saved.
+    struct InputState {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        int64_t start_ns = 0;
+        std::string slowest_op;
+        int64_t slowest_op_ns = 0;
+        bool timed_out = false;
+        uint64_t slow_inputs = 0;
+        // Handed to every kernel of the input; replaced once cancelled.
+        std::unique_ptr<tensorflow::CancellationManager> cancellation =
+            std::make_unique<tensorflow::CancellationManager>();
+    };
+
+    InputState& inputState() {
+        static InputState* state = new InputState();
+        return *state;
+    }
+
+    // Time left before the current input's deadline; unlimited without one.
+    int64_t remainingNs() {
+        const InputState& state = inputState();
+        if (inputTimeoutMs() == 0 || state.start_ns == 0) {
+            return std::numeric_limits<int64_t>::max();
+        }
+        return state.start_ns + inputTimeoutMs() * 1000000 - monotonicNs();
+    }
+
+    // Once an input is past its deadline its remaining ops are skipped.
+    tensorflow::Status checkDeadline(const std::string& op) {
+        if (remainingNs() > 0) {
+            return absl::OkStatus();
+        }
+        inputState().timed_out = true;
+        return tensorflow::errors::DeadlineExceeded("Input ran past ", inputTimeoutMs(), " ms before ", op);
+    }
+
+    void recordRun(const std::string& op, int64_t elapsed_ns, const tensorflow::Status& status) {
+        StepStatsSummary& summary = stepStats();
+        if (summary.sampling) {
+            summary.run_ns += elapsed_ns;
+        }
+        InputState& state = inputState();
+        if (elapsed_ns > state.slowest_op_ns) {
+            state.slowest_op_ns = elapsed_ns;
+            state.slowest_op = op;
+        }
+        if (tensorflow::errors::IsDeadlineExceeded(status)) {
+            state.timed_out = true;
+        }
+    }
+
+    // Writes slow_inputs/<hash>.bin with the slowest op and timings in
+    // <hash>.txt, once per distinct input.
+    void storeSlowInput(const InputState& state, int64_t elapsed_ns) {
+        namespace fs = std::filesystem;
+        char name[17];
+        std::snprintf(name, sizeof(name), "%016llx",
+                      static_cast<unsigned long long>(tensorflow::Hash64(
+                          reinterpret_cast<const char*>(state.data), state.size)));
+        std::error_code ec;
+        fs::create_directories("slow_inputs", ec);
+        const fs::path bin = fs::path("slow_inputs") / (std::string(name) + ".bin");
+        if (ec || fs::exists(bin, ec)) {
+            return;
+        }
+        std::ofstream(bin, std::ios::binary)
+            .write(reinterpret_cast<const char*>(state.data), static_cast<std::streamsize>(state.size));
+        std::ofstream(fs::path("slow_inputs") / (std::string(name) + ".txt"))
+            << "input_ms: " << elapsed_ns / 1000000 << "\nslowest_op: "
+            << (state.slowest_op.empty() ? "(harness session)" : state.slowest_op)
+            << "\nslowest_op_ms: " << state.slowest_op_ns / 1000000 << "\ncancelled: " << state.timed_out << "\n";
+    }
+
+    // Records the input that just finished if it ran past its deadline, while
+    // its bytes are still valid.
+    void finishInput() {
+        InputState& state = inputState();
+        if (state.start_ns == 0) {
+            return;
+        }
+        const int64_t elapsed_ns = monotonicNs() - state.start_ns;
+        state.start_ns = 0;
+        if (!state.timed_out && elapsed_ns < inputTimeoutMs() * 1000000) {
+            return;
+        }
+        if (state.slow_inputs++ == 0) {
+            std::atexit([] {
+                std::fprintf(stderr, "stat::tf_fuzz_slow_inputs: %llu\n",
+                             static_cast<unsigned long long>(inputState().slow_inputs));
+            });
+        }
+        storeSlowInput(state, elapsed_ns);
+    }
+
+    void startInput(const uint8_t* data, size_t size) {
+        InputState& state = inputState();
+        if (inputTimeoutMs() == 0) {
+            return;
+        }
+        state.data = data;
+        state.size = size;
+        state.start_ns = monotonicNs();
+        state.slowest_op.clear();
+        state.slowest_op_ns = 0;
+        state.timed_out = false;
+        if (state.cancellation->IsCancelled()) {
+            state.cancellation = std::make_unique<tensorflow::CancellationManager>();
+        }
+    }
+
+    // How long a cancelled async kernel gets to finish, chosen so that the
+    // deadline plus the grace stays inside libFuzzer's -timeout=2.
+    int64_t cancelGraceMs() {
+        return std::max<int64_t>(inputTimeoutMs() / 2, 1);
+    }
+
+    // An async kernel that ignores cancellation still holds the context on
+    // computeKernel's stack, so the input cannot be abandoned. It is saved to
+    // slow_inputs/ like any slow input and then waited for; if it never
+    // finishes, libFuzzer's -timeout reports it as a timeout, not a crash.
+    void waitUncancellable(const std::string& op, tensorflow::Notification* done) {
+        InputState& state = inputState();
+        state.slowest_op = op;
+        state.slowest_op_ns = monotonicNs() - state.start_ns;
+        state.timed_out = true;
+        storeSlowInput(state, state.slowest_op_ns);
+        std::fprintf(stderr, "tf_fuzzer_utils: %s did not finish within %lld ms of being cancelled\n", op.c_str(),
+                     static_cast<long long>(cancelGraceMs()));
+        done->WaitForNotification();
+    }
+
+    // Waits for an async kernel until the input's deadline; false if it passed.
+    bool waitForDeadline(tensorflow::Notification* done) {
+        const int64_t remaining = remainingNs();
+        if (remaining == std::numeric_limits<int64_t>::max()) {
+            done->WaitForNotification();
+            return true;
+        }
+        return tensorflow::WaitForNotificationWithTimeout(done, std::max<int64_t>(remaining / 1000, 1));
+    }
+
+    // A graph built for one signature together with the session running it.
+    struct CachedGraph {
+        std::unique_ptr<tensorflow::Session> session;
+        CachedCallable callable;
+        bool used = false; // ran since the last endInput()
+
+        ~CachedGraph() {
+            if (session) {
+                callable.release(session.get());
+                session->Close().IgnoreError();
+            }
+        }
+    };
+
+    using GraphCache = std::unordered_map<std::string, std::unique_ptr<CachedGraph>>;
+
+    // Leaked on purpose: sessions must not be torn down during static
+    // destruction, after the TF runtime they depend on is gone.
+    GraphCache& graphCache() {
+        static GraphCache* cache = new GraphCache();
+        return *cache;
+    }
+
+    bool isListArg(const tensorflow::OpDef::ArgDef& arg) {
+        return !arg.number_attr().empty() || !arg.type_list_attr().empty();
+    }
+
+    // Whether the op's container attr is redirected to kInputContainer.
+    bool scopesContainer(const tensorflow::OpDef& op_def) {
+#if TF_FUZZ_INPUT_CONTAINER
+        for (const auto& attr : op_def.attr()) {
+            if (attr.name() == "container") {
+                return true;
+            }
+        }
+#endif
+        return false;
+    }
+
+    // Length of a list argument as pinned by an explicit attr, or -1.
+    int listLengthFromAttrs(const tensorflow::OpDef::ArgDef& arg, const tf_fuzzer_utils::OpSpec& spec) {
+        for (const auto& attr : spec.attrs) {
+            if (!arg.number_attr().empty() && attr.first == arg.number_attr()) {
+                return static_cast<int>(attr.second.i());
+            }
+            if (!arg.type_list_attr().empty() && attr.first == arg.type_list_attr()) {
+                return attr.second.list().type_size();
+            }
+        }
+        return -1;
+    }
+
+    // Splits the flat input list over the op's input args. At most one list
+    // argument may have an unpinned length; it takes whatever is left over.
+    tensorflow::Status groupInputs(const tensorflow::OpDef& op_def, const tf_fuzzer_utils::OpSpec& spec,
+                                   size_t num_inputs, std::vector<int>* arg_sizes) {
+        int open_list = -1;
+        size_t pinned = 0;
+        for (int i = 0; i < op_def.input_arg_size(); ++i) {
+            const auto& arg = op_def.input_arg(i);
+            int n = 1;
+            if (isListArg(arg)) {
+                n = listLengthFromAttrs(arg, spec);
+                if (n < 0) {
+                    if (open_list >= 0) {
+                        return tensorflow::errors::InvalidArgument(
+                            "Op ", spec.op, " has several list inputs; pin their lengths with attrs");
+                    }
+                    open_list = i;
+                    n = 0;
+                }
+            }
+            arg_sizes->push_back(n);
+            pinned += n;
+        }
+        if (open_list >= 0 && num_inputs >= pinned) {
+            (*arg_sizes)[open_list] = static_cast<int>(num_inputs - pinned);
+            pinned = num_inputs;
+        }
+        if (pinned != num_inputs) {
+            return tensorflow::errors::InvalidArgument(
+                "Op ", spec.op, " expects ", pinned, " inputs, got ", num_inputs);
+        }
+        return absl::OkStatus();
+    }
+
+    std::string graphSignature(const tf_fuzzer_utils::OpSpec& spec, const std::vector<tensorflow::Tensor>& inputs) {
+        std::string key = spec.op;
+        for (const auto& input : inputs) {
+            tensorflow::strings::StrAppend(&key, "|", static_cast<int>(input.dtype()), ":", input.dims());
+        }
+        for (const auto& attr : spec.attrs) {
+            std::string value;
+            tensorflow::SerializeToStringDeterministic(attr.second, &value);
+            tensorflow::strings::StrAppend(&key, "|", attr.first, "=", value);
+        }
+        return key;
+    }
+
+    // Placeholder(s) -> target op, with every output of the target fetched.
+    // Adds the op fed by Placeholders `<prefix>input_<i>` as `<prefix>target`;
+    // the feed names go to `feed_names`.
+    tensorflow::Status addOpNode(tensorflow::Graph* graph, const std::string& prefix,
+                                 const tf_fuzzer_utils::OpSpec& spec, const std::vector<tensorflow::Tensor>& inputs,
+                                 std::vector<std::string>* feed_names, tensorflow::Node** target) {
+        const tensorflow::OpDef* op_def = nullptr;
+        TF_RETURN_IF_ERROR(tensorflow::OpRegistry::Global()->LookUpOpDef(spec.op, &op_def));
+        std::vector<int> arg_sizes;
+        TF_RETURN_IF_ERROR(groupInputs(*op_def, spec, inputs.size(), &arg_sizes));
+
+        std::vector<tensorflow::NodeBuilder::NodeOut> feeds;
+        feeds.reserve(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            const std::string name = tensorflow::strings::StrCat(prefix, "input_", i);
+            tensorflow::Node* placeholder = nullptr;
+            TF_RETURN_IF_ERROR(tensorflow::NodeBuilder(name, "Placeholder")
+                                   .Attr("dtype", inputs[i].dtype())
+                                   .Attr("shape", tensorflow::PartialTensorShape(
+                                                      std::vector<int64_t>(inputs[i].dims(), -1)))
+                                   .Finalize(graph, &placeholder));
+            feeds.emplace_back(placeholder, 0);
+            feed_names->push_back(name + ":0");
+        }
+
+        tensorflow::NodeBuilder builder(prefix + kTargetNode, spec.op);
+        size_t next = 0;
+        for (int i = 0; i < op_def->input_arg_size(); ++i) {
+            if (isListArg(op_def->input_arg(i))) {
+                std::vector<tensorflow::NodeBuilder::NodeOut> list(feeds.begin() + next,
+                                                                   feeds.begin() + next + arg_sizes[i]);
+                builder.Input(list);
+            } else {
+                builder.Input(feeds[next]);
+            }
+            next += arg_sizes[i];
+        }
+        const bool scoped = scopesContainer(*op_def);
+        for (const auto& attr : spec.attrs) {
+            if (!scoped || attr.first != "container") {
+                builder.Attr(attr.first, attr.second);
+            }
+        }
+        if (scoped) {
+            builder.Attr("container", kInputContainer);
+        }
+        return builder.Finalize(graph, target);
+    }
+
+    tensorflow::Status buildGraph(const tf_fuzzer_utils::OpSpec& spec, const std::vector<tensorflow::Tensor>& inputs,
+                                  tensorflow::GraphDef* graph_def, tensorflow::CallableOptions* callable) {
+        const tensorflow::OpDef* op_def = nullptr;
+        TF_RETURN_IF_ERROR(tensorflow::OpRegistry::Global()->LookUpOpDef(spec.op, &op_def));
+        tensorflow::Graph graph(tensorflow::OpRegistry::Global());
+        tensorflow::VersionDef versions = graph.versions();
+        versions.set_producer(graphDefVersion(*op_def));
+        graph.set_versions(versions);
+        std::vector<std::string> feed_names;
+        tensorflow::Node* target = nullptr;
+        TF_RETURN_IF_ERROR(addOpNode(&graph, "", spec, inputs, &feed_names, &target));
+
+        for (const auto& name : feed_names) {
+            callable->add_feed(name);
+        }
+        for (int i = 0; i < target->num_outputs(); ++i) {
+            callable->add_fetch(tensorflow::strings::StrCat(kTargetNode, ":", i));
+        }
+        if (target->num_outputs() == 0) {
+            callable->add_target(kTargetNode);
+        }
+        graph.ToGraphDef(graph_def);
+        return absl::OkStatus();
+    }
+
+    tensorflow::Status createCachedGraph(const tf_fuzzer_utils::OpSpec& spec,
+                                         const std::vector<tensorflow::Tensor>& inputs,
+                                         std::unique_ptr<CachedGraph>* entry) {
+        tensorflow::GraphDef graph_def;
+        tensorflow::CallableOptions callable;
+        TF_RETURN_IF_ERROR(buildGraph(spec, inputs, &graph_def, &callable));
+        callable.mutable_run_options()->set_timeout_in_ms(inputTimeoutMs());
+
+        auto cached = std::make_unique<CachedGraph>();
+        cached->session.reset(tensorflow::NewSession(tf_fuzzer_utils::makeSessionOptions()));
+        if (!cached->session) {
+            return tensorflow::errors::Internal("Failed to create session");
+        }
+        TF_RETURN_IF_ERROR(cached->session->Create(graph_def));
+        TF_RETURN_IF_ERROR(cached->callable.make(cached->session.get(), std::move(callable)));
+        *entry = std::move(cached);
+        return absl::OkStatus();
+    }
+
+    // --- Dataset pipelines ---
+
+    // One pipeline per signature: `init` builds the dataset from the fed
+    // tensors, binds it to a new anonymous iterator and returns the
+    // iterator handle; `next` pulls one element through a fed handle.
+    struct CachedPipeline {
+        std::unique_ptr<tensorflow::Session> session;
+        CachedCallable init;
+        CachedCallable next;
+        bool used = false;
+
+        ~CachedPipeline() {
+            if (session) {
+                init.release(session.get());
+                next.release(session.get());
+                session->Close().IgnoreError();
+            }
+        }
+    };
+
+    using PipelineCache = std::unordered_map<std::string, std::unique_ptr<CachedPipeline>>;
+
+    PipelineCache& pipelineCache() {
+        static PipelineCache* cache = new PipelineCache();
+        return *cache;
+    }
+
+    std::string pipelineSignature(const tf_fuzzer_utils::DatasetSpec& spec,
+                                  const std::vector<tensorflow::Tensor>& components,
+                                  const std::vector<tensorflow::Tensor>& inputs) {
+        std::string key = graphSignature(spec.op, inputs);
+        for (const auto& component : components) {
+            tensorflow::strings::StrAppend(&key, "|c", static_cast<int>(component.dtype()), ":", component.dims());
+        }
+        for (const auto& fdef : spec.functions) {
+            std::string value;
+            tensorflow::SerializeToStringDeterministic(fdef, &value);
+            tensorflow::strings::StrAppend(&key, "|f", value);
+        }
+        return key;
+    }
+
+    tensorflow::Status addPlaceholder(tensorflow::Graph* graph, const std::string& name, tensorflow::DataType dtype,
+                                      int rank, tensorflow::Node** node) {
+        tensorflow::NodeBuilder builder(name, "Placeholder");
+        builder.Attr("dtype", dtype);
+        if (rank >= 0) {
+            builder.Attr("shape", tensorflow::PartialTensorShape(std::vector<int64_t>(rank, -1)));
+        }
+        return builder.Finalize(graph, node);
+    }
+
+    const tensorflow::AttrValue* findAttr(const tensorflow::Node* node, std::initializer_list<const char*> names) {
+        for (const char* name : names) {
+            const auto it = node->def().attr().find(name);
+            if (it != node->def().attr().end()) {
+                return &it->second;
+            }
+        }
+        return nullptr;
+    }
+
+    // [components ->] TensorSliceDataset -> target -> MakeIterator(AnonymousIteratorV3),
+    // plus a separate Placeholder(handle) -> IteratorGetNext for `next`.
+    tensorflow::Status buildPipeline(const tf_fuzzer_utils::DatasetSpec& spec,
+                                     const std::vector<tensorflow::Tensor>& components,
+                                     const std::vector<tensorflow::Tensor>& inputs, tensorflow::GraphDef* graph_def,
+                                     tensorflow::CallableOptions* init, tensorflow::CallableOptions* next) {
+        const tensorflow::OpDef* op_def = nullptr;
+        TF_RETURN_IF_ERROR(tensorflow::OpRegistry::Global()->LookUpOpDef(spec.op.op, &op_def));
+        const bool reads_dataset = op_def->input_arg_size() > 0 &&
+                                   op_def->input_arg(0).type() == tensorflow::DT_VARIANT;
+
+        tensorflow::Graph graph(tensorflow::OpRegistry::Global());
+        std::vector<tensorflow::NodeBuilder::NodeOut> feeds;
+        if (reads_dataset) {
+            if (components.empty()) {
+                return tensorflow::errors::InvalidArgument(spec.op.op, " reads a dataset but no components were given");
+            }
+            std::vector<tensorflow::NodeBuilder::NodeOut> slices;
+            std::vector<tensorflow::PartialTensorShape> slice_shapes;
+            for (size_t i = 0; i < components.size(); ++i) {
+                const std::string name = tensorflow::strings::StrCat("component_", i);
+                tensorflow::Node* placeholder = nullptr;
+                TF_RETURN_IF_ERROR(addPlaceholder(&graph, name, components[i].dtype(), components[i].dims(), &placeholder));
+                slices.emplace_back(placeholder, 0);
+                slice_shapes.emplace_back(std::vector<int64_t>(std::max(components[i].dims() - 1, 0), -1));
+                init->add_feed(name + ":0");
+            }
+            tensorflow::Node* source = nullptr;
+            TF_RETURN_IF_ERROR(tensorflow::NodeBuilder("source", "TensorSliceDataset")
+                                   .Input(slices)
+                                   .Attr("output_shapes", slice_shapes)
+                                   .Finalize(&graph, &source));
+            feeds.emplace_back(source, 0);
+        }
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            const std::string name = tensorflow::strings::StrCat("input_", i);
+            tensorflow::Node* placeholder = nullptr;
+            TF_RETURN_IF_ERROR(addPlaceholder(&graph, name, inputs[i].dtype(), inputs[i].dims(), &placeholder));
+            feeds.emplace_back(placeholder, 0);
+            init->add_feed(name + ":0");
+        }
+
+        std::vector<int> arg_sizes;
+        TF_RETURN_IF_ERROR(groupInputs(*op_def, spec.op, feeds.size(), &arg_sizes));
+        tensorflow::NodeBuilder builder(kTargetNode, spec.op.op);
+        size_t next_feed = 0;
+        for (int i = 0; i < op_def->input_arg_size(); ++i) {
+            if (isListArg(op_def->input_arg(i))) {
+                builder.Input(std::vector<tensorflow::NodeBuilder::NodeOut>(
+                    feeds.begin() + next_feed, feeds.begin() + next_feed + arg_sizes[i]));
+            } else {
+                builder.Input(feeds[next_feed]);
+            }
+            next_feed += arg_sizes[i];
+        }
+        std::vector<std::string> explicit_attrs;
+        for (const auto& attr : spec.op.attrs) {
+            builder.Attr(attr.first, attr.second);
+            explicit_attrs.push_back(attr.first);
+        }
+        // Element-preserving ops (batch, shuffle, take, ...) can leave the
+        // element signature to the source.
+        auto has = [&](const char* name) {
+            return std::find(explicit_attrs.begin(), explicit_attrs.end(), name) != explicit_attrs.end();
+        };
+        if (reads_dataset && !has("output_types")) {
+            std::vector<tensorflow::DataType> types;
+            for (const auto& component : components) {
+                types.push_back(component.dtype());
+            }
+            builder.Attr("output_types", types);
+        }
+        if (reads_dataset && !has("output_shapes")) {
+            builder.Attr("output_shapes", std::vector<tensorflow::PartialTensorShape>(components.size()));
+        }
+        tensorflow::Node* target = nullptr;
+        TF_RETURN_IF_ERROR(builder.Finalize(&graph, &target));
+
+        const tensorflow::AttrValue* types = findAttr(target, {"output_types", "Toutput_types"});
+        const tensorflow::AttrValue* shapes = findAttr(target, {"output_shapes"});
+        if (types == nullptr || shapes == nullptr) {
+            return tensorflow::errors::InvalidArgument(spec.op.op, " does not produce a dataset");
+        }
+
+        tensorflow::Node* iterator = nullptr;
+        TF_RETURN_IF_ERROR(tensorflow::NodeBuilder("iterator", "AnonymousIteratorV3")
+                               .Attr("output_types", *types)
+                               .Attr("output_shapes", *shapes)
+                               .Finalize(&graph, &iterator));
+        tensorflow::Node* make_iterator = nullptr;
+        TF_RETURN_IF_ERROR(tensorflow::NodeBuilder("make_iterator", "MakeIterator")
+                               .Input(target, 0)
+                               .Input(iterator, 0)
+                               .Finalize(&graph, &make_iterator));
+        init->add_fetch("iterator:0");
+        init->add_target("make_iterator");
+
+        tensorflow::Node* handle = nullptr;
+        TF_RETURN_IF_ERROR(addPlaceholder(&graph, "iterator_handle", tensorflow::DT_RESOURCE, -1, &handle));
+        tensorflow::Node* get_next = nullptr;
+        TF_RETURN_IF_ERROR(tensorflow::NodeBuilder("get_next", "IteratorGetNext")
+                               .Input(handle, 0)
+                               .Attr("output_types", *types)
+                               .Attr("output_shapes", *shapes)
+                               .Finalize(&graph, &get_next));
+        next->add_feed("iterator_handle:0");
+        for (int i = 0; i < get_next->num_outputs(); ++i) {
+            next->add_fetch(tensorflow::strings::StrCat("get_next:", i));
+        }
+
+        graph.ToGraphDef(graph_def);
+        for (const auto& fdef : spec.functions) {
+            *graph_def->mutable_library()->add_function() = fdef;
+        }
+        return absl::OkStatus();
+    }
+
+    tensorflow::Status createCachedPipeline(const tf_fuzzer_utils::DatasetSpec& spec,
+                                            const std::vector<tensorflow::Tensor>& components,
+                                            const std::vector<tensorflow::Tensor>& inputs,
+                                            std::unique_ptr<CachedPipeline>* entry) {
+        tensorflow::GraphDef graph_def;
+        tensorflow::CallableOptions init;
+        tensorflow::CallableOptions next;
+        TF_RETURN_IF_ERROR(buildPipeline(spec, components, inputs, &graph_def, &init, &next));
+        init.mutable_run_options()->set_timeout_in_ms(inputTimeoutMs());
+        next.mutable_run_options()->set_timeout_in_ms(inputTimeoutMs());
+
+        auto cached = std::make_unique<CachedPipeline>();
+        cached->session.reset(tensorflow::NewSession(tf_fuzzer_utils::makeSessionOptions()));
+        if (!cached->session) {
+            return tensorflow::errors::Internal("Failed to create session");
+        }
+        TF_RETURN_IF_ERROR(cached->session->Create(graph_def));
+        TF_RETURN_IF_ERROR(cached->init.make(cached->session.get(), std::move(init)));
+        TF_RETURN_IF_ERROR(cached->next.make(cached->session.get(), std::move(next)));
+        *entry = std::move(cached);
+        return absl::OkStatus();
+    }
+
+    // --- Direct kernel execution ---
+
+    // One kernel instantiated for one signature. The Params block is filled
+    // once and only its inputs change between executions.
+    struct CachedKernel {
+        std::unique_ptr<tensorflow::OpKernel> kernel;
+        tensorflow::OpKernelContext::Params params;
+        std::function<void(std::function<void()>)> runner;
+        std::vector<tensorflow::TensorValue> inputs;
+        // Ref inputs point at copies sharing the caller's buffers, so in-place
+        // updates reach the caller and replaced refs do not.
+        std::vector<tensorflow::Tensor> refs;
+        tensorflow::mutex ref_mu;
+        // Whether the kernel holds on to the resource it created, so it has
+        // to be rebuilt once the per-input container is gone.
+        bool owns_resource = false;
+    };
+
+    using KernelCache = std::unordered_map<std::string, std::unique_ptr<CachedKernel>>;
+
+    KernelCache& kernelCache() {
+        static KernelCache* cache = new KernelCache();
+        return *cache;
+    }
+
+    // A process-wide CPU device shared by all kernels; it owns the resource
+    // manager that stateful kernels look their resources up in.
+    tensorflow::Device* cpuDevice() {
+        static tensorflow::Device* device = [] {
+            std::unique_ptr<tensorflow::Device> cpu = tensorflow::DeviceFactory::NewDevice(
+                "CPU", tf_fuzzer_utils::makeSessionOptions(), "/job:localhost/replica:0/task:0");
+            return cpu.release();
+        }();
+        return device;
+    }
+
+    bool hasRefArgs(const tensorflow::OpDef& op_def) {
+        for (const auto& arg : op_def.input_arg()) {
+            if (arg.is_ref()) {
+                return true;
+            }
+        }
+        for (const auto& arg : op_def.output_arg()) {
+            if (arg.is_ref()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Ops that take or return a resource: DT_RESOURCE handles, ref inputs
+    // and the string handles of the TensorArrayV2 family. A handle only
+    // resolves on the device that created it, so these always run on the
+    // kernel device, whatever the backend.
+    bool passesHandles(const tensorflow::OpDef& op_def) {
+        if (hasRefArgs(op_def)) {
+            return true;
+        }
+        auto is_handle = [](const tensorflow::OpDef::ArgDef& arg) {
+            return arg.type() == tensorflow::DT_RESOURCE ||
+                   (arg.type() == tensorflow::DT_STRING && absl::EndsWith(arg.name(), "handle"));
+        };
+        return std::any_of(op_def.input_arg().begin(), op_def.input_arg().end(), is_handle) ||
+               std::any_of(op_def.output_arg().begin(), op_def.output_arg().end(), is_handle);
+    }
+
+    // Deprecated ops (TensorArray, TensorArrayV2, ...) are built at the last
+    // GraphDef version that still accepts them.
+    int graphDefVersion(const tensorflow::OpDef& op_def) {
+        if (op_def.has_deprecation()) {
+            return std::min(op_def.deprecation().version() - 1, TF_GRAPH_DEF_VERSION);
+        }
+        return TF_GRAPH_DEF_VERSION;
+    }
+
+    // Creators that look their resource up once, keep it in the kernel and
+    // only hand out its name afterwards (ConditionalAccumulatorBaseOp).
+    // Queues, barriers and other ResourceOpKernels hold a weak reference and
+    // create the resource again once the container is cleared.
+    bool ownsResource(const std::string& op) {
+        return op == "ConditionalAccumulator" || op == "SparseConditionalAccumulator";
+    }
+
+    // Function attrs need the executor; such ops always run through a session.
+    bool needsSession(const tensorflow::OpDef& op_def) {
+        for (const auto& attr : op_def.attr()) {
+            if (attr.type() == "func" || attr.type() == "list(func)") {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    tensorflow::Status createCachedKernel(const tf_fuzzer_utils::OpSpec& spec, const tensorflow::OpDef& op_def,
+                                          const std::vector<tensorflow::Tensor>& inputs,
+                                          std::unique_ptr<CachedKernel>* entry) {
+        std::vector<int> arg_sizes;
+        TF_RETURN_IF_ERROR(groupInputs(op_def, spec, inputs.size(), &arg_sizes));
+
+        tensorflow::NodeDefBuilder builder(kTargetNode, spec.op);
+        size_t next = 0;
+        for (int i = 0; i < op_def.input_arg_size(); ++i) {
+            std::vector<tensorflow::NodeDefBuilder::NodeOut> args;
+            const bool ref = op_def.input_arg(i).is_ref();
+            for (int j = 0; j < arg_sizes[i]; ++j, ++next) {
+                const tensorflow::DataType dtype = inputs[next].dtype();
+                args.emplace_back(tensorflow::strings::StrCat("input_", next), 0,
+                                  ref ? tensorflow::MakeRefType(dtype) : dtype);
+            }
+            if (isListArg(op_def.input_arg(i))) {
+                builder.Input(args);
+            } else {
+                builder.Input(args[0]);
+            }
+        }
+        const bool scoped = scopesContainer(op_def);
+        for (const auto& attr : spec.attrs) {
+            if (!scoped || attr.first != "container") {
+                builder.Attr(attr.first, attr.second);
+            }
+        }
+        if (scoped) {
+            builder.Attr("container", kInputContainer);
+        }
+        tensorflow::NodeDef node_def;
+        TF_RETURN_IF_ERROR(builder.Finalize(&node_def));
+
+        tensorflow::Device* device = cpuDevice();
+        auto cached = std::make_unique<CachedKernel>();
+        cached->owns_resource = scoped && ownsResource(spec.op);
+        tensorflow::Status status;
+        cached->kernel = tensorflow::CreateOpKernel(tensorflow::DEVICE_CPU, device,
+                                                    device->GetAllocator(tensorflow::AllocatorAttributes()),
+                                                    node_def, graphDefVersion(op_def), &status);
+        TF_RETURN_IF_ERROR(status);
+
+        cached->runner = [](std::function<void()> fn) { fn(); };
+        tensorflow::OpKernelContext::Params& params = cached->params;
+        params.device = device;
+        params.op_kernel = cached->kernel.get();
+        params.resource_manager = device->resource_manager();
+        params.frame_iter = tensorflow::FrameAndIter(0, 0);
+        params.runner = &cached->runner;
+        *entry = std::move(cached);
+        return absl::OkStatus();
+    }
+
+    // One step per input: every kernel call of an input shares its step
+    // container, so step-scoped resources (TensorArrays, stacks, ...) created
+    // by one runOp can be used by the next and die in endInput().
+    std::unique_ptr<tensorflow::ScopedStepContainer>& inputStep() {
+        static auto* step = new std::unique_ptr<tensorflow::ScopedStepContainer>();
+        return *step;
+    }
+
+    tensorflow::ScopedStepContainer* currentStep() {
+        static int64_t step_id = 0;
+        std::unique_ptr<tensorflow::ScopedStepContainer>& step = inputStep();
+        if (!step) {
+            tensorflow::Device* device = cpuDevice();
+            step = std::make_unique<tensorflow::ScopedStepContainer>(++step_id, [device](const std::string& name) {
+                device->resource_manager()->Cleanup(name).IgnoreError();
+            });
+        }
+        return step.get();
+    }
+
+    tensorflow::Status computeKernel(CachedKernel* cached, const std::vector<tensorflow::Tensor>& inputs,
+                                     std::vector<tensorflow::Tensor>* outputs) {
+        tensorflow::Device* device = cpuDevice();
+        tensorflow::OpKernel* kernel = cached->kernel.get();
+
+        cached->inputs.clear();
+        cached->refs.resize(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            if (tensorflow::IsRefType(kernel->input_type(i))) {
+                cached->refs[i] = inputs[i];
+                cached->inputs.emplace_back(&cached->ref_mu, &cached->refs[i]);
+            } else {
+                cached->inputs.emplace_back(const_cast<tensorflow::Tensor*>(&inputs[i]));
+            }
+        }
+        tensorflow::ScopedStepContainer* step_container = currentStep();
+        tensorflow::OpKernelContext::Params& params = cached->params;
+        params.inputs = cached->inputs;
+        params.step_id = step_container->step_id();
+        params.step_container = step_container;
+        params.cancellation_manager = inputState().cancellation.get();
+        const bool sampled = stepStats().sampling;
+        params.track_allocations = sampled;
+
+        tensorflow::OpKernelContext context(&params, kernel->num_outputs());
+        const int64_t compute_start_ns = sampled ? monotonicNs() : 0;
+        bool cancelled = false;
+        if (tensorflow::AsyncOpKernel* async = kernel->AsAsync()) {
+            tensorflow::Notification done;
+            device->ComputeAsync(async, &context, [&done] { done.Notify(); });
+            if (!waitForDeadline(&done)) {
+                // Blocking kernels (queue dequeues, barriers, ...) return
+                // once their cancellation callbacks run.
+                params.cancellation_manager->StartCancel();
+                if (!tensorflow::WaitForNotificationWithTimeout(&done, cancelGraceMs() * 1000)) {
+                    waitUncancellable(kernel->type_string(), &done);
+                }
+                cancelled = true;
+            }
+        } else {
+            device->Compute(kernel, &context);
+        }
+        params.step_container = nullptr;
+        if (sampled) {
+            int64_t alloc_bytes = 0;
+            for (auto& wrapped : context.ConsumeWrappedAllocators()) {
+                alloc_bytes += static_cast<int64_t>(std::get<0>(wrapped.second->GetSizes()));
+                wrapped.second->GetRecordsAndUnRef();
+            }
+            addOpTiming(kernel->type_string(), monotonicNs() - compute_start_ns, 0, alloc_bytes);
+        }
+        tensorflow::Status status =
+            cancelled ? tensorflow::errors::DeadlineExceeded(kernel->type_string(), " cancelled at the input deadline")
+                      : context.status();
+
+        for (int i = 0; status.ok() && i < kernel->num_outputs(); ++i) {
+            tensorflow::Tensor* output = context.mutable_output(i);
+            outputs->push_back(output ? *output : tensorflow::Tensor());
+        }
+        cached->refs.clear();
+        return status;
+    }
+
+    // --- Resource scoping ---
+
+    // Counters behind TF_FUZZ_RESOURCE_STATS. Resources and bytes are what a
+    // cleanup released; the baselines are taken after the first cleanup, so
+    // growth is memory that survived every cleanup since.
+    struct ResourceStats {
+        uint64_t inputs = 0;
+        uint64_t leaky_inputs = 0;
+        uint64_t resources = 0;
+        size_t released_bytes = 0;
+        size_t first_bytes_in_use = 0;
+        size_t last_bytes_in_use = 0;
+        long first_rss_kb = 0;
+        long last_rss_kb = 0;
+    };
+
+    ResourceStats* resourceStats() {
+        static ResourceStats* stats = [] {
+            const char* env = std::getenv("TF_FUZZ_RESOURCE_STATS");
+            if (!(env && env[0] == '1')) {
+                return static_cast<ResourceStats*>(nullptr);
+            }
+            std::atexit([] {
+                const ResourceStats& s = *resourceStats();
+                std::fprintf(stderr,
+                             "stat::tf_fuzz_leaky_inputs: %llu\nstat::tf_fuzz_leaked_resources: %llu\n"
+                             "stat::tf_fuzz_released_bytes: %zu\nstat::tf_fuzz_bytes_in_use_growth: %lld\n"
+                             "stat::tf_fuzz_rss_growth_kb: %ld\n",
+                             static_cast<unsigned long long>(s.leaky_inputs),
+                             static_cast<unsigned long long>(s.resources), s.released_bytes,
+                             static_cast<long long>(s.last_bytes_in_use) -
+                                 static_cast<long long>(s.first_bytes_in_use),
+                             s.last_rss_kb - s.first_rss_kb);
+            });
+            return new ResourceStats();
+        }();
+        return stats;
+    }
+
+    long residentKb() {
+        std::ifstream statm("/proc/self/statm");
+        long pages = 0;
+        long resident = 0;
+        statm >> pages >> resident;
+        return resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+
+    // Number of resources held by `rm`, one DebugString line each.
+    uint64_t countResources(const tensorflow::ResourceMgr* rm) {
+        const std::string text = rm->DebugString();
+        return text.empty() ? 0 : std::count(text.begin(), text.end(), '\n') + 1;
+    }
+
+    // Drops the per-input and default containers of every device of a cached
+    // session that ran during the input.
+    template <typename Entry>
+    void clearSession(Entry& entry, uint64_t* resources) {
+        if (!entry.used) {
+            return;
+        }
+        entry.used = false;
+        const tensorflow::DeviceMgr* devices = nullptr;
+        if (!entry.session->LocalDeviceManager(&devices).ok()) {
+            return;
+        }
+        if (resources != nullptr) {
+            for (tensorflow::Device* device : devices->ListDevices()) {
+                *resources += countResources(device->resource_manager());
+            }
+        }
+        devices->ClearContainers({kInputContainer});
+        devices->ClearContainers({});
+    }
+
+    void releaseInputResources() {
+        ResourceStats* stats = resourceStats();
+        uint64_t resources = 0;
+        uint64_t* counted = stats != nullptr ? &resources : nullptr;
+        const size_t bytes_before = stats != nullptr ? tf_fuzzer_utils::allocatorStats().bytes_in_use : 0;
+
+        // The step only exists if a kernel ran during the input.
+        std::unique_ptr<tensorflow::ScopedStepContainer>& step = inputStep();
+        if (step) {
+            tensorflow::ResourceMgr* rm = cpuDevice()->resource_manager();
+            if (counted != nullptr) {
+                resources += countResources(rm);
+            }
+            step.reset();
+#if TF_FUZZ_INPUT_CONTAINER
+            rm->Cleanup(kInputContainer).IgnoreError();
+            rm->Cleanup(rm->default_container()).IgnoreError();
+            // Every other kernel stays cached and creates its resource
+            // again on its next lookup.
+            KernelCache& kernels = kernelCache();
+            for (auto it = kernels.begin(); it != kernels.end();) {
+                it = it->second->owns_resource ? kernels.erase(it) : std::next(it);
+            }
+#endif
+        }
+#if TF_FUZZ_INPUT_CONTAINER
+        for (auto& entry : graphCache()) {
+            clearSession(*entry.second, counted);
+        }
+        for (auto& entry : pipelineCache()) {
+            clearSession(*entry.second, counted);
+        }
+#endif
+
+        if (stats == nullptr) {
+            return;
+        }
+        const size_t bytes_after = tf_fuzzer_utils::allocatorStats().bytes_in_use;
+        const long rss_kb = residentKb();
+        if (stats->inputs++ == 0) {
+            stats->first_bytes_in_use = bytes_after;
+            stats->first_rss_kb = rss_kb;
+        }
+        stats->last_bytes_in_use = bytes_after;
+        stats->last_rss_kb = rss_kb;
+        stats->resources += resources;
+        stats->released_bytes += bytes_before > bytes_after ? bytes_before - bytes_after : 0;
+        if (resources > 0) {
+            ++stats->leaky_inputs;
+        }
+    }
+
+    // --- Eager execution ---
+
+    // Owns a TF_Status for the duration of one C API call sequence.
+    struct ScopedTFStatus {
+        TF_Status* status = TF_NewStatus();
+        ~ScopedTFStatus() { TF_DeleteStatus(status); }
+        bool ok() const { return TF_GetCode(status) == TF_OK; }
+        tensorflow::Status toStatus() const {
+            return tensorflow::Status(static_cast<absl::StatusCode>(TF_GetCode(status)), TF_Message(status));
+        }
+    };
+
+    // One eager context per process, created on first use and leaked.
+    TFE_Context* eagerContext() {
+        static TFE_Context* context = [] {
+            ScopedTFStatus status;
+            TFE_ContextOptions* options = TFE_NewContextOptions();
+            const std::string config = tf_fuzzer_utils::makeSessionOptions().config.SerializeAsString();
+            TFE_ContextOptionsSetConfig(options, config.data(), config.size(), status.status);
+            TFE_ContextOptionsSetAsync(options, 0);
+            TFE_Context* ctx = TFE_NewContext(options, status.status);
+            TFE_DeleteContextOptions(options);
+            return status.ok() ? ctx : nullptr;
+        }();
+        return context;
+    }
+
+    // Op handles are reused across inputs with TFE_OpReset, one per op name.
+    std::unordered_map<std::string, TFE_Op*>& eagerOps() {
+        static auto* ops = new std::unordered_map<std::string, TFE_Op*>();
+        return *ops;
+    }
+
+    // Only dtypes with a flat in-memory layout can be copied to a TF_Tensor.
+    bool isEagerCopyable(tensorflow::DataType dtype) {
+        return dtype != tensorflow::DT_STRING && dtype != tensorflow::DT_RESOURCE &&
+               dtype != tensorflow::DT_VARIANT && !tensorflow::IsRefType(dtype);
+    }
+
+    TFE_TensorHandle* toEagerHandle(const tensorflow::Tensor& tensor, TF_Status* status) {
+        std::vector<int64_t> dims(tensor.dims());
+        for (int i = 0; i < tensor.dims(); ++i) {
+            dims[i] = tensor.dim_size(i);
+        }
+        const auto data = tensor.tensor_data();
+        TF_Tensor* tf_tensor = TF_AllocateTensor(static_cast<TF_DataType>(tensor.dtype()), dims.data(),
+                                                 static_cast<int>(dims.size()), data.size());
+        if (data.size() > 0) {
+            std::memcpy(TF_TensorData(tf_tensor), data.data(), data.size());
+        }
+        TFE_TensorHandle* handle = TFE_NewTensorHandle(tf_tensor, status);
+        TF_DeleteTensor(tf_tensor);
+        return handle;
+    }
+
+    tensorflow::Status fromEagerHandle(TFE_TensorHandle* handle, tensorflow::Tensor* tensor) {
+        ScopedTFStatus status;
+        TF_Tensor* tf_tensor = TFE_TensorHandleResolve(handle, status.status);
+        if (!status.ok()) {
+            return status.toStatus();
+        }
+        const auto dtype = static_cast<tensorflow::DataType>(TF_TensorType(tf_tensor));
+        tensorflow::TensorShape shape;
+        for (int i = 0; i < TF_NumDims(tf_tensor); ++i) {
+            shape.AddDim(TF_Dim(tf_tensor, i));
+        }
+        if (isEagerCopyable(dtype)) {
+            *tensor = tensorflow::Tensor(dtype, shape);
+            const auto data = tensor->tensor_data();
+            std::memcpy(const_cast<char*>(data.data()), TF_TensorData(tf_tensor),
+                        std::min(data.size(), TF_TensorByteSize(tf_tensor)));
+        } else {
+            *tensor = tensorflow::Tensor();
+        }
+        TF_DeleteTensor(tf_tensor);
+        return absl::OkStatus();
+    }
+
+    tensorflow::Status executeEager(TFE_Op* op, const tf_fuzzer_utils::OpSpec& spec, const tensorflow::OpDef& op_def,
+                                    const std::vector<TFE_TensorHandle*>& handles,
+                                    std::vector<tensorflow::Tensor>* outputs) {
+        std::vector<int> arg_sizes;
+        TF_RETURN_IF_ERROR(groupInputs(op_def, spec, handles.size(), &arg_sizes));
+
+        ScopedTFStatus status;
+        TFE_OpReset(op, spec.op.c_str(), nullptr, status.status);
+        if (!status.ok()) {
+            return status.toStatus();
+        }
+        size_t next = 0;
+        for (int i = 0; i < op_def.input_arg_size() && status.ok(); ++i) {
+            if (isListArg(op_def.input_arg(i))) {
+                TFE_OpAddInputList(op, const_cast<TFE_TensorHandle**>(handles.data()) + next, arg_sizes[i],
+                                   status.status);
+            } else {
+                TFE_OpAddInput(op, handles[next], status.status);
+            }
+            next += arg_sizes[i];
+        }
+        for (const auto& attr : spec.attrs) {
+            if (!status.ok()) {
+                break;
+            }
+            const std::string proto = attr.second.SerializeAsString();
+            TFE_OpSetAttrValueProto(op, attr.first.c_str(), proto.data(), proto.size(), status.status);
+        }
+        if (!status.ok()) {
+            return status.toStatus();
+        }
+
+        constexpr int kMaxRetvals = 64;
+        TFE_TensorHandle* retvals[kMaxRetvals];
+        int num_retvals = kMaxRetvals;
+        TFE_Execute(op, retvals, &num_retvals, status.status);
+        if (!status.ok()) {
+            return status.toStatus();
+        }
+        tensorflow::Status result;
+        for (int i = 0; i < num_retvals; ++i) {
+            tensorflow::Tensor output;
+            if (result.ok()) {
+                result = fromEagerHandle(retvals[i], &output);
+                outputs->push_back(std::move(output));
+            }
+            TFE_DeleteTensorHandle(retvals[i]);
+        }
+        return result;
+    }
+
+    // Input parsing: one memcpy for the whole tensor instead of a flat(i)
+    // store per element.
+    template <typename T>
+    void fillPod(tensorflow::Tensor& tensor, const uint8_t* data, size_t& offset, size_t total_size) {
+        auto flat = tensor.flat<T>();
+        const size_t num_elements = flat.size();
+        const size_t available = offset < total_size ? (total_size - offset) / sizeof(T) : 0;
+        const size_t copied = std::min(num_elements, available);
+
+        uint8_t* dst = reinterpret_cast<uint8_t*>(flat.data());
+        if (copied > 0) {
+            std::memcpy(dst, data + offset, copied * sizeof(T));
+            offset += copied * sizeof(T);
+        }
+        std::memset(dst + copied * sizeof(T), 0, (num_elements - copied) * sizeof(T));
+    }
+
+    void fillBool(tensorflow::Tensor& tensor, const uint8_t* data, size_t& offset, size_t total_size) {
+        fillPod<bool>(tensor, data, offset, total_size);
+        // Arbitrary bytes are not valid bools; keep kernels out of UB.
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(tensor.flat<bool>().data());
+        for (int64_t i = 0; i < tensor.NumElements(); ++i) {
+            bytes[i] = bytes[i] != 0;
+        }
+    }
+
+    void fillString(tensorflow::Tensor& tensor, const uint8_t* data, size_t& offset, size_t total_size) {
+        auto flat = tensor.flat<tensorflow::tstring>();
+        for (int64_t i = 0; i < flat.size(); ++i) {
+            if (offset >= total_size) {
+                flat(i) = "";
+                continue;
+            }
+            const size_t str_len = data[offset++] % 10 + 1;
+            const size_t len = std::min(str_len, total_size - offset);
+            flat(i).assign(reinterpret_cast<const char*>(data + offset), len);
+            offset += len;
+        }
+    }
+
+#if FUZZ_STRUCTURED_MATRICES
+    using Complex = std::complex<double>;
+
+    // Reads matrix entries in [-2, 2) from one input byte each (two for
+    // complex); zero once the input is exhausted.
+    struct SeedReader {
+        const uint8_t* data;
+        size_t total_size;
+        size_t& offset;
+        bool is_complex;
+
+        double real() {
+            return offset < total_size ? (static_cast<int>(data[offset++]) - 128) / 64.0 : 0.0;
+        }
+        Complex next() {
+            const double re = real();
+            return Complex(re, is_complex ? real() : 0.0);
+        }
+    };
+
+    // q <- q * (I - 2 v v^H / |v|^2); a zero v leaves q unchanged.
+    void applyReflector(std::vector<Complex>& q, const std::vector<Complex>& v, int64_t n) {
+        double norm2 = 0.0;
+        for (const Complex& x : v) {
+            norm2 += std::norm(x);
+        }
+        if (norm2 == 0.0) {
+            return;
+        }
+        for (int64_t i = 0; i < n; ++i) {
+            Complex qv = 0.0;
+            for (int64_t k = 0; k < n; ++k) {
+                qv += q[i * n + k] * v[k];
+            }
+            for (int64_t j = 0; j < n; ++j) {
+                q[i * n + j] -= 2.0 / norm2 * qv * std::conj(v[j]);
+            }
+        }
+    }
+
+    // Row-major n x n matrix of the given kind built from the seed bytes.
+    std::vector<Complex> structuredMatrix(tf_fuzzer_utils::MatrixKind kind, int64_t n, uint8_t param,
+                                          SeedReader& seed) {
+        using tf_fuzzer_utils::MatrixKind;
+        std::vector<Complex> a(n * n, 0.0);
+        switch (kind) {
+            case MatrixKind::SPD: {
+                const int64_t r = 1 + param % n;
+                std::vector<Complex> b(n * r);
+                for (Complex& x : b) {
+                    x = seed.next();
+                }
+                const double eps = 1.0 / (1 + (param >> 4));
+                for (int64_t i = 0; i < n; ++i) {
+                    for (int64_t j = 0; j < n; ++j) {
+                        Complex sum = 0.0;
+                        for (int64_t k = 0; k < r; ++k) {
+                            sum += b[i * r + k] * std::conj(b[j * r + k]);
+                        }
+                        a[i * n + j] = sum;
+                    }
+                    a[i * n + i] += eps;
+                }
+                break;
+            }
+            case MatrixKind::Orthogonal:
+            case MatrixKind::NearSingular: {
+                std::vector<Complex> q(n * n, 0.0);
+                for (int64_t i = 0; i < n; ++i) {
+                    q[i * n + i] = 1.0;
+                }
+                const int64_t reflectors =
+                    kind == MatrixKind::Orthogonal ? 1 + param % std::min<int64_t>(n, 3) : 1;
+                std::vector<Complex> v(n);
+                for (int64_t h = 0; h < reflectors; ++h) {
+                    for (Complex& x : v) {
+                        x = seed.next();
+                    }
+                    applyReflector(q, v, n);
+                }
+                if (kind == MatrixKind::Orthogonal) {
+                    return q;
+                }
+                // Q is a Hermitian reflector, so Q diag(s) Q^H is Hermitian PSD.
+                std::vector<double> s(n);
+                for (double& x : s) {
+                    x = 1.0 + std::abs(seed.real());
+                }
+                s[param % n] = param % 16 == 15 ? 0.0 : std::pow(10.0, -(1 + param % 15));
+                for (int64_t i = 0; i < n; ++i) {
+                    for (int64_t j = 0; j < n; ++j) {
+                        Complex sum = 0.0;
+                        for (int64_t k = 0; k < n; ++k) {
+                            sum += q[i * n + k] * s[k] * std::conj(q[j * n + k]);
+                        }
+                        a[i * n + j] = sum;
+                    }
+                }
+                break;
+            }
+            default: {
+                const bool triangular = kind == MatrixKind::Triangular;
+                const int64_t lower = kind == MatrixKind::Banded ? param % n : (triangular && (param & 1) ? 0 : n);
+                const int64_t upper = kind == MatrixKind::Banded ? (param >> 4) % n : (triangular && !(param & 1) ? 0 : n);
+                for (int64_t i = 0; i < n; ++i) {
+                    double off_diagonal = 0.0;
+                    for (int64_t j = 0; j < n; ++j) {
+                        if (j < i - lower || j > i + upper) {
+                            continue;
+                        }
+                        a[i * n + j] = seed.next();
+                        if (j != i) {
+                            off_diagonal += std::abs(a[i * n + j]);
+                        }
+                    }
+                    // Strict diagonal dominance keeps the matrix invertible.
+                    const double sign = a[i * n + i].real() < 0 ? -1.0 : 1.0;
+                    a[i * n + i] = sign * (off_diagonal + 1.0 + std::abs(a[i * n + i]));
+                }
+                break;
+            }
+        }
+        return a;
+    }
+
+    template <typename T>
+    void fillMatrices(tensorflow::Tensor& tensor, tf_fuzzer_utils::MatrixKind kind, int64_t n, uint8_t param,
+                      const uint8_t* data, size_t& offset, size_t total_size) {
+        constexpr bool kComplex =
+            std::is_same<T, tensorflow::complex64>::value || std::is_same<T, tensorflow::complex128>::value;
+        SeedReader seed{data, total_size, offset, kComplex};
+        auto flat = tensor.flat<T>();
+        for (int64_t base = 0; base < flat.size(); base += n * n) {
+            const std::vector<Complex> a = structuredMatrix(kind, n, param, seed);
+            for (int64_t i = 0; i < n * n; ++i) {
+                if constexpr (kComplex) {
+                    flat(base + i) = T(a[i].real(), a[i].imag());
+                } else {
+                    flat(base + i) = static_cast<T>(a[i].real());
+                }
+            }
+        }
+    }
+#endif
+
+    // libFuzzer runs the input files named on its command line once each
+    // (e.g. `./fuzz crash.bin`), so a warm-up run would only run a harness
+    // twice before it reproduces a crash.
+    bool hasInputFiles(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            std::error_code ec;
+            if (argv[i][0] != '-' && std::filesystem::is_regular_file(argv[i], ec)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Runs the harness once on a built-in zeroed input. libFuzzer installs its
+    // crash handlers after LLVMFuzzerInitialize, so corpus seeds are left to
+    // libFuzzer, where a crash still leaves an artifact.
+    void runWarmupInput() {
+        const std::vector<uint8_t> input(256, 0);
+        try {
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "tf_fuzzer_utils: warm-up input threw: %s\n", e.what());
+        }
+    }
+
+    // --- Batched replay ---
+
+    // A runOp call held back for the replay batch.
+    struct DeferredOp {
+        tf_fuzzer_utils::OpSpec spec;
+        std::vector<tensorflow::Tensor> inputs;
+        size_t seed;
+    };
+
+    // One deferred op in the batch graph: its feeds and target node.
+    struct ReplayNode {
+        std::vector<std::pair<std::string, tensorflow::Tensor>> feeds;
+        std::string target;
+        size_t seed;
+    };
+
+    // Set up by replayCorpus. While `active`, runOp holds stateless ops
+    // back and runs up to `batch_size` of them, from any number of seeds,
+    // as independent subgraphs of one graph.
+    struct ReplayState {
+        bool active = false;
+        size_t batch_size = 0;
+        size_t seed = 0;
+        std::vector<DeferredOp> pending;
+        std::vector<std::string> seed_status; // first failure of a deferred op per seed
+        uint64_t deferred = 0;
+        uint64_t batches = 0;
+        uint64_t runs = 0;
+        uint64_t failed = 0;
+    };
+
+    ReplayState& replayState() {
+        static ReplayState* state = new ReplayState();
+        return *state;
+    }
+
+    // Ops that create or touch state, or whose outputs later calls could
+    // need (resources, variants), keep running in order.
+    bool deferrable(const tensorflow::OpDef& op_def, const std::vector<tensorflow::Tensor>& inputs) {
+        if (op_def.is_stateful() || needsSession(op_def) || hasRefArgs(op_def) || op_def.has_deprecation()) {
+            return false;
+        }
+        for (const auto& arg : op_def.output_arg()) {
+            if (arg.type() == tensorflow::DT_RESOURCE || arg.type() == tensorflow::DT_VARIANT) {
+                return false;
+            }
+        }
+        for (const auto& input : inputs) {
+            if (input.dtype() == tensorflow::DT_RESOURCE || input.dtype() == tensorflow::DT_VARIANT) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool deferToReplay(const tf_fuzzer_utils::OpSpec& spec, const std::vector<tensorflow::Tensor>& inputs) {
+        ReplayState& replay = replayState();
+        if (!replay.active) {
+            return false;
+        }
+        const tensorflow::OpDef* op_def = nullptr;
+        if (!tensorflow::OpRegistry::Global()->LookUpOpDef(spec.op, &op_def).ok() || !deferrable(*op_def, inputs)) {
+            return false;
+        }
+        replay.pending.push_back({spec, inputs, replay.seed});
+        ++replay.deferred;
+        return true;
+    }
+
+    void recordReplayStatus(size_t seed, const tensorflow::Status& status) {
+        ReplayState& replay = replayState();
+        if (status.ok()) {
+            return;
+        }
+        ++replay.failed;
+        if (replay.seed_status[seed] == "-") {
+            std::string message = status.ToString().substr(0, 200);
+            std::replace_if(message.begin(), message.end(), [](char c) { return c == '\n' || c == '\t'; }, ' ');
+            replay.seed_status[seed] = message;
+        }
+    }
+
+    // Runs nodes [begin, end) in one step. The executor stops a step at its
+    // first error, so a failing range is split in half until each failure
+    // is pinned to its own node and the others have run.
+    void runReplayRange(tensorflow::Session* session, const std::vector<ReplayNode>& nodes, size_t begin, size_t end,
+                        std::vector<tensorflow::Status>* statuses) {
+        std::vector<std::pair<std::string, tensorflow::Tensor>> feeds;
+        std::vector<std::string> targets;
+        for (size_t i = begin; i < end; ++i) {
+            feeds.insert(feeds.end(), nodes[i].feeds.begin(), nodes[i].feeds.end());
+            targets.push_back(nodes[i].target);
+        }
+        tensorflow::RunOptions options;
+        options.set_timeout_in_ms(inputTimeoutMs() * static_cast<int64_t>(end - begin));
+        std::vector<tensorflow::Tensor> outputs;
+        ++replayState().runs;
+        const tensorflow::Status status = session->Run(options, feeds, {}, targets, &outputs, nullptr);
+        if (status.ok() || end - begin == 1) {
+            std::fill(statuses->begin() + begin, statuses->begin() + end, status);
+            return;
+        }
+        const size_t mid = begin + (end - begin) / 2;
+        runReplayRange(session, nodes, begin, mid, statuses);
+        runReplayRange(session, nodes, mid, end, statuses);
+    }
+
+    void flushReplayBatch() {
+        ReplayState& replay = replayState();
+        if (replay.pending.empty()) {
+            return;
+        }
+        tensorflow::Graph graph(tensorflow::OpRegistry::Global());
+        std::vector<ReplayNode> nodes;
+        for (size_t i = 0; i < replay.pending.size(); ++i) {
+            const DeferredOp& op = replay.pending[i];
+            std::vector<std::string> feed_names;
+            tensorflow::Node* target = nullptr;
+            const tensorflow::Status status =
+                addOpNode(&graph, tensorflow::strings::StrCat("op", i, "/"), op.spec, op.inputs, &feed_names, &target);
+            if (!status.ok()) {
+                recordReplayStatus(op.seed, status);
+                continue;
+            }
+            ReplayNode node;
+            for (size_t j = 0; j < feed_names.size(); ++j) {
+                node.feeds.emplace_back(feed_names[j], op.inputs[j]);
+            }
+            node.target = target->name();
+            node.seed = op.seed;
+            nodes.push_back(std::move(node));
+        }
+
+        std::vector<tensorflow::Status> statuses(nodes.size());
+        tensorflow::GraphDef graph_def;
+        graph.ToGraphDef(&graph_def);
+        std::unique_ptr<tensorflow::Session> session(tensorflow::NewSession(tf_fuzzer_utils::makeSessionOptions()));
+        tensorflow::Status created =
+            session ? session->Create(graph_def) : tensorflow::errors::Internal("Failed to create session");
+        if (created.ok() && !nodes.empty()) {
+            runReplayRange(session.get(), nodes, 0, nodes.size(), &statuses);
+        } else {
+            std::fill(statuses.begin(), statuses.end(), created);
+        }
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            recordReplayStatus(nodes[i].seed, statuses[i]);
+        }
+        if (session) {
+            session->Close().IgnoreError();
+        }
+        replay.pending.clear();
+        ++replay.batches;
+    }
+
+    // Runs the harness on every seed listed in `list_path` (one path per
+    // line) in this process and writes "<seed>\t<harness result>\t<first
+    // deferred-op failure or ->" lines to <list_path>.out.
+    int replayCorpus(const std::string& list_path) {
+        ReplayState& replay = replayState();
+        const char* batch = std::getenv("TF_FUZZ_REPLAY_BATCH");
+        replay.batch_size = static_cast<size_t>(std::max<int64_t>(batch ? std::atoll(batch) : 64, 0));
+        replay.active = replay.batch_size > 1;
+
+        std::ifstream list(list_path);
+        std::vector<std::string> seeds;
+        for (std::string line; std::getline(list, line);) {
+            if (!line.empty()) {
+                seeds.push_back(line);
+            }
+        }
+        replay.seed_status.assign(seeds.size(), "-");
+        std::vector<int> results(seeds.size(), 0);
+        for (size_t i = 0; i < seeds.size(); ++i) {
+            std::ifstream ifs(seeds[i], std::ios::binary);
+            const std::vector<uint8_t> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+            replay.seed = i;
+            results[i] = LLVMFuzzerTestOneInput(data.data(), data.size());
+            if (replay.pending.size() >= replay.batch_size) {
+                flushReplayBatch();
+            }
+        }
+        flushReplayBatch();
+        replay.active = false;
+
+        std::ofstream report(list_path + ".out");
+        for (size_t i = 0; i < seeds.size(); ++i) {
+            report << seeds[i] << '\t' << results[i] << '\t' << replay.seed_status[i] << '\n';
+        }
+        std::fprintf(stderr,
+                     "stat::tf_fuzz_replay_seeds: %zu\nstat::tf_fuzz_replay_deferred_ops: %llu\n"
+                     "stat::tf_fuzz_replay_batches: %llu\nstat::tf_fuzz_replay_session_runs: %llu\n"
+                     "stat::tf_fuzz_replay_failed_ops: %llu\n",
+                     seeds.size(), static_cast<unsigned long long>(replay.deferred),
+                     static_cast<unsigned long long>(replay.batches), static_cast<unsigned long long>(replay.runs),
+                     static_cast<unsigned long long>(replay.failed));
+        return 0;
+    }
+
+} // namespace
+
+extern "C" int __wrap_LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    tf_fuzzer_utils::beginInput(data, size);
+    const int result = __real_LLVMFuzzerTestOneInput(data, size);
+    tf_fuzzer_utils::endInput();
+    return result;
+}
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv) {
+    setenv("TF_CPP_MIN_LOG_LEVEL", "3", 0);
+#if TF_FUZZ_BACKEND == TF_FUZZ_BACKEND_KERNEL
+    cpuDevice();
+#elif TF_FUZZ_BACKEND == TF_FUZZ_BACKEND_EAGER
+    cpuDevice();
+    eagerContext();
+#endif
+
+    // Replay mode replaces fuzzing: the listed seeds run once and the
+    // process exits, writing its coverage profile as usual.
+    const char* replay = std::getenv("TF_FUZZ_REPLAY");
+    if (replay && replay[0]) {
+        std::exit(replayCorpus(replay));
+    }
+
+#if FUZZ_WARMUP
+    const char* env = std::getenv("FUZZ_WARMUP");
+    if (!(env && env[0] == '0') && !hasInputFiles(*argc, *argv)) {
+        runWarmupInput();
+    }
+#endif
+    return 0;
+}
+
+namespace tf_fuzzer_utils {
+
+    void traceMessage(const std::string& msg) {
+#if FUZZ_TRACE_RING
+        const size_t slot = trace_next.load() % FUZZ_TRACE_RING_SIZE;
+        const size_t len = std::min(msg.size(), kTraceLineMax);
+        std::memcpy(trace_lines[slot], msg.data(), len);
+        trace_lengths[slot] = len;
+        trace_next.fetch_add(1);
+#else
+        std::cout << msg << '\n';
+#endif
+    }
+
+    void traceInput() {
+#if FUZZ_TRACE_RING
+        installTraceHandlers();
+        input_start_ns.store(monotonicNs());
+#endif
+        FUZZ_TRACE(1, "Start Fuzzing");
+    }
+
+    // Harnesses that define their own logError override this one.
+    __attribute__((weak)) void logError(const std::string& message, const uint8_t* /*data*/, size_t /*size*/) {
+        std::cerr << "Error: " << message << std::endl;
+    }
+
+    void beginInput(const uint8_t* data, size_t size) {
+        startInput(data, size);
+        sampleInput();
+    }
+
+    void endInput() {
+        finishInput();
+        releaseInputResources();
+    }
+
+    uint8_t parseRank(uint8_t byte, uint8_t min_rank, uint8_t max_rank) {
+        const uint8_t range = max_rank - min_rank + 1;
+        return byte % range + min_rank;
+    }
+
+    std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size,
+                                    uint8_t rank, int64_t min_dim, int64_t max_dim) {
+        std::vector<int64_t> shape;
+        shape.reserve(rank);
+        const uint64_t range = static_cast<uint64_t>(max_dim - min_dim + 1);
+        for (uint8_t i = 0; i < rank; ++i) {
+            if (offset + sizeof(int64_t) > total_size) {
+                shape.push_back(1);
+                continue;
+            }
+            int64_t dim_val;
+            std::memcpy(&dim_val, data + offset, sizeof(int64_t));
+            offset += sizeof(int64_t);
+            // |dim_val| computed in unsigned arithmetic so INT64_MIN is defined.
+            const uint64_t magnitude = dim_val < 0 ? 0 - static_cast<uint64_t>(dim_val) : static_cast<uint64_t>(dim_val);
+            shape.push_back(min_dim + static_cast<int64_t>(magnitude % range));
+        }
+        return shape;
+    }
+
+    void fillTensorWithDataByType(tensorflow::Tensor& tensor, tensorflow::DataType dtype,
+                                  const uint8_t* data, size_t& offset, size_t total_size) {
+        switch (dtype) {
+            case tensorflow::DT_FLOAT:
+                fillPod<float>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_DOUBLE:
+                fillPod<double>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_INT64:
+                fillPod<int64_t>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_INT32:
+                fillPod<int32_t>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_INT16:
+                fillPod<int16_t>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_INT8:
+                fillPod<int8_t>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_UINT64:
+                fillPod<uint64_t>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_UINT32:
+                fillPod<uint32_t>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_UINT16:
+                fillPod<uint16_t>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_UINT8:
+                fillPod<uint8_t>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_BFLOAT16:
+                fillPod<tensorflow::bfloat16>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_HALF:
+                fillPod<Eigen::half>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_COMPLEX64:
+                fillPod<tensorflow::complex64>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_COMPLEX128:
+                fillPod<tensorflow::complex128>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_QINT8:
+                fillPod<tensorflow::qint8>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_QUINT8:
+                fillPod<tensorflow::quint8>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_QINT16:
+                fillPod<tensorflow::qint16>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_QUINT16:
+                fillPod<tensorflow::quint16>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_QINT32:
+                fillPod<tensorflow::qint32>(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_BOOL:
+                fillBool(tensor, data, offset, total_size);
+                break;
+            case tensorflow::DT_STRING:
+                fillString(tensor, data, offset, total_size);
+                break;
+            default:
+                break;
+        }
+    }
+
+    tensorflow::SessionOptions makeSessionOptions() {
+        tensorflow::SessionOptions options;
+        tensorflow::ConfigProto& config = options.config;
+        config.set_intra_op_parallelism_threads(intraOpThreads());
+        config.set_inter_op_parallelism_threads(1);
+        config.set_use_per_session_threads(false);
+        tensorflow::ThreadPoolOptionProto* pool = config.add_session_inter_op_thread_pool();
+        pool->set_num_threads(1);
+        pool->set_global_name(kInterOpPoolName);
+#if TF_FUZZ_DISABLE_GRAPH_OPTIMIZATION
+        tensorflow::GraphOptions* graph_options = config.mutable_graph_options();
+        tensorflow::OptimizerOptions* optimizer = graph_options->mutable_optimizer_options();
+        optimizer->set_opt_level(tensorflow::OptimizerOptions::L0);
+        optimizer->set_do_constant_folding(false);
+        optimizer->set_do_common_subexpression_elimination(false);
+        optimizer->set_do_function_inlining(false);
+        optimizer->set_global_jit_level(tensorflow::OptimizerOptions::OFF);
+        tensorflow::RewriterConfig* rewriter = graph_options->mutable_rewrite_options();
+        rewriter->set_disable_meta_optimizer(true);
+        rewriter->set_constant_folding(tensorflow::RewriterConfig::OFF);
+#endif
+        return options;
+    }
+
+    tensorflow::Status runOpInSession(const OpSpec& spec,
+                                      const std::vector<tensorflow::Tensor>& inputs,
+                                      std::vector<tensorflow::Tensor>* outputs) {
+        GraphCache& cache = graphCache();
+        const std::string key = graphSignature(spec, inputs);
+
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            std::unique_ptr<CachedGraph> entry;
+            TF_RETURN_IF_ERROR(createCachedGraph(spec, inputs, &entry));
+            if (cache.size() >= TF_FUZZ_MAX_CACHED_GRAPHS) {
+                cache.clear();
+            }
+            it = cache.emplace(key, std::move(entry)).first;
+        }
+
+        outputs->clear();
+        it->second->used = true;
+        tensorflow::Status status = it->second->callable.run(it->second->session.get(), inputs, outputs);
+#if !TF_FUZZ_PERSISTENT_GRAPH
+        cache.erase(it);
+#endif
+        return status;
+    }
+
+    tensorflow::Status runOpKernel(const OpSpec& spec,
+                                   const std::vector<tensorflow::Tensor>& inputs,
+                                   std::vector<tensorflow::Tensor>* outputs) {
+        const tensorflow::OpDef* op_def = nullptr;
+        TF_RETURN_IF_ERROR(tensorflow::OpRegistry::Global()->LookUpOpDef(spec.op, &op_def));
+        if (needsSession(*op_def)) {
+            return runOpInSession(spec, inputs, outputs);
+        }
+
+        KernelCache& cache = kernelCache();
+        const std::string key = graphSignature(spec, inputs);
+
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            std::unique_ptr<CachedKernel> entry;
+            TF_RETURN_IF_ERROR(createCachedKernel(spec, *op_def, inputs, &entry));
+            if (cache.size() >= TF_FUZZ_MAX_CACHED_GRAPHS) {
+                cache.clear();
+            }
+            it = cache.emplace(key, std::move(entry)).first;
+        }
+
+        outputs->clear();
+        tensorflow::Status status = computeKernel(it->second.get(), inputs, outputs);
+#if !TF_FUZZ_PERSISTENT_GRAPH
+        cache.erase(it);
+#endif
+        return status;
+    }
+
+    tensorflow::Status runOpEager(const OpSpec& spec,
+                                  const std::vector<tensorflow::Tensor>& inputs,
+                                  std::vector<tensorflow::Tensor>* outputs) {
+        const tensorflow::OpDef* op_def = nullptr;
+        TF_RETURN_IF_ERROR(tensorflow::OpRegistry::Global()->LookUpOpDef(spec.op, &op_def));
+        TFE_Context* context = eagerContext();
+        bool copyable = context != nullptr;
+        for (const auto& input : inputs) {
+            copyable = copyable && isEagerCopyable(input.dtype());
+        }
+        // Eager ops are checked against the current GraphDef version.
+        copyable = copyable && !op_def->has_deprecation();
+        if (!copyable) {
+            return runOpKernel(spec, inputs, outputs);
+        }
+
+        TFE_Op*& op = eagerOps()[spec.op];
+        if (op == nullptr) {
+            ScopedTFStatus status;
+            op = TFE_NewOp(context, spec.op.c_str(), status.status);
+            if (!status.ok()) {
+                return status.toStatus();
+            }
+        }
+
+        ScopedTFStatus status;
+        std::vector<TFE_TensorHandle*> handles;
+        handles.reserve(inputs.size());
+        for (const auto& input : inputs) {
+            TFE_TensorHandle* handle = toEagerHandle(input, status.status);
+            if (!status.ok()) {
+                break;
+            }
+            handles.push_back(handle);
+        }
+
+        outputs->clear();
+        tensorflow::Status result =
+            status.ok() ? executeEager(op, spec, *op_def, handles, outputs) : status.toStatus();
+        for (TFE_TensorHandle* handle : handles) {
+            TFE_DeleteTensorHandle(handle);
+        }
+        return result;
+    }
+
+    void parseQuantizedRange(tensorflow::DataType dtype, const uint8_t* data, size_t& offset, size_t total_size,
+                             float* min_range, float* max_range) {
+        auto next = [&]() -> uint8_t { return offset < total_size ? data[offset++] : 0; };
+        const uint8_t e = next();
+        const uint8_t m = next();
+        const double scale = std::ldexp(1.0 + m / 256.0, static_cast<int>(e % 16) - 12);
+        double qmin = -128.0;
+        double qmax = 127.0;
+        const uint8_t zero_point_byte = next();
+        double zero_point = static_cast<int8_t>(zero_point_byte);
+        switch (dtype) {
+            case tensorflow::DT_QUINT8:
+            case tensorflow::DT_QUINT16:
+                qmin = 0.0;
+                qmax = dtype == tensorflow::DT_QUINT8 ? 255.0 : 65535.0;
+                zero_point = zero_point_byte;
+                break;
+            case tensorflow::DT_QINT16:
+                qmin = -32768.0;
+                qmax = 32767.0;
+                break;
+            case tensorflow::DT_QINT32:
+                qmin = -2147483648.0;
+                qmax = 2147483647.0;
+                break;
+            default:
+                break;
+        }
+        *min_range = static_cast<float>((qmin - zero_point) * scale);
+        *max_range = static_cast<float>((qmax - zero_point) * scale);
+    }
+
+    QuantizedTensor makeQuantizedTensor(tensorflow::DataType dtype, const tensorflow::TensorShape& shape, int axis,
+                                        const uint8_t* data, size_t& offset, size_t total_size) {
+        QuantizedTensor result;
+        result.value = tensorflow::Tensor(dtype, shape);
+        fillTensorWithDataByType(result.value, dtype, data, offset, total_size);
+        const bool per_channel = axis >= 0 && axis < shape.dims();
+        const int64_t channels = per_channel ? shape.dim_size(axis) : 1;
+        const tensorflow::TensorShape range_shape =
+            per_channel ? tensorflow::TensorShape({channels}) : tensorflow::TensorShape({});
+        result.min_range = tensorflow::Tensor(tensorflow::DT_FLOAT, range_shape);
+        result.max_range = tensorflow::Tensor(tensorflow::DT_FLOAT, range_shape);
+        float* min_values = result.min_range.flat<float>().data();
+        float* max_values = result.max_range.flat<float>().data();
+        for (int64_t c = 0; c < channels; ++c) {
+            parseQuantizedRange(dtype, data, offset, total_size, &min_values[c], &max_values[c]);
+        }
+        return result;
+    }
+
+    MatrixKind parseMatrixKind(uint8_t byte) {
+        return static_cast<MatrixKind>(byte % 6);
+    }
+
+    void fillMatrixByType(tensorflow::Tensor& tensor, tensorflow::DataType dtype, MatrixKind kind,
+                          const uint8_t* data, size_t& offset, size_t total_size) {
+#if FUZZ_STRUCTURED_MATRICES
+        const int rank = tensor.dims();
+        const int64_t n = rank >= 2 ? tensor.dim_size(rank - 1) : 0;
+        const bool floating = dtype == tensorflow::DT_FLOAT || dtype == tensorflow::DT_DOUBLE ||
+                              dtype == tensorflow::DT_HALF || dtype == tensorflow::DT_BFLOAT16 ||
+                              dtype == tensorflow::DT_COMPLEX64 || dtype == tensorflow::DT_COMPLEX128;
+        if (floating && n > 0 && tensor.dim_size(rank - 2) == n) {
+            const uint8_t param = offset < total_size ? data[offset++] : 0;
+            FUZZ_TRACE(2, "fillMatrixByType kind=" << static_cast<int>(kind) << " n=" << n);
+            switch (dtype) {
+                case tensorflow::DT_FLOAT:
+                    return fillMatrices<float>(tensor, kind, n, param, data, offset, total_size);
+                case tensorflow::DT_DOUBLE:
+                    return fillMatrices<double>(tensor, kind, n, param, data, offset, total_size);
+                case tensorflow::DT_HALF:
+                    return fillMatrices<Eigen::half>(tensor, kind, n, param, data, offset, total_size);
+                case tensorflow::DT_BFLOAT16:
+                    return fillMatrices<tensorflow::bfloat16>(tensor, kind, n, param, data, offset, total_size);
+                case tensorflow::DT_COMPLEX64:
+                    return fillMatrices<tensorflow::complex64>(tensor, kind, n, param, data, offset, total_size);
+                case tensorflow::DT_COMPLEX128:
+                    return fillMatrices<tensorflow::complex128>(tensor, kind, n, param, data, offset, total_size);
+                default:
+                    break;
+            }
+        }
+#else
+        (void)kind;
+#endif
+        fillTensorWithDataByType(tensor, dtype, data, offset, total_size);
+    }
+
+    AllocatorStats allocatorStats() {
+        RecyclingAllocator* allocator = RecyclingAllocator::instance().load();
+        return allocator != nullptr ? allocator->fuzzStats() : AllocatorStats();
+    }
+
+    tensorflow::Status runOp(const OpSpec& spec,
+                             const std::vector<tensorflow::Tensor>& inputs,
+                             std::vector<tensorflow::Tensor>* outputs) {
+        FUZZ_TRACE(2, "runOp " << spec.op << " with " << inputs.size() << " inputs");
+        if (deferToReplay(spec, inputs)) {
+            // Its outputs do not exist yet, so the harness must stop here.
+            return tensorflow::errors::Unavailable(spec.op, " deferred to the replay batch");
+        }
+        TF_RETURN_IF_ERROR(checkDeadline(spec.op));
+        trimAllocatorCache();
+        const int64_t start_ns = monotonicNs();
+#if TF_FUZZ_BACKEND == TF_FUZZ_BACKEND_KERNEL
+        tensorflow::Status status = runOpKernel(spec, inputs, outputs);
+#else
+        const tensorflow::OpDef* op_def = nullptr;
+        TF_RETURN_IF_ERROR(tensorflow::OpRegistry::Global()->LookUpOpDef(spec.op, &op_def));
+#if TF_FUZZ_BACKEND == TF_FUZZ_BACKEND_EAGER
+        tensorflow::Status status =
+            passesHandles(*op_def) ? runOpKernel(spec, inputs, outputs) : runOpEager(spec, inputs, outputs);
+#else
+        tensorflow::Status status =
+            passesHandles(*op_def) ? runOpKernel(spec, inputs, outputs) : runOpInSession(spec, inputs, outputs);
+#endif
+#endif
+        recordRun(spec.op, monotonicNs() - start_ns, status);
+        return status;
+    }
+
+    tensorflow::Status runDataset(const DatasetSpec& spec,
+                                  const std::vector<tensorflow::Tensor>& components,
+                                  const std::vector<tensorflow::Tensor>& inputs,
+                                  std::vector<tensorflow::Tensor>* elements) {
+        TF_RETURN_IF_ERROR(checkDeadline(spec.op.op));
+        PipelineCache& cache = pipelineCache();
+        const std::string key = pipelineSignature(spec, components, inputs);
+
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            std::unique_ptr<CachedPipeline> entry;
+            TF_RETURN_IF_ERROR(createCachedPipeline(spec, components, inputs, &entry));
+            if (cache.size() >= TF_FUZZ_MAX_CACHED_GRAPHS) {
+                cache.clear();
+            }
+            it = cache.emplace(key, std::move(entry)).first;
+        }
+        CachedPipeline* pipeline = it->second.get();
+
+        std::vector<tensorflow::Tensor> feeds = components;
+        feeds.insert(feeds.end(), inputs.begin(), inputs.end());
+        // The handle owns the iterator; it is freed when `handle` goes out of scope.
+        std::vector<tensorflow::Tensor> handle;
+        pipeline->used = true;
+        const int64_t start_ns = monotonicNs();
+        tensorflow::Status status = pipeline->init.run(pipeline->session.get(), feeds, &handle);
+        for (int i = 0; status.ok() && i < TF_FUZZ_DATASET_MAX_ELEMENTS; ++i) {
+            status = checkDeadline(spec.op.op);
+            if (!status.ok()) {
+                break;
+            }
+            std::vector<tensorflow::Tensor> element;
+            status = pipeline->next.run(pipeline->session.get(), handle, &element);
+            if (tensorflow::errors::IsOutOfRange(status)) {
+                status = absl::OkStatus();
+                break;
+            }
+            elements->insert(elements->end(), element.begin(), element.end());
+        }
+        recordRun(spec.op.op, monotonicNs() - start_ns, status);
+#if !TF_FUZZ_PERSISTENT_GRAPH
+        cache.erase(it);
+#endif
+        return status;
+    }
+
+} // namespace tf_fuzzer_utils
@@ -0,0 +1,330 @@
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tf_fuzzer_utils.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+// Generic raw-op fuzzer: one binary for every op in the TF op registry. The op
+// is picked at startup with FUZZ_OP (e.g. FUZZ_OP=Add or FUZZ_OP=tf.raw_ops.Add).
+// Its OpDef drives how the input bytes become input tensors and attrs, and the
+// op runs through tf_fuzzer_utils::runOp, so every backend and cache of the
+// runtime applies. FUZZ_LIST_OPS=1 prints every op that can be synthesized.
+
+#define MAX_RANK 4
+#define MIN_RANK 0
+#define MIN_TENSOR_SHAPE_DIMS_TF 1
+#define MAX_TENSOR_SHAPE_DIMS_TF 10
+#define MAX_LIST_LENGTH 4
+
+namespace {
+
+    // Types picked for type attrs without allowed_values.
+    const tensorflow::DataType kDefaultTypes[] = {
+        tensorflow::DT_FLOAT, tensorflow::DT_DOUBLE, tensorflow::DT_INT32, tensorflow::DT_INT64,
+        tensorflow::DT_HALF, tensorflow::DT_BFLOAT16, tensorflow::DT_INT8, tensorflow::DT_UINT8,
+        tensorflow::DT_BOOL, tensorflow::DT_COMPLEX64,
+    };
+
+    const float kFloats[] = {0.0f, 1.0f, -1.0f, 0.5f, 2.0f, 1e-6f, 1e10f,
+                             std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN()};
+
+    // Values for string attrs without allowed_values (data formats, padding, ...).
+    const char* const kStrings[] = {"", "NHWC", "NCHW", "SAME", "VALID", "EXPLICIT", "NDHWC", "NCDHW"};
+
+    bool synthesizableType(tensorflow::DataType dtype) {
+        return dtype != tensorflow::DT_RESOURCE && dtype != tensorflow::DT_VARIANT &&
+               !tensorflow::IsRefType(dtype) && dtype != tensorflow::DT_INVALID;
+    }
+
+    // Ref and resource inputs, variants and function attrs need state the
+    // input bytes cannot describe.
+    bool synthesizable(const tensorflow::OpDef& op_def) {
+        for (const auto& arg : op_def.input_arg()) {
+            if (arg.is_ref() || (arg.type() != tensorflow::DT_INVALID && !synthesizableType(arg.type()))) {
+                return false;
+            }
+        }
+        for (const auto& attr : op_def.attr()) {
+            if (attr.type() == "func" || attr.type() == "list(func)") {
+                return false;
+            }
+        }
+        return op_def.name().empty() || op_def.name()[0] != '_';
+    }
+
+    struct OpSynthesizer {
+        const tensorflow::OpDef& op_def;
+        const uint8_t* data;
+        size_t size;
+        size_t& offset;
+        std::map<std::string, tensorflow::AttrValue> attrs;
+        tensorflow::TensorShape first_shape;
+        bool have_first_shape = false;
+
+        uint8_t byte() {
+            return offset < size ? data[offset++] : 0;
+        }
+
+        const tensorflow::OpDef::AttrDef* attrDef(const std::string& name) const {
+            for (const auto& attr : op_def.attr()) {
+                if (attr.name() == name) {
+                    return &attr;
+                }
+            }
+            return nullptr;
+        }
+
+        tensorflow::DataType pickType(const tensorflow::OpDef::AttrDef* def) {
+            std::vector<tensorflow::DataType> allowed;
+            if (def && def->has_allowed_values()) {
+                for (int t : def->allowed_values().list().type()) {
+                    const auto dtype = static_cast<tensorflow::DataType>(t);
+                    if (synthesizableType(dtype)) {
+                        allowed.push_back(dtype);
+                    }
+                }
+            }
+            if (allowed.empty()) {
+                allowed.assign(std::begin(kDefaultTypes), std::end(kDefaultTypes));
+            }
+            return allowed[byte() % allowed.size()];
+        }
+
+        int64_t pickInt(const tensorflow::OpDef::AttrDef* def) {
+            const int64_t minimum = def && def->has_minimum() ? def->minimum() : -1;
+            return minimum + byte() % 8;
+        }
+
+        tensorflow::DataType typeAttr(const std::string& name) {
+            auto it = attrs.find(name);
+            if (it == attrs.end()) {
+                tensorflow::AttrValue value;
+                value.set_type(pickType(attrDef(name)));
+                it = attrs.emplace(name, value).first;
+            }
+            return it->second.type();
+        }
+
+        int64_t numberAttr(const std::string& name) {
+            auto it = attrs.find(name);
+            if (it == attrs.end()) {
+                const auto* def = attrDef(name);
+                const int64_t minimum = def && def->has_minimum() ? def->minimum() : 0;
+                tensorflow::AttrValue value;
+                value.set_i(std::max<int64_t>(minimum, byte() % (MAX_LIST_LENGTH + 1)));
+                it = attrs.emplace(name, value).first;
+            }
+            return it->second.i();
+        }
+
+        std::vector<tensorflow::DataType> typeListAttr(const std::string& name) {
+            auto it = attrs.find(name);
+            if (it == attrs.end()) {
+                const auto* def = attrDef(name);
+                const int64_t minimum = def && def->has_minimum() ? def->minimum() : 0;
+                const int64_t length = std::max<int64_t>(minimum, 1 + byte() % MAX_LIST_LENGTH);
+                tensorflow::AttrValue value;
+                for (int64_t i = 0; i < length; ++i) {
+                    value.mutable_list()->add_type(pickType(def));
+                }
+                it = attrs.emplace(name, value).first;
+            }
+            std::vector<tensorflow::DataType> types;
+            for (int t : it->second.list().type()) {
+                types.push_back(static_cast<tensorflow::DataType>(t));
+            }
+            return types;
+        }
+
+        // Inputs share the first input's shape or are scalars half of the
+        // time, so elementwise and broadcasting ops see compatible operands.
+        tensorflow::Tensor tensor(tensorflow::DataType dtype) {
+            tensorflow::TensorShape shape;
+            const uint8_t selector = byte();
+            if (have_first_shape && selector % 4 == 0) {
+                shape = first_shape;
+            } else if (selector % 4 != 1) {
+                const uint8_t rank = tf_fuzzer_utils::parseRank(byte(), MIN_RANK, MAX_RANK);
+                for (int64_t dim : tf_fuzzer_utils::parseShape(data, offset, size, rank,
+                                                               MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF)) {
+                    shape.AddDim(dim);
+                }
+            }
+            if (!have_first_shape) {
+                first_shape = shape;
+                have_first_shape = true;
+            }
+            tensorflow::Tensor value(dtype, shape);
+            tf_fuzzer_utils::fillTensorWithDataByType(value, dtype, data, offset, size);
+            return value;
+        }
+
+        void inputs(std::vector<tensorflow::Tensor>* tensors) {
+            for (const auto& arg : op_def.input_arg()) {
+                if (!arg.type_list_attr().empty()) {
+                    for (tensorflow::DataType dtype : typeListAttr(arg.type_list_attr())) {
+                        tensors->push_back(tensor(dtype));
+                    }
+                    continue;
+                }
+                const tensorflow::DataType dtype =
+                    arg.type() != tensorflow::DT_INVALID ? arg.type() : typeAttr(arg.type_attr());
+                const int64_t count = arg.number_attr().empty() ? 1 : numberAttr(arg.number_attr());
+                for (int64_t i = 0; i < count; ++i) {
+                    tensors->push_back(tensor(dtype));
+                }
+            }
+        }
+
+        // Attrs not fixed by the inputs: the default half of the time when
+        // there is one, otherwise a value of the attr's type.
+        void remainingAttrs() {
+            for (const auto& def : op_def.attr()) {
+                if (attrs.count(def.name())) {
+                    continue;
+                }
+                const std::string& type = def.type();
+                if (def.has_default_value() && (byte() & 1)) {
+                    continue;
+                }
+                tensorflow::AttrValue value;
+                if (type == "type") {
+                    value.set_type(pickType(&def));
+                } else if (type == "int") {
+                    value.set_i(pickInt(&def));
+                } else if (type == "float") {
+                    value.set_f(kFloats[byte() % std::size(kFloats)]);
+                } else if (type == "bool") {
+                    value.set_b(byte() & 1);
+                } else if (type == "string") {
+                    if (def.has_allowed_values() && def.allowed_values().list().s_size() > 0) {
+                        const auto& allowed = def.allowed_values().list().s();
+                        value.set_s(allowed[byte() % allowed.size()]);
+                    } else {
+                        value.set_s(kStrings[byte() % std::size(kStrings)]);
+                    }
+                } else if (type == "shape") {
+                    const uint8_t rank = tf_fuzzer_utils::parseRank(byte(), MIN_RANK, MAX_RANK);
+                    auto* shape = value.mutable_shape();
+                    for (uint8_t i = 0; i < rank; ++i) {
+                        shape->add_dim()->set_size(1 + byte() % 4);
+                    }
+                } else if (type == "list(int)") {
+                    const int64_t length = std::max<int64_t>(def.has_minimum() ? def.minimum() : 0,
+                                                             byte() % (MAX_LIST_LENGTH + 1));
+                    for (int64_t i = 0; i < length; ++i) {
+                        value.mutable_list()->add_i(static_cast<int64_t>(byte() % 6) - 1);
+                    }
+                } else if (type == "list(float)") {
+                    const int64_t length = byte() % (MAX_LIST_LENGTH + 1);
+                    for (int64_t i = 0; i < length; ++i) {
+                        value.mutable_list()->add_f(kFloats[byte() % std::size(kFloats)]);
+                    }
+                } else if (type == "list(type)") {
+                    const int64_t length = std::max<int64_t>(def.has_minimum() ? def.minimum() : 0,
+                                                             1 + byte() % MAX_LIST_LENGTH);
+                    for (int64_t i = 0; i < length; ++i) {
+                        value.mutable_list()->add_type(pickType(&def));
+                    }
+                } else if (def.has_default_value()) {
+                    // tensor, list(shape), list(string), ...: keep the default.
+                    continue;
+                } else if (type == "tensor") {
+                    tensorflow::Tensor scalar(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
+                    scalar.scalar<float>()() = kFloats[byte() % std::size(kFloats)];
+                    scalar.AsProtoTensorContent(value.mutable_tensor());
+                } else {
+                    value.mutable_list();
+                }
+                attrs.emplace(def.name(), value);
+            }
+        }
+    };
+
+    std::string opName(const std::string& id) {
+        const std::string prefix = "tf.raw_ops.";
+        return id.rfind(prefix, 0) == 0 ? id.substr(prefix.size()) : id;
+    }
+
+    void listOps() {
+        std::vector<tensorflow::OpDef> op_defs;
+        tensorflow::OpRegistry::Global()->GetRegisteredOps(&op_defs);
+        std::vector<std::string> names;
+        for (const auto& op_def : op_defs) {
+            if (synthesizable(op_def)) {
+                names.push_back(op_def.name());
+            }
+        }
+        std::sort(names.begin(), names.end());
+        for (const auto& name : names) {
+            std::cout << name << "\n";
+        }
+    }
+
+    const tensorflow::OpDef* selectedOpDef() {
+        const char* list = std::getenv("FUZZ_LIST_OPS");
+        if (list && list[0] == '1') {
+            listOps();
+            std::exit(0);
+        }
+        const char* id = std::getenv("FUZZ_OP");
+        if (!id || !*id) {
+            std::cerr << "Set FUZZ_OP to the op to fuzz, e.g. FUZZ_OP=Add (FUZZ_LIST_OPS=1 lists them)" << std::endl;
+            std::exit(1);
+        }
+        const tensorflow::OpDef* op_def = nullptr;
+        tensorflow::Status status = tensorflow::OpRegistry::Global()->LookUpOpDef(opName(id), &op_def);
+        if (!status.ok()) {
+            std::cerr << "Unknown op " << id << ": " << status.message() << std::endl;
+            std::exit(1);
+        }
+        if (!synthesizable(*op_def)) {
+            std::cerr << "Cannot synthesize the inputs and attrs of " << op_def->name() << std::endl;
+            std::exit(1);
+        }
+        return op_def;
+    }
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    // Resolved once, during the runtime's warm-up run.
+    static const tensorflow::OpDef* op_def = selectedOpDef();
+    FUZZ_TRACE_INPUT();
+
+    size_t offset = 0;
+
+    try {
+        OpSynthesizer synthesizer{*op_def, data, size, offset};
+        std::vector<tensorflow::Tensor> inputs;
+        synthesizer.inputs(&inputs);
+        synthesizer.remainingAttrs();
+
+        tf_fuzzer_utils::OpSpec spec(op_def->name());
+        for (const auto& attr : synthesizer.attrs) {
+            spec.attrs.emplace_back(attr.first, attr.second);
+        }
+        FUZZ_TRACE(1, op_def->name() << " with " << inputs.size() << " inputs, " << spec.attrs.size() << " attrs");
+
+        std::vector<tensorflow::Tensor> outputs;
+        tensorflow::Status status = tf_fuzzer_utils::runOp(spec, inputs, &outputs);
+        if (!status.ok()) {
+            return -1;
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "CPU Execution error: " << e.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -3,6 +3,7 @@ clang++ -fsanitize=fuzzer \
         -fprofile-instr-generate \
         -fcoverage-mapping \
          -O0 -g  \
+         $EXTRA_CXXFLAGS \
          -I/root/pytorch/build-fuzz/include \
          -I/root/pytorch/aten/src \
          -I/root/pytorch/c10/core \
@@ -14,6 +15,7 @@ clang++ -fsanitize=fuzzer \
          -std=c++17 \
          -I/. \
          main.cpp fuzzer_utils.cpp \
+         -Wl,--wrap=LLVMFuzzerTestOneInput \
          -Wl,-rpath,/root/pytorch/build-fuzz/caffe2/CMakeFiles/torch_cpu.dir/__/aten/src/ATen \
          -L/root/pytorch/build-fuzz/caffe2/CMakeFiles/torch_cpu.dir/__/aten/src/ATen \
          -Wl,-rpath,/root/pytorch/build-fuzz/c10/CMakeFiles/c10.dir/core/ \
@@ -1,14 +1,33 @@
 #include "fuzzer_utils.h"
+#include <c10/core/Allocator.h>
+#include <c10/core/InferenceMode.h>
+#include <c10/util/Exception.h>
+#include <ATen/Parallel.h>
+#include <ATen/CPUGeneratorImpl.h>
+#include <torch/version.h>
 #include <iostream>
 #include <fstream>
 #include <cstring>
 #include <algorithm>
+#include <cmath>
+#include <complex>
 #include <sstream>
 #include <chrono>
 #include <iomanip>
 #include <string_view>
 #include <filesystem>
 #include <thread> // If needed for future multi-threading utilities
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <unordered_map>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <unistd.h>
 
 namespace
 { // Keep internal helpers in anonymous namespace
@@ -25,6 +44,994 @@ namespace
         // torch::kFloat32 is same as kFloat, removed duplicate
     };
 
+    // --- Trace ring ---
+#if FUZZ_TRACE_RING
+    // Fixed-size storage so the crash handlers can dump it with write(2) only.
+    constexpr size_t kTraceLineMax = 256;
+    char trace_lines[FUZZ_TRACE_RING_SIZE][kTraceLineMax];
+    size_t trace_lengths[FUZZ_TRACE_RING_SIZE];
+    std::atomic<uint64_t> trace_next{0};
+    std::atomic<int64_t> input_start_ns{0};
+    std::atomic<bool> trace_dumped{false};
+    double trace_timeout_sec = 2.0;
+    const int trace_signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGALRM};
+    struct sigaction previous_actions[NSIG];
+
+    int64_t monotonicNs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    void writeAll(int fd, const char *buf, size_t len)
+    {
+        while (len > 0)
+        {
+            const ssize_t written = write(fd, buf, len);
+            if (written <= 0)
+                return;
+            buf += written;
+            len -= static_cast<size_t>(written);
+        }
+    }
+
+    void dumpTraceRing(const char *reason)
+    {
+        if (trace_dumped.exchange(true))
+            return;
+        const uint64_t end = trace_next.load();
+        const uint64_t begin = end > FUZZ_TRACE_RING_SIZE ? end - FUZZ_TRACE_RING_SIZE : 0;
+        writeAll(STDERR_FILENO, "==== fuzz trace (", 17);
+        writeAll(STDERR_FILENO, reason, strlen(reason));
+        writeAll(STDERR_FILENO, ") ====\n", 7);
+        for (uint64_t i = begin; i < end; ++i)
+        {
+            const size_t slot = i % FUZZ_TRACE_RING_SIZE;
+            writeAll(STDERR_FILENO, trace_lines[slot], trace_lengths[slot]);
+            writeAll(STDERR_FILENO, "\n", 1);
+        }
+        writeAll(STDERR_FILENO, "==== end of fuzz trace ====\n", 28);
+    }
+
+    void traceSignalHandler(int sig, siginfo_t *info, void *context)
+    {
+        // libFuzzer's SIGALRM also fires while inputs are fine; only dump once
+        // the current input has run past the timeout.
+        const bool timed_out = sig == SIGALRM &&
+                               (monotonicNs() - input_start_ns.load()) / 1e9 >= trace_timeout_sec;
+        if (sig != SIGALRM || timed_out)
+            dumpTraceRing(sig == SIGALRM ? "timeout" : "crash");
+
+        const struct sigaction &previous = previous_actions[sig];
+        if (previous.sa_flags & SA_SIGINFO)
+        {
+            if (previous.sa_sigaction)
+                previous.sa_sigaction(sig, info, context);
+        }
+        else if (previous.sa_handler == SIG_DFL)
+        {
+            signal(sig, SIG_DFL);
+            raise(sig);
+        }
+        else if (previous.sa_handler != SIG_IGN)
+        {
+            previous.sa_handler(sig);
+        }
+    }
+
+    // Installed on the first input, after libFuzzer has set up its own
+    // handlers, which are chained to.
+    void installTraceHandlers()
+    {
+        static const bool installed = []
+        {
+            const char *timeout = std::getenv("FUZZ_TRACE_TIMEOUT");
+            if (timeout && std::atof(timeout) > 0)
+                trace_timeout_sec = std::atof(timeout);
+            for (int sig : trace_signals)
+            {
+                struct sigaction action = {};
+                action.sa_sigaction = traceSignalHandler;
+                action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+                sigemptyset(&action.sa_mask);
+                sigaction(sig, &action, &previous_actions[sig]);
+            }
+            return true;
+        }();
+        (void)installed;
+    }
+#endif // FUZZ_TRACE_RING
+
+    // --- Pooling allocator ---
+    constexpr size_t kMinClassShift = 6;  // 64 bytes, c10's CPU alignment
+    constexpr size_t kMaxClassShift = 26; // 64 MiB; larger blocks bypass the pool
+    constexpr size_t kNumClasses = kMaxClassShift - kMinClassShift + 1;
+    constexpr size_t kAlignment = 64;
+
+    size_t sizeClass(size_t nbytes)
+    {
+        size_t shift = kMinClassShift;
+        while (shift <= kMaxClassShift && (size_t{1} << shift) < nbytes)
+            ++shift;
+        return shift <= kMaxClassShift ? shift - kMinClassShift : kNumClasses;
+    }
+
+    size_t classBytes(size_t size_class)
+    {
+        return size_t{1} << (size_class + kMinClassShift);
+    }
+
+    // Every block is preceded by a kAlignment-sized header holding its size
+    // class, so a free needs no lookup. Storage pointers stay the DataPtr
+    // context, as raw_allocate expects.
+    struct BlockHeader
+    {
+        size_t size_class;
+    };
+    static_assert(sizeof(BlockHeader) <= kAlignment, "block header must fit in the alignment padding");
+
+    BlockHeader *blockHeader(void *ptr)
+    {
+        return reinterpret_cast<BlockHeader *>(static_cast<char *>(ptr) - kAlignment);
+    }
+
+    // Leaked on purpose: storages can be released during static destruction.
+    struct PoolState
+    {
+        std::mutex mu;
+        std::vector<void *> free_lists[kNumClasses];
+        fuzzer_utils::AllocatorStats stats;
+    };
+
+    PoolState &poolState()
+    {
+        static PoolState *state = new PoolState();
+        return *state;
+    }
+
+    // Hands cached blocks back to the system until at most `limit` bytes stay
+    // cached, largest classes first.
+    void releaseCached(PoolState &state, size_t limit)
+    {
+        std::vector<void *> released;
+        {
+            std::lock_guard<std::mutex> lock(state.mu);
+            for (size_t c = kNumClasses; c-- > 0 && state.stats.cached_bytes > limit;)
+            {
+                while (!state.free_lists[c].empty() && state.stats.cached_bytes > limit)
+                {
+                    released.push_back(state.free_lists[c].back());
+                    state.free_lists[c].pop_back();
+                    state.stats.cached_bytes -= classBytes(c);
+                }
+            }
+            ++state.stats.trims;
+        }
+        for (void *ptr : released)
+            std::free(blockHeader(ptr));
+    }
+
+    void deleteBlock(void *ptr)
+    {
+        if (ptr == nullptr)
+            return;
+        const size_t size_class = blockHeader(ptr)->size_class;
+        if (size_class < kNumClasses)
+        {
+            PoolState &state = poolState();
+            std::lock_guard<std::mutex> lock(state.mu);
+            state.free_lists[size_class].push_back(ptr);
+            state.stats.cached_bytes += classBytes(size_class);
+            state.stats.peak_cached_bytes = std::max(state.stats.peak_cached_bytes, state.stats.cached_bytes);
+            return;
+        }
+        std::free(blockHeader(ptr));
+    }
+
+// Allocator::allocate lost its const qualifier, and copy_data was added, in 2.3.
+#if TORCH_VERSION_MAJOR > 2 || (TORCH_VERSION_MAJOR == 2 && TORCH_VERSION_MINOR >= 3)
+#define FUZZ_ALLOCATE_CONST
+#define FUZZ_ALLOCATOR_HAS_COPY_DATA 1
+#else
+#define FUZZ_ALLOCATE_CONST const
+#define FUZZ_ALLOCATOR_HAS_COPY_DATA 0
+#endif
+
+    class PoolingCPUAllocator final : public c10::Allocator
+    {
+    public:
+        c10::DataPtr allocate(size_t nbytes) FUZZ_ALLOCATE_CONST override
+        {
+            const c10::Device device(c10::DeviceType::CPU);
+            if (nbytes == 0)
+                return {nullptr, nullptr, &deleteBlock, device};
+
+            const size_t size_class = sizeClass(nbytes);
+            const size_t bytes = size_class < kNumClasses ? classBytes(size_class) : nbytes;
+            PoolState &state = poolState();
+            void *ptr = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(state.mu);
+                ++state.stats.allocations;
+                if (size_class < kNumClasses && !state.free_lists[size_class].empty())
+                {
+                    ptr = state.free_lists[size_class].back();
+                    state.free_lists[size_class].pop_back();
+                    state.stats.cached_bytes -= bytes;
+                    ++state.stats.pool_hits;
+                }
+            }
+            if (ptr == nullptr)
+            {
+                void *block = nullptr;
+                if (posix_memalign(&block, kAlignment, kAlignment + bytes) != 0)
+                    throw std::bad_alloc();
+                ptr = static_cast<char *>(block) + kAlignment;
+                blockHeader(ptr)->size_class = size_class;
+            }
+            return {ptr, ptr, &deleteBlock, device};
+        }
+
+        c10::DeleterFnPtr raw_deleter() const override
+        {
+            return &deleteBlock;
+        }
+
+#if FUZZ_ALLOCATOR_HAS_COPY_DATA
+        void copy_data(void *dest, const void *src, std::size_t count) const override
+        {
+            default_copy_data(dest, src, count);
+        }
+#endif
+    };
+
+    void printAllocatorStats()
+    {
+        const fuzzer_utils::AllocatorStats stats = fuzzer_utils::allocatorStats();
+        std::fprintf(stderr,
+                     "stat::fuzz_alloc_per_exec: %.1f\nstat::fuzz_alloc_hit_rate: %.3f\n"
+                     "stat::fuzz_alloc_peak_cached_bytes: %zu\nstat::fuzz_alloc_trims: %llu\n",
+                     stats.allocationsPerExec(), stats.hitRate(), stats.peak_cached_bytes,
+                     static_cast<unsigned long long>(stats.trims));
+    }
+
+#if FUZZ_POOLING_ALLOCATOR
+    const bool pooling_allocator_installed = []
+    {
+        static PoolingCPUAllocator *allocator = new PoolingCPUAllocator();
+        // Priority 1 wins over c10's default CPU allocator (priority 0).
+        c10::SetAllocator(c10::DeviceType::CPU, allocator, 1);
+        const char *env = std::getenv("FUZZ_ALLOCATOR_STATS");
+        if (env && env[0] == '1')
+        {
+            std::atexit(printAllocatorStats);
+        }
+        return true;
+    }();
+#endif
+
+    // Inputs the harness ran and rejected (non-zero return, e.g. an
+    // exception), printed at exit with FUZZ_INPUT_STATS=1.
+    std::atomic<uint64_t> inputs_run{0};
+    std::atomic<uint64_t> inputs_rejected{0};
+    // Gradient checks that ran and that found a mismatch.
+    std::atomic<uint64_t> gradchecks_run{0};
+    std::atomic<uint64_t> gradchecks_failed{0};
+
+    void printInputStats()
+    {
+        const uint64_t run = inputs_run.load();
+        const uint64_t rejected = inputs_rejected.load();
+        std::fprintf(stderr, "stat::fuzz_inputs: %llu\nstat::fuzz_rejected_inputs: %llu\nstat::fuzz_valid_input_ratio: %.3f\n",
+                     static_cast<unsigned long long>(run), static_cast<unsigned long long>(rejected),
+                     run == 0 ? 0.0 : static_cast<double>(run - rejected) / run);
+        if (gradchecks_run.load() > 0)
+            std::fprintf(stderr, "stat::fuzz_gradchecks: %llu\nstat::fuzz_gradcheck_mismatches: %llu\n",
+                         static_cast<unsigned long long>(gradchecks_run.load()),
+                         static_cast<unsigned long long>(gradchecks_failed.load()));
+    }
+
+    // Per-input bookkeeping around the harness entry point.
+    void endInput()
+    {
+        constexpr size_t kCacheLimit = static_cast<size_t>(FUZZ_POOL_CACHE_MB) << 20;
+        PoolState &state = poolState();
+        bool over_limit = false;
+        {
+            std::lock_guard<std::mutex> lock(state.mu);
+            ++state.stats.execs;
+            over_limit = state.stats.cached_bytes > kCacheLimit;
+        }
+        if (over_limit)
+            releaseCached(state, kCacheLimit);
+    }
+
+    // Memory layout a tensor is handed to the harness in.
+    enum class TensorLayout
+    {
+        Contiguous,
+        Transposed,    // dims d0 and d1 swapped in memory
+        Strided,       // every other element along d0 (slice with step 2)
+        Broadcast,     // d0 expanded from size 1 (stride 0)
+        StorageOffset, // contiguous strides after `extra` zeroed storage elements
+        ChannelsLast,  // channels_last / channels_last_3d memory format
+    };
+
+    // Metadata decoded from the input ahead of a tensor's data bytes.
+    struct TensorMeta
+    {
+        torch::ScalarType dtype;
+        std::vector<int64_t> shape;
+        int64_t numElements;
+        size_t nbytes;
+        TensorLayout layout = TensorLayout::Contiguous;
+        int64_t d0 = 0;
+        int64_t d1 = 0;
+        int64_t extra = 0;
+    };
+
+#if FUZZ_TENSOR_LAYOUTS
+    // Three eighths of the selectors keep the tensor contiguous; the upper
+    // bits pick the dimensions involved.
+    void parseLayout(uint8_t selector, TensorMeta &meta)
+    {
+        const int64_t rank = static_cast<int64_t>(meta.shape.size());
+        if (rank == 0 || meta.numElements == 0)
+            return;
+        meta.d0 = (selector >> 3) % rank;
+        meta.d1 = (meta.d0 + 1 + (selector >> 5) % std::max<int64_t>(rank - 1, 1)) % rank;
+        switch (selector % 8)
+        {
+        case 3:
+            if (rank >= 2)
+                meta.layout = TensorLayout::Transposed;
+            break;
+        case 4:
+            meta.layout = TensorLayout::Strided;
+            break;
+        case 5:
+            for (int64_t i = 0; i < rank; ++i)
+            {
+                const int64_t d = (meta.d0 + i) % rank;
+                if (meta.shape[d] > 1)
+                {
+                    meta.d0 = d;
+                    meta.layout = TensorLayout::Broadcast;
+                    break;
+                }
+            }
+            break;
+        case 6:
+            meta.layout = TensorLayout::StorageOffset;
+            meta.extra = 1 + (selector >> 3) % 3;
+            break;
+        case 7:
+            if (rank == 4 || rank == 5)
+                meta.layout = TensorLayout::ChannelsLast;
+            else if (rank >= 2)
+                meta.layout = TensorLayout::Transposed;
+            break;
+        default:
+            break;
+        }
+    }
+#endif
+
+    // Shape of the storage-backed tensor the input bytes are copied into.
+    std::vector<int64_t> physicalShape(const TensorMeta &meta)
+    {
+        std::vector<int64_t> shape = meta.shape;
+        if (meta.layout == TensorLayout::Transposed)
+            std::swap(shape[meta.d0], shape[meta.d1]);
+        else if (meta.layout == TensorLayout::StorageOffset)
+            shape = {meta.numElements + meta.extra};
+        return shape;
+    }
+
+    torch::Tensor allocatePhysical(const TensorMeta &meta, const torch::TensorOptions &options)
+    {
+        if (meta.layout == TensorLayout::ChannelsLast)
+        {
+            const auto format = meta.shape.size() == 4 ? at::MemoryFormat::ChannelsLast : at::MemoryFormat::ChannelsLast3d;
+            return torch::empty(meta.shape, options.memory_format(format));
+        }
+        return torch::empty(physicalShape(meta), options);
+    }
+
+    // Turns the filled physical tensor into the tensor of shape meta.shape in
+    // the selected layout. Only Strided copies; every other layout is a view.
+    torch::Tensor applyLayout(const TensorMeta &meta, const torch::Tensor &physical)
+    {
+        switch (meta.layout)
+        {
+        case TensorLayout::Transposed:
+            return physical.transpose(meta.d0, meta.d1);
+        case TensorLayout::Strided:
+        {
+            std::vector<int64_t> wide = meta.shape;
+            wide[meta.d0] *= 2;
+            torch::Tensor strided = torch::zeros(wide, physical.options()).slice(meta.d0, 0, wide[meta.d0], 2);
+            strided.copy_(physical);
+            return strided;
+        }
+        case TensorLayout::Broadcast:
+            return physical.narrow(meta.d0, 0, 1).expand(meta.shape);
+        case TensorLayout::StorageOffset:
+        {
+            std::vector<int64_t> strides(meta.shape.size(), 1);
+            for (int64_t i = static_cast<int64_t>(meta.shape.size()) - 2; i >= 0; --i)
+                strides[i] = strides[i + 1] * std::max<int64_t>(meta.shape[i + 1], 1);
+            return physical.as_strided(meta.shape, strides, meta.extra);
+        }
+        default:
+            return physical;
+        }
+    }
+
+    TensorMeta parseTensorMeta(const uint8_t *Data, size_t Size, size_t &offset)
+    {
+        // Need at least 1 byte for dtype and 1 byte for rank.
+        const size_t min_required_size = 2;
+        if (Size < offset + min_required_size)
+        {
+            throw std::runtime_error("Input data too small for basic tensor metadata (dtype, rank). Offset: " + std::to_string(offset) + ", Size: " + std::to_string(Size));
+        }
+
+        FUZZ_TRACE(2, "--- Creating Tensor --- Initial offset: " << offset << ", Size: " << Size);
+
+        TensorMeta meta;
+
+        // 1. Parse Data Type
+        const uint8_t dtype_selector = Data[offset++];
+        meta.dtype = fuzzer_utils::parseDataType(dtype_selector);
+
+        // 2. Parse Rank
+        const uint8_t rank_byte = Data[offset++];
+        const uint8_t rank = fuzzer_utils::parseRank(rank_byte);
+
+        // 3. Parse Shape
+        // parseShape updates the offset internally
+        meta.shape = fuzzer_utils::parseShape(Data, offset, Size, rank);
+
+        // 4. Compute Number of Elements
+        meta.numElements = 1;
+        for (const auto &dim : meta.shape)
+        {
+            // Dimensions must be non-negative, and the product must not overflow
+            if (dim < 0 || (dim > 0 && meta.numElements > std::numeric_limits<int64_t>::max() / dim))
+            {
+                FUZZ_TRACE(2, "Error: Invalid dimension " << dim << " in shape.");
+                throw std::runtime_error("Parsed shape is invalid (negative dimension or overflow).");
+            }
+            meta.numElements *= dim;
+        }
+
+        const size_t dtypeSize = c10::elementSize(meta.dtype);
+        if (static_cast<uint64_t>(meta.numElements) > std::numeric_limits<size_t>::max() / dtypeSize)
+        {
+            throw std::runtime_error("Number of elements or dtypeSize leads to potential overflow or invalid.");
+        }
+        meta.nbytes = static_cast<size_t>(meta.numElements) * dtypeSize;
+
+        FUZZ_TRACE(2, "Calculated numElements: " << meta.numElements);
+
+#if FUZZ_TENSOR_LAYOUTS
+        // 5. Parse Layout
+        if (offset < Size)
+        {
+            parseLayout(Data[offset++], meta);
+            FUZZ_TRACE(2, "Layout: " << static_cast<int>(meta.layout) << " d0=" << meta.d0 << " d1=" << meta.d1);
+        }
+#endif
+        return meta;
+    }
+
+    // A cached module and copies of the parameters and buffers it had right
+    // after construction.
+    struct CachedModule
+    {
+        std::shared_ptr<torch::nn::Module> module;
+        std::vector<torch::Tensor> parameters;
+        std::vector<bool> requires_grad;
+        std::vector<torch::Tensor> buffers;
+    };
+
+    std::unordered_map<std::string, CachedModule> &moduleCache()
+    {
+        static auto *cache = new std::unordered_map<std::string, CachedModule>();
+        return *cache;
+    }
+
+    // Optional parameters and buffers (e.g. a disabled bias) are registered
+    // as undefined tensors.
+    std::vector<torch::Tensor> definedTensors(std::vector<torch::Tensor> tensors)
+    {
+        tensors.erase(std::remove_if(tensors.begin(), tensors.end(),
+                                     [](const torch::Tensor &t)
+                                     { return !t.defined(); }),
+                      tensors.end());
+        return tensors;
+    }
+
+    bool sameLayout(const std::vector<torch::Tensor> &current, const std::vector<torch::Tensor> &initial)
+    {
+        if (current.size() != initial.size())
+            return false;
+        for (size_t i = 0; i < current.size(); ++i)
+        {
+            if (current[i].sizes() != initial[i].sizes() ||
+                current[i].scalar_type() != initial[i].scalar_type())
+                return false;
+        }
+        return true;
+    }
+
+    // Copies the initial values back in place, so views held by the module
+    // (e.g. the flat weights of RNNs) stay valid. Returns false if the
+    // harness replaced, resized or retyped a parameter or buffer.
+    bool restoreModule(CachedModule &entry)
+    {
+        torch::NoGradGuard no_grad;
+        std::vector<torch::Tensor> parameters = definedTensors(entry.module->parameters());
+        std::vector<torch::Tensor> buffers = definedTensors(entry.module->buffers());
+        if (!sameLayout(parameters, entry.parameters) || !sameLayout(buffers, entry.buffers))
+            return false;
+        for (size_t i = 0; i < parameters.size(); ++i)
+        {
+            parameters[i].copy_(entry.parameters[i]);
+            parameters[i].mutable_grad() = torch::Tensor();
+            parameters[i].set_requires_grad(entry.requires_grad[i]);
+        }
+        for (size_t i = 0; i < buffers.size(); ++i)
+            buffers[i].copy_(entry.buffers[i]);
+        entry.module->train();
+        return true;
+    }
+
+    uint8_t readByte(const uint8_t *Data, size_t Size, size_t &offset)
+    {
+        return offset < Size ? Data[offset++] : 0;
+    }
+
+    torch::ScalarType parseQuantizedType(uint8_t selector)
+    {
+        static const torch::ScalarType qtypes[] = {torch::kQUInt8, torch::kQInt8, torch::kQInt32};
+        return qtypes[selector % 3];
+    }
+
+    // 2^e * (1 + m / 256) with e in [-12, 3].
+    double parseScale(const uint8_t *Data, size_t Size, size_t &offset)
+    {
+        const uint8_t e = readByte(Data, Size, offset);
+        const uint8_t m = readByte(Data, Size, offset);
+        return std::ldexp(1.0 + m / 256.0, static_cast<int>(e % 16) - 12);
+    }
+
+    int64_t parseZeroPoint(const uint8_t *Data, size_t Size, size_t &offset, torch::ScalarType qtype)
+    {
+        const uint8_t byte = readByte(Data, Size, offset);
+        return qtype == torch::kQUInt8 ? static_cast<int64_t>(byte) : static_cast<int64_t>(static_cast<int8_t>(byte));
+    }
+
+    std::vector<int64_t> parseQuantizedShape(const uint8_t *Data, size_t Size, size_t &offset)
+    {
+        const uint8_t rank = fuzzer_utils::parseRank(readByte(Data, Size, offset));
+        return fuzzer_utils::parseShape(Data, offset, Size, rank);
+    }
+
+    // Copies the integer payload into a freshly allocated quantized tensor.
+    void fillQuantized(torch::Tensor &tensor, const uint8_t *Data, size_t Size, size_t &offset)
+    {
+        const size_t nbytes = tensor.nbytes();
+        const size_t bytesToCopy = std::min(nbytes, offset < Size ? Size - offset : 0);
+        auto *dst = static_cast<uint8_t *>(tensor.data_ptr());
+        if (bytesToCopy > 0)
+            std::memcpy(dst, Data + offset, bytesToCopy);
+        if (nbytes > bytesToCopy)
+            std::memset(dst + bytesToCopy, 0, nbytes - bytesToCopy);
+        offset += bytesToCopy;
+    }
+
+    torch::Tensor createPerTensorQuantized(const std::vector<int64_t> &shape, torch::ScalarType qtype,
+                                           const uint8_t *Data, size_t Size, size_t &offset)
+    {
+        const double scale = parseScale(Data, Size, offset);
+        const int64_t zero_point = parseZeroPoint(Data, Size, offset, qtype);
+        FUZZ_TRACE(2, "createQuantizedTensor " << c10::toString(qtype) << " scale=" << scale << " zero_point=" << zero_point);
+        torch::Tensor tensor = at::_empty_affine_quantized(shape, torch::TensorOptions().dtype(qtype), scale, zero_point);
+        fillQuantized(tensor, Data, Size, offset);
+        return tensor;
+    }
+
+#if FUZZ_STRUCTURED_MATRICES
+    using Complex = std::complex<double>;
+
+    // Reads matrix entries in [-2, 2) from one input byte each (two for
+    // complex); zero once the input is exhausted.
+    struct SeedReader
+    {
+        const uint8_t *data;
+        size_t size;
+        size_t &offset;
+        bool is_complex;
+
+        double real()
+        {
+            return offset < size ? (static_cast<int>(data[offset++]) - 128) / 64.0 : 0.0;
+        }
+        Complex next()
+        {
+            const double re = real();
+            return Complex(re, is_complex ? real() : 0.0);
+        }
+    };
+
+    // q <- q * (I - 2 v v^H / |v|^2); a zero v leaves q unchanged.
+    void applyReflector(std::vector<Complex> &q, const std::vector<Complex> &v, int64_t n)
+    {
+        double norm2 = 0.0;
+        for (const Complex &x : v)
+            norm2 += std::norm(x);
+        if (norm2 == 0.0)
+            return;
+        for (int64_t i = 0; i < n; ++i)
+        {
+            Complex qv = 0.0;
+            for (int64_t k = 0; k < n; ++k)
+                qv += q[i * n + k] * v[k];
+            for (int64_t j = 0; j < n; ++j)
+                q[i * n + j] -= 2.0 / norm2 * qv * std::conj(v[j]);
+        }
+    }
+
+    // Row-major n x n matrix of the given kind built from the seed bytes.
+    std::vector<Complex> structuredMatrix(fuzzer_utils::MatrixKind kind, int64_t n, uint8_t param, SeedReader &seed)
+    {
+        using fuzzer_utils::MatrixKind;
+        std::vector<Complex> a(n * n, 0.0);
+        switch (kind)
+        {
+        case MatrixKind::SPD:
+        {
+            const int64_t r = 1 + param % n;
+            std::vector<Complex> b(n * r);
+            for (Complex &x : b)
+                x = seed.next();
+            const double eps = 1.0 / (1 + (param >> 4));
+            for (int64_t i = 0; i < n; ++i)
+            {
+                for (int64_t j = 0; j < n; ++j)
+                {
+                    Complex sum = 0.0;
+                    for (int64_t k = 0; k < r; ++k)
+                        sum += b[i * r + k] * std::conj(b[j * r + k]);
+                    a[i * n + j] = sum;
+                }
+                a[i * n + i] += eps;
+            }
+            break;
+        }
+        case MatrixKind::Orthogonal:
+        case MatrixKind::NearSingular:
+        {
+            std::vector<Complex> q(n * n, 0.0);
+            for (int64_t i = 0; i < n; ++i)
+                q[i * n + i] = 1.0;
+            const int64_t reflectors = kind == MatrixKind::Orthogonal ? 1 + param % std::min<int64_t>(n, 3) : 1;
+            std::vector<Complex> v(n);
+            for (int64_t h = 0; h < reflectors; ++h)
+            {
+                for (Complex &x : v)
+                    x = seed.next();
+                applyReflector(q, v, n);
+            }
+            if (kind == MatrixKind::Orthogonal)
+                return q;
+            // Q is a Hermitian reflector, so Q diag(s) Q^H is Hermitian PSD.
+            std::vector<double> s(n);
+            for (double &x : s)
+                x = 1.0 + std::abs(seed.real());
+            s[param % n] = param % 16 == 15 ? 0.0 : std::pow(10.0, -(1 + param % 15));
+            for (int64_t i = 0; i < n; ++i)
+                for (int64_t j = 0; j < n; ++j)
+                {
+                    Complex sum = 0.0;
+                    for (int64_t k = 0; k < n; ++k)
+                        sum += q[i * n + k] * s[k] * std::conj(q[j * n + k]);
+                    a[i * n + j] = sum;
+                }
+            break;
+        }
+        default:
+        {
+            const int64_t lower = kind == MatrixKind::Banded ? param % n : (kind == MatrixKind::Triangular && (param & 1) ? 0 : n);
+            const int64_t upper = kind == MatrixKind::Banded ? (param >> 4) % n : (kind == MatrixKind::Triangular && !(param & 1) ? 0 : n);
+            for (int64_t i = 0; i < n; ++i)
+            {
+                double off_diagonal = 0.0;
+                for (int64_t j = 0; j < n; ++j)
+                {
+                    if (j < i - lower || j > i + upper)
+                        continue;
+                    a[i * n + j] = seed.next();
+                    if (j != i)
+                        off_diagonal += std::abs(a[i * n + j]);
+                }
+                // Strict diagonal dominance keeps the matrix invertible.
+                const double sign = a[i * n + i].real() < 0 ? -1.0 : 1.0;
+                a[i * n + i] = sign * (off_diagonal + 1.0 + std::abs(a[i * n + i]));
+            }
+            break;
+        }
+        }
+        return a;
+    }
+#endif
+
+    // Distance between two values in representable steps of Bits-wide floats: map the
+    // sign-magnitude bit patterns onto a monotonic integer line and subtract.
+    template <typename Bits, typename T>
+    int64_t ulpDistance(T a, T b)
+    {
+        static_assert(sizeof(Bits) == sizeof(T), "bit width must match the value type");
+        Bits ia, ib;
+        std::memcpy(&ia, &a, sizeof(T));
+        std::memcpy(&ib, &b, sizeof(T));
+        auto ordered = [](Bits i) -> __int128
+        { return i < 0 ? static_cast<__int128>(std::numeric_limits<Bits>::min()) - i : static_cast<__int128>(i); };
+        __int128 d = ordered(ia) - ordered(ib);
+        if (d < 0)
+            d = -d;
+        return d > std::numeric_limits<int64_t>::max() ? std::numeric_limits<int64_t>::max() : static_cast<int64_t>(d);
+    }
+
+    int64_t ulpError(float a, float b) { return ulpDistance<int32_t>(a, b); }
+    int64_t ulpError(double a, double b) { return ulpDistance<int64_t>(a, b); }
+    int64_t ulpError(c10::Half a, c10::Half b) { return ulpDistance<int16_t>(a, b); }
+    int64_t ulpError(c10::BFloat16 a, c10::BFloat16 b) { return ulpDistance<int16_t>(a, b); }
+
+    // Folds one element pair into a CompareResult; `reference` is the magnitude of the
+    // expected value used for the allclose-style bound atol + rtol * |reference|.
+    struct ErrorAccumulator
+    {
+        fuzzer_utils::CompareResult &result;
+        double rtol;
+        double atol;
+
+        void nanMismatch()
+        {
+            ++result.nan_mismatches;
+            ++result.mismatches;
+        }
+
+        void add(double abs_error, double reference, int64_t ulp_error)
+        {
+            const double rel_error = reference > 0 ? abs_error / reference : std::numeric_limits<double>::infinity();
+            result.max_abs_error = std::max(result.max_abs_error, abs_error);
+            result.max_rel_error = std::max(result.max_rel_error, rel_error);
+            result.max_ulp_error = std::max(result.max_ulp_error, ulp_error);
+            if (!(abs_error <= atol + rtol * reference))
+                ++result.mismatches;
+        }
+    };
+
+    template <typename T>
+    void compareElements(const T *a, const T *b, int64_t n, ErrorAccumulator &acc)
+    {
+        if constexpr (c10::is_complex<T>::value)
+        {
+            for (int64_t i = 0; i < n; ++i)
+            {
+                const bool nan_a = std::isnan(a[i].real()) || std::isnan(a[i].imag());
+                const bool nan_b = std::isnan(b[i].real()) || std::isnan(b[i].imag());
+                if (nan_a || nan_b)
+                {
+                    if (nan_a != nan_b)
+                        acc.nanMismatch();
+                    continue;
+                }
+                if (a[i] == b[i])
+                    continue;
+                const std::complex<double> x(a[i].real(), a[i].imag());
+                const std::complex<double> y(b[i].real(), b[i].imag());
+                acc.add(std::abs(x - y), std::abs(y),
+                        std::max(ulpError(a[i].real(), b[i].real()), ulpError(a[i].imag(), b[i].imag())));
+            }
+        }
+        else if constexpr (std::is_floating_point<T>::value || std::is_same<T, c10::Half>::value ||
+                           std::is_same<T, c10::BFloat16>::value)
+        {
+            for (int64_t i = 0; i < n; ++i)
+            {
+                const double x = static_cast<double>(a[i]);
+                const double y = static_cast<double>(b[i]);
+                const bool nan_a = std::isnan(x);
+                const bool nan_b = std::isnan(y);
+                if (nan_a || nan_b)
+                {
+                    if (nan_a != nan_b)
+                        acc.nanMismatch();
+                    continue;
+                }
+                if (x == y)
+                    continue;
+                acc.add(std::abs(x - y), std::abs(y), ulpError(a[i], b[i]));
+            }
+        }
+        else
+        {
+            // Integers and bool compare exactly; the "ULP" error is the integer distance.
+            for (int64_t i = 0; i < n; ++i)
+            {
+                if (a[i] == b[i])
+                    continue;
+                const double diff = std::abs(static_cast<double>(a[i]) - static_cast<double>(b[i]));
+                acc.add(diff, std::abs(static_cast<double>(b[i])),
+                        diff >= 0x1p63 ? std::numeric_limits<int64_t>::max() : static_cast<int64_t>(diff));
+            }
+        }
+    }
+
+    // Bring a tensor into a plain strided CPU form whose data_ptr holds the logical values.
+    torch::Tensor comparable(const torch::Tensor &t)
+    {
+        torch::Tensor out = t;
+        if (out.is_sparse() || out.layout() != torch::kStrided)
+            out = out.to_dense();
+        if (out.is_quantized())
+            out = out.int_repr();
+        return out.resolve_conj().resolve_neg().contiguous();
+    }
+
+    uint64_t fnv1a64(const uint8_t *data, size_t size)
+    {
+        uint64_t h = 1469598103934665603ULL;
+        for (size_t i = 0; i < size; ++i)
+        {
+            h ^= data[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    // Content-addressed store for oracle failures: the input goes to
+    // diff_inputs/<fnv1a-64>.bin with the summary in <hash>.txt, so an input that
+    // trips an oracle thousands of times during a campaign is written once.
+    void storeMismatch(const uint8_t *data, size_t size, const std::string &summary)
+    {
+        std::ostringstream name;
+        name << "diff_inputs/" << std::hex << std::setw(16) << std::setfill('0') << fnv1a64(data, size);
+        const std::string bin_filename = name.str() + ".bin";
+        std::cerr << summary << " -> " << bin_filename << std::endl;
+
+        std::error_code ec;
+        if (std::filesystem::exists(bin_filename, ec) || !fuzzer_utils::ensure_log_directory_exists("diff_inputs"))
+            return;
+        std::ofstream bin_file(bin_filename, std::ios::binary);
+        bin_file.write(reinterpret_cast<const char *>(data), size);
+        std::ofstream(name.str() + ".txt") << summary << "\n";
+        if (!bin_file)
+            std::cerr << "Failed to save input data to " << bin_filename << std::endl;
+    }
+
+#if FUZZ_GRADCHECK
+    // Saves the default CPU generator's state and restores it on scope exit, so
+    // reseeding it for a gradient check leaves the harness's random stream alone.
+    struct DefaultGeneratorGuard
+    {
+        at::Generator gen = at::detail::getDefaultCPUGenerator();
+        torch::Tensor state;
+
+        DefaultGeneratorGuard()
+        {
+            std::lock_guard<std::mutex> lock(gen.mutex());
+            state = gen.get_state();
+        }
+        ~DefaultGeneratorGuard()
+        {
+            std::lock_guard<std::mutex> lock(gen.mutex());
+            gen.set_state(state);
+        }
+        void reseed(uint64_t seed)
+        {
+            std::lock_guard<std::mutex> lock(gen.mutex());
+            gen.set_current_seed(seed);
+        }
+    };
+
+    // Projects fn's output onto a fixed random vector v so one backward pass gives the
+    // gradient of the scalar s = <fn(x), v>; its derivative along a random sparse
+    // direction u is then compared with (s(x + eps u) - s(x - eps u)) / 2 eps.
+    bool runGradCheck(const fuzzer_utils::DifferentiableFn &fn, const std::vector<torch::Tensor> &inputs,
+                      const uint8_t *data, size_t size)
+    {
+        constexpr double kEps = 1e-6;
+        constexpr double kAtol = 1e-5;
+        constexpr double kRtol = 1e-3;
+        // Finite differences of elements beyond this magnitude carry no usable precision.
+        constexpr double kMaxAbs = 1e3;
+
+        const uint64_t seed = fnv1a64(data, size);
+        at::Generator gen = at::detail::createCPUGenerator(seed);
+        torch::AutoGradMode grad_mode(true);
+
+        std::vector<torch::Tensor> x = inputs;
+        std::vector<size_t> wrt;
+        std::vector<torch::Tensor> wrt_x;
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            if (!x[i].defined() || !x[i].is_floating_point() || x[i].numel() == 0 || x[i].layout() != torch::kStrided)
+                continue;
+            x[i] = x[i].detach().to(torch::kDouble).clone().requires_grad_(true);
+            wrt.push_back(i);
+            wrt_x.push_back(x[i]);
+        }
+        if (wrt.empty())
+            return true;
+
+        // Reseed before each evaluation so random ops (dropout, rrelu) draw the same values.
+        DefaultGeneratorGuard default_gen;
+        auto evaluate = [&](const std::vector<torch::Tensor> &args)
+        {
+            default_gen.reseed(seed);
+            return fn(args);
+        };
+        const torch::Tensor y = evaluate(x);
+        if (!y.defined() || !y.requires_grad() || !y.is_floating_point())
+            return true;
+        const torch::Tensor v = torch::randn(y.sizes(), gen, torch::TensorOptions().dtype(y.scalar_type()));
+        const torch::Tensor terms = (y * v).to(torch::kDouble);
+        const double s0 = terms.sum().item<double>();
+        // Round-off of a difference quotient grows with the magnitude of the summed terms.
+        const double roundoff = 1e-8 * terms.detach().abs().sum().item<double>();
+        if (!std::isfinite(s0) || !std::isfinite(roundoff))
+            return true;
+        const auto grads = torch::autograd::grad({terms.sum()}, wrt_x, {}, false, false, /*allow_unused=*/true);
+
+        torch::NoGradGuard no_grad;
+        const int64_t per_input = std::max<int64_t>(1, FUZZ_GRADCHECK_MAX_ELEMENTS / static_cast<int64_t>(wrt.size()));
+        for (int sample = 0; sample < FUZZ_GRADCHECK_SAMPLES; ++sample)
+        {
+            std::vector<torch::Tensor> plus = x;
+            std::vector<torch::Tensor> minus = x;
+            double analytic = 0.0;
+            for (size_t k = 0; k < wrt.size(); ++k)
+            {
+                const torch::Tensor xk = x[wrt[k]].detach();
+                const int64_t m = std::min<int64_t>(per_input, xk.numel());
+                const torch::Tensor idx = torch::randint(xk.numel(), {m}, gen, torch::TensorOptions().dtype(torch::kLong));
+                const torch::Tensor in_range = xk.reshape(-1).index({idx}).abs() <= kMaxAbs;
+                torch::Tensor u = torch::zeros(xk.sizes(), xk.options());
+                u.view(-1).index_put_({idx}, torch::randn({m}, gen, xk.options()) * in_range);
+                if (grads[k].defined())
+                    analytic += (grads[k] * u).sum().item<double>();
+                plus[wrt[k]] = xk + kEps * u;
+                minus[wrt[k]] = xk - kEps * u;
+            }
+            const double sp = (evaluate(plus) * v).sum().item<double>();
+            const double sm = (evaluate(minus) * v).sum().item<double>();
+            const double numeric = (sp - sm) / (2 * kEps);
+            if (!std::isfinite(numeric) || !std::isfinite(analytic))
+                continue;
+            const double tol = kAtol + kRtol * std::max(std::abs(analytic), std::abs(numeric)) + roundoff / kEps;
+            // One-sided quotients that disagree mean fn has a kink or branch cut at x,
+            // where autograd's choice of subgradient is not a bug.
+            if (std::abs((sp - s0) - (s0 - sm)) / kEps > tol)
+                continue;
+            if (std::abs(analytic - numeric) <= tol)
+                continue;
+
+            std::ostringstream summary;
+            summary << "Gradient mismatch: directional derivative " << analytic << " (autograd) vs " << numeric
+                    << " (finite difference), sample " << sample;
+            storeMismatch(data, size, summary.str());
+            return false;
+        }
+        return true;
+    }
+#endif
+
 } // namespace
 
 namespace fuzzer_utils
@@ -126,14 +1133,83 @@ namespace fuzzer_utils
         ofs << separator;
     }
 
+    // --- Tracing Implementation ---
+
+    void traceMessage(const std::string &msg)
+    {
+#if FUZZ_TRACE_RING
+        const size_t slot = trace_next.load() % FUZZ_TRACE_RING_SIZE;
+        const size_t len = std::min(msg.size(), kTraceLineMax);
+        std::memcpy(trace_lines[slot], msg.data(), len);
+        trace_lengths[slot] = len;
+        trace_next.fetch_add(1);
+#else
+        std::cout << msg << '\n';
+#endif
+    }
+
+    void traceInput()
+    {
+#if FUZZ_TRACE_RING
+        installTraceHandlers();
+        input_start_ns.store(monotonicNs());
+#endif
+        FUZZ_TRACE(1, "Start Fuzzing");
+    }
+
+    // --- Allocator Implementation ---
+
+    AllocatorStats allocatorStats()
+    {
+        PoolState &state = poolState();
+        std::lock_guard<std::mutex> lock(state.mu);
+        return state.stats;
+    }
+
+    // --- Module Cache Implementation ---
+
+    std::shared_ptr<torch::nn::Module> findCachedModule(const std::string &key)
+    {
+        auto &cache = moduleCache();
+        auto it = cache.find(key);
+        if (it == cache.end())
+            return nullptr;
+        if (!restoreModule(it->second))
+        {
+            FUZZ_TRACE(2, "Module cache entry changed layout: " << key);
+            cache.erase(it);
+            return nullptr;
+        }
+        FUZZ_TRACE(2, "Module cache hit: " << key);
+        return it->second.module;
+    }
+
+    void storeCachedModule(const std::string &key, std::shared_ptr<torch::nn::Module> module)
+    {
+        auto &cache = moduleCache();
+        if (cache.size() >= FUZZ_MODULE_CACHE_SIZE)
+            cache.clear();
+        CachedModule entry;
+        {
+            torch::NoGradGuard no_grad;
+            for (const auto &parameter : definedTensors(module->parameters()))
+            {
+                entry.parameters.push_back(parameter.detach().clone());
+                entry.requires_grad.push_back(parameter.requires_grad());
+            }
+            for (const auto &buffer : definedTensors(module->buffers()))
+                entry.buffers.push_back(buffer.detach().clone());
+        }
+        entry.module = std::move(module);
+        cache[key] = std::move(entry);
+    }
+
     // --- Tensor Parsing Implementation ---
 
     torch::ScalarType parseDataType(uint8_t selector)
     {
         size_t index = selector % supported_types.size();
-#ifdef DEBUG_FUZZ
-        std::cout << "Data type selector: " << static_cast<int>(selector) << ", index: " << index << ", type: " << c10::toString(supported_types[index]) << std::endl;
-#endif
+        FUZZ_TRACE(2, "Data type selector: " << static_cast<int>(selector) << ", index: " << index << ", type: " << c10::toString(supported_types[index]));
         return supported_types[index];
     }
 
@@ -141,9 +1217,7 @@ namespace fuzzer_utils
     {
         constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
         uint8_t rank = byte % range + MIN_RANK;
-#ifdef DEBUG_FUZZ
-        std::cout << "Rank byte: " << static_cast<int>(byte) << ", rank: " << static_cast<int>(rank) << std::endl;
-#endif
+        FUZZ_TRACE(2, "Rank byte: " << static_cast<int>(byte) << ", rank: " << static_cast<int>(rank));
         return rank;
     }
 
@@ -155,9 +1229,7 @@ namespace fuzzer_utils
         }
         if (rank == 0)
         {
-#ifdef DEBUG_FUZZ
-            std::cout << "Parsing shape for rank 0 tensor." << std::endl;
-#endif
+            FUZZ_TRACE(2, "Parsing shape for rank 0 tensor.");
             return {}; // Scalar tensor has empty shape
         }
 
@@ -165,10 +1237,7 @@ namespace fuzzer_utils
         shape.reserve(rank);
         const size_t bytes_needed_per_dim = sizeof(int64_t); // Using 8 bytes per dimension
 
-#ifdef DEBUG_FUZZ
-        std::cout << "Parsing shape for rank " << static_cast<int>(rank) << ", need " << rank * bytes_needed_per_dim << " bytes for dims." << std::endl;
-        std::cout << "Current offset: " << offset << ", total size: " << size << std::endl;
-#endif
+        FUZZ_TRACE(2, "Parsing shape for rank " << static_cast<int>(rank) << ", need " << rank * bytes_needed_per_dim << " bytes for dims. Current offset: " << offset << ", total size: " << size);
 
         for (uint8_t i = 0; i < rank; ++i)
         {
@@ -183,30 +1252,19 @@ namespace fuzzer_utils
                 uint64_t dim_abs = static_cast<uint64_t>(std::abs(dim_raw));
                 int64_t dim = MIN_TENSOR_SHAPE_DIMS + static_cast<int64_t>(dim_abs % (MAX_TENSOR_SHAPE_DIMS - MIN_TENSOR_SHAPE_DIMS + 1));
                 shape.push_back(dim);
-#ifdef DEBUG_FUZZ
-                std::cout << "  Dim " << static_cast<int>(i) << ": raw=" << dim_raw << ", abs=" << dim_abs << ", parsed=" << dim << std::endl;
-#endif
+                FUZZ_TRACE(2, "  Dim " << static_cast<int>(i) << ": raw=" << dim_raw << ", abs=" << dim_abs << ", parsed=" << dim);
             }
             else
             {
                 // Not enough data, default to minimum dimension
                 shape.push_back(MIN_TENSOR_SHAPE_DIMS);
-#ifdef DEBUG_FUZZ
-                std::cout << "  Dim " << static_cast<int>(i) << ": Not enough data, defaulting to " << MIN_TENSOR_SHAPE_DIMS << std::endl;
-#endif
+                FUZZ_TRACE(2, "  Dim " << static_cast<int>(i) << ": Not enough data, defaulting to " << MIN_TENSOR_SHAPE_DIMS);
                 // Update offset to prevent infinite loops if size is small but non-zero
                 offset = size;
             }
         }
 
-#ifdef DEBUG_FUZZ
-        std::cout << "Parsed Shape: [";
-        for (size_t i = 0; i < shape.size(); ++i)
-        {
-            std::cout << shape[i] << (i == shape.size() - 1 ? "" : ", ");
-        }
-        std::cout << "], New offset: " << offset << std::endl;
-#endif
+        FUZZ_TRACE(2, "Parsed Shape: " << c10::IntArrayRef(shape) << ", New offset: " << offset);
         return shape;
     }
 
@@ -226,12 +1284,10 @@ namespace fuzzer_utils
         size_t bytesAvailable = (offset < size) ? (size - offset) : 0;
         size_t bytesToCopy = std::min(totalBytesNeeded, bytesAvailable);
 
-#ifdef DEBUG_FUZZ
-        std::cout << "Parsing Tensor Data: numElements=" << numElements
-                  << ", dtypeSize=" << dtypeSize << ", totalBytesNeeded=" << totalBytesNeeded
-                  << ", offset=" << offset << ", size=" << size
-                  << ", bytesAvailable=" << bytesAvailable << ", bytesToCopy=" << bytesToCopy << std::endl;
-#endif
+        FUZZ_TRACE(2, "Parsing Tensor Data: numElements=" << numElements
+                          << ", dtypeSize=" << dtypeSize << ", totalBytesNeeded=" << totalBytesNeeded
+                          << ", offset=" << offset << ", size=" << size
+                          << ", bytesAvailable=" << bytesAvailable << ", bytesToCopy=" << bytesToCopy);
 
         if (bytesToCopy > 0)
         {
@@ -239,205 +1295,386 @@ namespace fuzzer_utils
         }
         offset += bytesToCopy; // Advance offset by the number of bytes actually consumed
 
-#ifdef DEBUG_FUZZ
-        std::cout << "Finished parsing tensor data. New offset: " << offset << std::endl;
-#endif
+        FUZZ_TRACE(2, "Finished parsing tensor data. New offset: " << offset);
 
         return tensorData;
     }
 
     torch::Tensor createTensor(const uint8_t *Data, size_t Size, size_t &offset)
     {
-        // Need at least 1 byte for dtype and 1 byte for rank.
-        const size_t min_required_size = 2;
-        if (Size < offset + min_required_size)
+        const TensorMeta meta = parseTensorMeta(Data, Size, offset);
+        auto options = torch::TensorOptions().dtype(meta.dtype);
+
+// Conditional compilation for random vs input-based tensor data
+#if USE_RANDOM_TENSOR
+        FUZZ_TRACE(2, "Generating random tensor...");
+        return torch::rand(meta.shape, options);
+#else
+        // 6. Allocate once and copy the fuzzer bytes straight into the storage,
+        // after the zeroed elements a storage offset skips. Elements past the
+        // end of the input are zero, as before.
+        torch::Tensor physical = allocatePhysical(meta, options);
+        const size_t physicalBytes = physical.nbytes();
+        const size_t leadBytes = static_cast<size_t>(meta.extra) * c10::elementSize(meta.dtype);
+        const size_t bytesAvailable = (offset < Size) ? (Size - offset) : 0;
+        const size_t bytesToCopy = std::min(meta.nbytes, bytesAvailable);
+        auto *dst = static_cast<uint8_t *>(physical.data_ptr());
+        if (leadBytes > 0)
         {
-            throw std::runtime_error("Input data too small for basic tensor metadata (dtype, rank). Offset: " + std::to_string(offset) + ", Size: " + std::to_string(Size));
+            std::memset(dst, 0, leadBytes);
+        }
+        if (bytesToCopy > 0)
+        {
+            std::memcpy(dst + leadBytes, Data + offset, bytesToCopy);
         }
+        if (physicalBytes > leadBytes + bytesToCopy)
+        {
+            std::memset(dst + leadBytes + bytesToCopy, 0, physicalBytes - leadBytes - bytesToCopy);
+        }
+        offset += bytesToCopy;
+        torch::Tensor tensor = applyLayout(meta, physical);
 
-#ifdef DEBUG_FUZZ
-        std::cout << "\n--- Creating Tensor ---" << std::endl;
-        std::cout << "Initial offset: " << offset << ", Size: " << Size << std::endl;
-#endif
+        FUZZ_TRACE(2, "--- Finished Creating Tensor --- Copied " << bytesToCopy << " of " << meta.nbytes << " bytes. Final offset: " << offset
+                          << ", Tensor details: " << tensor.sizes() << ", dtype=" << tensor.dtype() << ", is_contiguous=" << tensor.is_contiguous());
+        return tensor;
+#endif // USE_RANDOM_TENSOR
+    }
 
-        // 1. Parse Data Type
-        const uint8_t dtype_selector = Data[offset++];
-        const auto dtype = parseDataType(dtype_selector);
-        const size_t dtypeSize = c10::elementSize(dtype); // Use c10::elementsize for robustness
+    torch::Tensor createTensorView(const uint8_t *Data, size_t Size, size_t &offset)
+    {
+        const size_t start = offset;
+        const TensorMeta meta = parseTensorMeta(Data, Size, offset);
 
-        if (dtypeSize == 0 && dtype != torch::kBool)
-        { // kBool size is 1 byte in memory typically
-          // Potentially handle error or default for unknown/unsupported size 0 types if any exist beyond theoretical
-          // For now, let it proceed, but be aware. torch::from_blob might handle it.
-          // #ifdef DEBUG_FUZZ
-          //             std::cout << "Warning: dtype " << c10::elementSize(dtype); << " has element size 0." << std::endl;
-          // #endif
+#if !USE_RANDOM_TENSOR
+        const size_t bytesAvailable = (offset < Size) ? (Size - offset) : 0;
+        const size_t alignment = c10::elementSize(meta.dtype);
+        const bool aligned = reinterpret_cast<uintptr_t>(Data + offset) % alignment == 0;
+        // Layouts that are plain views of the data bytes can borrow too. A
+        // storage offset needs zeroed elements ahead of the data, so it copies.
+        const bool borrowable = meta.layout == TensorLayout::Contiguous || meta.layout == TensorLayout::Transposed ||
+                                meta.layout == TensorLayout::Broadcast;
+        if (meta.nbytes > 0 && meta.nbytes <= bytesAvailable && aligned && borrowable)
+        {
+            // The view aliases the fuzzer input: it must not be written to and
+            // must not outlive the current LLVMFuzzerTestOneInput call.
+            auto options = torch::TensorOptions().dtype(meta.dtype);
+            torch::Tensor view = applyLayout(meta, torch::from_blob(const_cast<uint8_t *>(Data + offset), physicalShape(meta), options));
+            offset += meta.nbytes;
+            FUZZ_TRACE(2, "Borrowed " << meta.nbytes << " input bytes as tensor view. Final offset: " << offset);
+            return view;
         }
+#endif
+        // Not enough bytes or misaligned: fall back to an owning copy, which
+        // consumes the input the same way.
+        offset = start;
+        return createTensor(Data, Size, offset);
+    }
 
-        // 2. Parse Rank
-        const uint8_t rank_byte = Data[offset++];
-        const uint8_t rank = parseRank(rank_byte);
+    torch::Tensor createQuantizedTensor(const uint8_t *Data, size_t Size, size_t &offset)
+    {
+        return createQuantizedTensor(Data, Size, offset, parseQuantizedType(readByte(Data, Size, offset)));
+    }
 
-        // 3. Parse Shape
-        // parseShape updates the offset internally
-        auto shape = parseShape(Data, offset, Size, rank);
+    torch::Tensor createQuantizedTensor(const uint8_t *Data, size_t Size, size_t &offset, torch::ScalarType qtype)
+    {
+        const std::vector<int64_t> shape = parseQuantizedShape(Data, Size, offset);
+        return createPerTensorQuantized(shape, qtype, Data, Size, offset);
+    }
 
-        // 4. Compute Number of Elements
-        int64_t numElements = 1;
-        bool shape_is_valid = true;
-        if (rank > 0 && shape.empty())
-        {
-            // This case shouldn't happen if parseShape respects rank, but as a safeguard
-            shape_is_valid = false;
-#ifdef DEBUG_FUZZ
-            std::cout << "Error: Rank > 0 but shape is empty after parsing." << std::endl;
-#endif
+    torch::Tensor createPerChannelQuantizedTensor(const uint8_t *Data, size_t Size, size_t &offset)
+    {
+        return createPerChannelQuantizedTensor(Data, Size, offset, parseQuantizedType(readByte(Data, Size, offset)));
+    }
+
+    torch::Tensor createPerChannelQuantizedTensor(const uint8_t *Data, size_t Size, size_t &offset, torch::ScalarType qtype)
+    {
+        const std::vector<int64_t> shape = parseQuantizedShape(Data, Size, offset);
+        if (shape.empty())
+            return createPerTensorQuantized(shape, qtype, Data, Size, offset);
+        const int64_t axis = readByte(Data, Size, offset) % static_cast<int64_t>(shape.size());
+        const int64_t channels = shape[axis];
+        torch::Tensor scales = torch::empty({channels}, torch::kDouble);
+        torch::Tensor zero_points = torch::empty({channels}, torch::kLong);
+        for (int64_t c = 0; c < channels; ++c)
+        {
+            scales.data_ptr<double>()[c] = parseScale(Data, Size, offset);
+            zero_points.data_ptr<int64_t>()[c] = parseZeroPoint(Data, Size, offset, qtype);
         }
-        for (const auto &dim : shape)
+        FUZZ_TRACE(2, "createPerChannelQuantizedTensor " << c10::toString(qtype) << " axis=" << axis << " channels=" << channels);
+        torch::Tensor tensor = at::_empty_per_channel_affine_quantized(
+            shape, scales, zero_points, axis, torch::TensorOptions().dtype(qtype));
+        fillQuantized(tensor, Data, Size, offset);
+        return tensor;
+    }
+
+    MatrixKind parseMatrixKind(uint8_t byte)
+    {
+        return static_cast<MatrixKind>(byte % 6);
+    }
+
+    torch::Tensor createMatrix(const uint8_t *Data, size_t Size, size_t &offset, MatrixKind kind)
+    {
+        static const torch::ScalarType dtypes[] = {torch::kFloat, torch::kDouble, torch::kComplexFloat, torch::kComplexDouble};
+        auto nextByte = [&]() -> uint8_t
+        { return offset < Size ? Data[offset++] : 0; };
+        const torch::ScalarType dtype = dtypes[nextByte() % 4];
+        const int64_t n = 1 + nextByte() % MAX_MATRIX_DIM;
+        const uint8_t batch_byte = nextByte();
+        std::vector<int64_t> shape;
+        for (int i = 0; i < batch_byte % 3; ++i)
+            shape.push_back(1 + (batch_byte >> (2 + 2 * i)) % 3);
+        int64_t batch = 1;
+        for (int64_t d : shape)
+            batch *= d;
+        shape.push_back(n);
+        shape.push_back(n);
+        const uint8_t param = nextByte();
+        const bool is_complex = c10::isComplexType(dtype);
+        FUZZ_TRACE(2, "createMatrix kind=" << static_cast<int>(kind) << " n=" << n << " batch=" << batch << " dtype=" << c10::toString(dtype));
+
+#if FUZZ_STRUCTURED_MATRICES
+        SeedReader seed{Data, Size, offset, is_complex};
+        torch::Tensor matrix = torch::empty(shape, is_complex ? torch::kComplexDouble : torch::kDouble);
+        for (int64_t b = 0; b < batch; ++b)
         {
-            if (dim < 0)
-            { // Dimensions must be non-negative
-                shape_is_valid = false;
-#ifdef DEBUG_FUZZ
-                std::cout << "Error: Invalid negative dimension " << dim << " in shape." << std::endl;
-#endif
-                break;
+            const std::vector<Complex> a = structuredMatrix(kind, n, param, seed);
+            if (is_complex)
+            {
+                auto *dst = matrix.data_ptr<c10::complex<double>>() + b * n * n;
+                for (int64_t i = 0; i < n * n; ++i)
+                    dst[i] = c10::complex<double>(a[i].real(), a[i].imag());
             }
-            // Check for potential overflow when calculating numElements
-            if (dim > 0 && numElements > std::numeric_limits<int64_t>::max() / dim)
+            else
             {
-                shape_is_valid = false;
-#ifdef DEBUG_FUZZ
-                std::cout << "Error: Potential overflow calculating number of elements." << std::endl;
-#endif
-                break; // Avoid overflow
+                double *dst = matrix.data_ptr<double>() + b * n * n;
+                for (int64_t i = 0; i < n * n; ++i)
+                    dst[i] = a[i].real();
             }
-            numElements *= dim;
         }
+        return matrix.to(dtype);
+#else
+        // Unstructured baseline: the raw input bytes, like createTensor.
+        (void)kind;
+        (void)param;
+        (void)is_complex;
+        torch::Tensor matrix = torch::empty(shape, dtype);
+        const size_t nbytes = matrix.nbytes();
+        const size_t bytesToCopy = std::min(nbytes, offset < Size ? Size - offset : 0);
+        auto *dst = static_cast<uint8_t *>(matrix.data_ptr());
+        if (bytesToCopy > 0)
+            std::memcpy(dst, Data + offset, bytesToCopy);
+        std::memset(dst + bytesToCopy, 0, nbytes - bytesToCopy);
+        offset += bytesToCopy;
+        return matrix;
+#endif
+    }
 
-        if (!shape_is_valid)
+    torch::Tensor createMatrix(const uint8_t *Data, size_t Size, size_t &offset)
+    {
+        const uint8_t kind = offset < Size ? Data[offset++] : 0;
+        return createMatrix(Data, Size, offset, parseMatrixKind(kind));
+    }
+
+    // --- Comparison (Optional) ---
+    CompareResult compareTensors(const torch::Tensor &t1, const torch::Tensor &t2, const uint8_t *data, size_t size, double rtol, double atol)
+    {
+        CompareResult result;
+        result.shape_match = t1.sizes() == t2.sizes();
+        result.dtype_match = t1.scalar_type() == t2.scalar_type();
+
+        if (result.shape_match && t1.numel() > 0)
         {
-            // Handle invalid shape - perhaps create a default small tensor or throw?
-            // Throwing is safer for fuzzing as it signals a clear parsing issue.
-            throw std::runtime_error("Parsed shape is invalid (negative dimension or overflow).");
+            torch::Tensor a = comparable(t1);
+            torch::Tensor b = comparable(t2);
+            if (!result.dtype_match || a.scalar_type() != b.scalar_type())
+            {
+                // Only differing dtypes are converted, to the type both promote to.
+                const auto common = at::promote_types(a.scalar_type(), b.scalar_type());
+                a = a.to(common);
+                b = b.to(common);
+            }
+            ErrorAccumulator acc{result, rtol, atol};
+            AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND3(
+                at::ScalarType::Half, at::ScalarType::BFloat16, at::ScalarType::Bool, a.scalar_type(), "compareTensors",
+                [&]
+                { compareElements(a.data_ptr<scalar_t>(), b.data_ptr<scalar_t>(), a.numel(), acc); });
         }
 
-#ifdef DEBUG_FUZZ
-        std::cout << "Calculated numElements: " << numElements << std::endl;
-#endif
+        if (result.ok())
+            return result;
 
-// Conditional compilation for random vs input-based tensor data
-#if USE_RANDOM_TENSOR
-#ifdef DEBUG_FUZZ
-        std::cout << "Generating random tensor..." << std::endl;
-#endif
-        // Generate a random tensor
-        // Ensure options specify the correct dtype
-        auto options = torch::TensorOptions().dtype(dtype);
-        return torch::rand(shape, options);
-#else
-        // 5. Parse Tensor Data
-        auto inputBytes = parseTensorData(Data, offset, Size, numElements, dtypeSize);
-
-        // 6. Create Tensor from Blob
-        // Note: torch::from_blob requires a non-const pointer to data it does *not* own.
-        // Cloning is essential to make PyTorch manage the memory.
-        // Handle the edge case of a 0-element tensor correctly.
-        torch::Tensor tensor;
-        if (numElements == 0)
-        {
-            // Create an empty tensor with the correct shape and dtype
-            auto options = torch::TensorOptions().dtype(dtype);
-            // Using empty is generally preferred for creating tensors with shape but no data/storage
-            tensor = torch::empty(shape, options);
-#ifdef DEBUG_FUZZ
-            std::cout << "Created empty tensor for numElements=0." << std::endl;
-#endif
+        std::ostringstream summary;
+        if (!result.shape_match)
+            summary << "shape " << t1.sizes() << " vs " << t2.sizes();
+        else
+        {
+            if (!result.dtype_match)
+                summary << "dtype " << t1.dtype() << " vs " << t2.dtype() << ", ";
+            summary << result.mismatches << "/" << t1.numel() << " mismatched (" << result.nan_mismatches
+                    << " NaN pattern), max abs " << result.max_abs_error << ", max rel " << result.max_rel_error
+                    << ", max ulp " << result.max_ulp_error;
         }
-        else if (inputBytes.empty() && numElements > 0)
+        storeMismatch(data, size, "Tensor mismatch: " + summary.str());
+        return result;
+    }
+
+    bool gradCheck(const DifferentiableFn &fn, const std::vector<torch::Tensor> &inputs, const uint8_t *data, size_t size)
+    {
+#if FUZZ_GRADCHECK
+        if (c10::InferenceMode::is_enabled())
         {
-            // This might happen if parseTensorData couldn't read any bytes (e.g., offset >= Size)
-            // Decide on behavior: throw, or create an uninitialized tensor?
-            // Creating uninitialized might hide bugs, throwing is safer.
-            // However, maybe the API call itself handles uninitialized data? For now, let's try creating it.
-            auto options = torch::TensorOptions().dtype(dtype);
-            tensor = torch::empty(shape, options); // Creates tensor with undefined data
-#ifdef DEBUG_FUZZ
-            std::cout << "Warning: Creating tensor with uninitialized data (inputBytes empty, numElements > 0)." << std::endl;
-#endif
-            // Alternatively, throw:
-            // throw std::runtime_error("Not enough data to populate tensor elements.");
+            // No autograd graph is recorded, so there is no gradient to check.
+            static std::atomic<bool> warned{false};
+            if (!warned.exchange(true))
+                std::cerr << "fuzzer_utils: gradCheck skipped under InferenceMode; define FUZZ_AUTOGRAD in the harness"
+                          << std::endl;
+            return true;
         }
-        else
+        gradchecks_run.fetch_add(1, std::memory_order_relaxed);
+        bool ok = true;
+        try
         {
-            // Ensure the size of inputBytes matches expected size. If not, it implies parseTensorData hit EOF.
-            // from_blob doesn't care if the data is partial, but downstream usage will likely fail.
-            // The clone after from_blob makes a copy, potentially copying only partial data if inputBytes is short.
-            auto options = torch::TensorOptions().dtype(dtype);
-            // We pass inputBytes.data(), which points to the vector's buffer.
-            // The lifetime of inputBytes must exceed the from_blob call. Cloning makes this safe.
-            tensor = torch::from_blob(inputBytes.data(), shape, options).clone();
-#ifdef DEBUG_FUZZ
-            std::cout << "Created tensor from blob and cloned." << std::endl;
-#endif
+            ok = runGradCheck(fn, inputs, data, size);
         }
-
-#ifdef DEBUG_FUZZ
-        std::cout << "--- Finished Creating Tensor ---" << std::endl;
-        std::cout << "Final offset: " << offset << std::endl;
-        std::cout << "Tensor details: " << tensor.sizes() << ", dtype=" << tensor.dtype() << ", is_contiguous=" << tensor.is_contiguous() << std::endl;
+        catch (const std::exception &)
+        {
+            // fn rejected the double-precision or perturbed inputs; there is nothing to compare.
+        }
+        if (!ok)
+            gradchecks_failed.fetch_add(1, std::memory_order_relaxed);
+        return ok;
+#else
+        (void)fn;
+        (void)inputs;
+        (void)data;
+        (void)size;
+        return true;
 #endif
-        return tensor;
-#endif // USE_RANDOM_TENSOR
     }
 
-    // --- Comparison (Optional) ---
-    void compareTensors(const torch::Tensor &t1, const torch::Tensor &t2, const uint8_t *data, size_t size, double rtol, double atol)
+    // --- Entry Point Implementation ---
+
+    int runInput(int (*harness)(const uint8_t *, size_t), const uint8_t *Data, size_t Size,
+                 bool uses_autograd)
     {
-        // Check if shapes match
-        if (t1.sizes() != t2.sizes())
+        struct InputScope
         {
-            std::cerr << "Shape mismatch: " << t1.sizes() << " vs " << t2.sizes() << std::endl;
+            ~InputScope() { endInput(); }
+        } input_scope;
+        int result = 0;
+        if (uses_autograd)
+        {
+            result = harness(Data, Size);
         }
-
-        // Check if data types match
-        if (t1.dtype() != t2.dtype())
+        else
         {
-            std::cerr << "Dtype mismatch: " << t1.dtype() << " vs " << t2.dtype() << std::endl;
+            c10::InferenceMode inference_mode;
+            result = harness(Data, Size);
         }
+        inputs_run.fetch_add(1, std::memory_order_relaxed);
+        if (result != 0)
+            inputs_rejected.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+} // namespace fuzzer_utils
 
-        bool is_close = torch::allclose(t1, t2, rtol, atol);
+namespace
+{
+    class SilentWarningHandler : public c10::WarningHandler
+    {
+    public:
+        void process(const c10::Warning &) override {}
+    };
 
-        if (!is_close)
+    // libFuzzer runs the input files named on its command line once each
+    // (e.g. `./fuzz crash.bin`), so a warm-up run would only run a harness
+    // twice before it reproduces a crash.
+    bool hasInputFiles(int argc, char **argv)
+    {
+        for (int i = 1; i < argc; ++i)
         {
-            // Find max absolute difference
-            auto abs_diff = torch::abs(t1 - t2);
-            auto max_diff = torch::max(abs_diff).item<float>();
-            auto max_val = std::max(torch::max(torch::abs(t1)).item<float>(),
-                                    torch::max(torch::abs(t2)).item<float>());
+            std::error_code ec;
+            if (argv[i][0] != '-' && std::filesystem::is_regular_file(argv[i], ec))
+                return true;
+        }
+        return false;
+    }
 
-            std::cerr << "Max difference: " << max_diff << " (relative to max value: "
-                      << (max_val > 0 ? max_diff / max_val : max_diff) << ")" << std::endl;
+    // Build-time default, overridden by the environment variable `name`.
+    long long envOr(const char *name, long long value)
+    {
+        const char *env = std::getenv(name);
+        return env && env[0] ? std::atoll(env) : value;
+    }
+} // namespace
 
-            // Save the input data that caused the discrepancy
-            std::string timestamp = sanitizedTimestamp();
+// --- Fuzzer Entry Points ---
+// Defined by every harness. With -Wl,--wrap=LLVMFuzzerTestOneInput the linker
+// binds the harness's definition to __real_LLVMFuzzerTestOneInput and every
+// call, libFuzzer's and the warm-up's, to __wrap_LLVMFuzzerTestOneInput.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size);
+extern "C" int __real_LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size);
 
-            // Ensure directory exists
-            (void)ensure_log_directory_exists("diff_inputs");
+// Overridden by harnesses built with FUZZ_AUTOGRAD (see fuzzer_utils.h).
+extern "C" __attribute__((weak)) bool fuzzerUtilsHarnessUsesAutograd()
+{
+    return false;
+}
 
-            // Save the raw input data to a binary file
-            std::string bin_filename = "diff_inputs/input_" + timestamp + ".bin";
-            std::ofstream bin_file(bin_filename, std::ios::binary);
-            if (bin_file)
-            {
-                bin_file.write(reinterpret_cast<const char *>(data), size);
-                bin_file.close();
-                std::cerr << "Saved input data to: " << bin_filename << std::endl;
-            }
-            else
-            {
-                std::cerr << "Failed to save input data to file" << std::endl;
-            }
+extern "C" int __wrap_LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
+{
+    return fuzzer_utils::runInput(__real_LLVMFuzzerTestOneInput, Data, Size, fuzzerUtilsHarnessUsesAutograd());
+}
+
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    at::set_num_threads(FUZZ_NUM_THREADS);
+    try
+    {
+        at::set_num_interop_threads(FUZZ_NUM_INTEROP_THREADS);
+    }
+    catch (const std::exception &)
+    {
+        // Already fixed by an earlier parallel call; keep its size.
+    }
+    const long long seed = envOr("FUZZ_SEED", FUZZ_SEED);
+    if (seed >= 0)
+        at::manual_seed(static_cast<uint64_t>(seed));
+    if (envOr("FUZZ_SILENT_WARNINGS", FUZZ_SILENT_WARNINGS) != 0)
+    {
+        static SilentWarningHandler silent_warnings;
+        c10::WarningUtils::set_warning_handler(&silent_warnings);
+    }
+    const char *input_stats = std::getenv("FUZZ_INPUT_STATS");
+    if (input_stats && input_stats[0] == '1')
+        std::atexit(printInputStats);
+
+#if FUZZ_WARMUP
+    if (envOr("FUZZ_WARMUP", 1) != 0 && !hasInputFiles(*argc, *argv))
+    {
+        // libFuzzer installs its crash handlers after LLVMFuzzerInitialize,
+        // so corpus seeds are left to libFuzzer, where a crash still leaves
+        // an artifact.
+        const std::vector<uint8_t> input(256, 0);
+        try
+        {
+            LLVMFuzzerTestOneInput(input.data(), input.size());
         }
+        catch (const std::exception &e)
+        {
+            std::fprintf(stderr, "fuzzer_utils: warm-up input threw: %s\n", e.what());
+        }
+        // Keep warm-up traffic out of the per-exec numbers.
+        inputs_run = 0;
+        inputs_rejected = 0;
+        gradchecks_run = 0;
+        gradchecks_failed = 0;
+        PoolState &state = poolState();
+        std::lock_guard<std::mutex> lock(state.mu);
+        state.stats.execs = 0;
+        state.stats.allocations = 0;
+        state.stats.pool_hits = 0;
     }
-} // namespace fuzzer_utils
+#endif
+    return 0;
+}
@@ -0,0 +1,66 @@
+#!/bin/bash
+# Usage: bash fuzz.sh <operator id>   e.g. bash fuzz.sh aten::add.Tensor
+# One binary serves every operator; corpus, artifacts and log are kept per operator.
+# FUZZ_LIST_OPS=1 ./fuzz lists the operators that can be fuzzed.
+
+JOBS=1
+WORKERS=2
+MAX_LEN=128
+RSS_LIMIT=2048
+TIME_BUDGET="${TIME_BUDGET:-180}"
+
+export FUZZ_OP="${1:-$FUZZ_OP}"
+if [ -z "$FUZZ_OP" ]; then
+  echo "Usage: bash fuzz.sh <operator id, e.g. aten::add.Tensor>"
+  exit 1
+fi
+
+if [ ! -f "fuzz" ]; then
+  echo "Error: Fuzzer executable not found!" 
+  exit 1
+fi
+
+OP_DIR="${FUZZ_OP//::/.}"
+CORPUS="corpora/$OP_DIR"
+ARTIFACTS="artifacts/$OP_DIR"
+mkdir -p "$CORPUS" "$ARTIFACTS"
+if [ -z "$(ls -A "$CORPUS")" ]; then
+  python3 random_seed.py > /dev/null
+  cp corpus/seed*.bin "$CORPUS"/
+fi
+
+LOG="fuzz-$OP_DIR.log"
+exec > >(stdbuf -oL -eL tee -a "$LOG") 2>&1
+
+
+export OMP_NUM_THREADS=1
+export MKL_NUM_THREADS=1
+export OPENBLAS_NUM_THREADS=1
+export BLIS_NUM_THREADS=1
+
+export KMP_BLOCKTIME=0
+export OMP_WAIT_POLICY=PASSIVE
+export PYTORCH_JIT=0    
+export ASAN_OPTIONS=detect_leaks=0           # skip LSan
+export UBSAN_OPTIONS=print_stacktrace=0
+
+./fuzz "./$CORPUS" \
+  -jobs=$JOBS \
+  -workers=$WORKERS \
+  -max_len=$MAX_LEN \
+  -prefer_small=0 \
+  -rss_limit_mb=$RSS_LIMIT \
+  -use_value_profile=1 \
+  -mutate_depth=8 \
+  -entropic=1 \
+  -use_counters=1 \
+  -timeout=2 \
+  -ignore_crashes=1 \
+  -reduce_inputs=0 \
+  -len_control=0 \
+  -prefer_small=1 \
+  -max_total_time=$TIME_BUDGET \
+  -print_final_stats=1 \
+  -artifact_prefix="./$ARTIFACTS/"
+
+echo "Fuzzing completed."
@@ -0,0 +1,329 @@
+
+#ifndef FUZZER_UTILS_H
+#define FUZZER_UTILS_H
+
+#include <torch/torch.h>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <sstream>
+#include <iomanip>
+#include <memory>
+#include <functional>
+
+// Macro definitions (Consider moving to CMake/build system defines if possible)
+#define MIN_RANK 0
+#define MAX_RANK 4
+#define MAX_TENSOR_SHAPE_DIMS 16
+#define MIN_TENSOR_SHAPE_DIMS 0
+#define MAX_MATRIX_DIM 16
+// Define USE_RANDOM_TENSOR and USE_GPU via build system flags (e.g., -DUSE_RANDOM_TENSOR=1)
+// #define USE_RANDOM_TENSOR 0 // Default to input-based
+// #define USE_GPU 0           // Default to CPU
+
+// With -DFUZZ_TENSOR_LAYOUTS=1, createTensor and createTensorView read one
+// layout byte after the shape and return the tensor as a transposed,
+// step-sliced, broadcast (expanded), storage-offset (as_strided) or
+// channels_last tensor, or contiguous, so ops see both their contiguous fast
+// paths and their strided TensorIterator paths. The layout byte changes the
+// input format, so existing corpora only parse as before with the default 0;
+// start a fresh corpus for a layout build.
+#ifndef FUZZ_TENSOR_LAYOUTS
+#define FUZZ_TENSOR_LAYOUTS 0
+#endif
+
+// createMatrix builds matrices with a known structure (SPD, invertible,
+// orthogonal, ...) from a few seed bytes. Build with
+// -DFUZZ_STRUCTURED_MATRICES=0 to fill the same matrices with raw input bytes
+// instead, e.g. to compare the share of inputs a linalg harness rejects.
+#ifndef FUZZ_STRUCTURED_MATRICES
+#define FUZZ_STRUCTURED_MATRICES 1
+#endif
+
+// Tracing (e.g. -DFUZZ_TRACE_LEVEL=2 -DFUZZ_TRACE_RING=1 via EXTRA_CXXFLAGS).
+// FUZZ_TRACE(level, ...) statements above FUZZ_TRACE_LEVEL are compiled out:
+// 0 = off, 1 = one line per input, 2 = tensor parsing details.
+#ifndef FUZZ_TRACE_LEVEL
+#define FUZZ_TRACE_LEVEL 0
+#endif
+// With FUZZ_TRACE_RING=1, traced lines are kept in an in-memory ring of the
+// last FUZZ_TRACE_RING_SIZE lines instead of going to stdout. The ring is
+// written to stderr only when the process crashes, or when an input runs
+// longer than $FUZZ_TRACE_TIMEOUT seconds (default 2, fuzz.sh's -timeout).
+#ifndef FUZZ_TRACE_RING
+#define FUZZ_TRACE_RING 0
+#endif
+#ifndef FUZZ_TRACE_RING_SIZE
+#define FUZZ_TRACE_RING_SIZE 256
+#endif
+
+#define FUZZ_TRACE(level, ...)                                     \
+    do                                                             \
+    {                                                              \
+        if constexpr ((level) <= FUZZ_TRACE_LEVEL)                 \
+        {                                                          \
+            std::ostringstream fuzz_trace_stream_;                 \
+            fuzz_trace_stream_ << __VA_ARGS__;                     \
+            fuzzer_utils::traceMessage(fuzz_trace_stream_.str());  \
+        }                                                          \
+    } while (0)
+
+// Marks the start of an input in place of the per-exec "Start Fuzzing" print.
+#if FUZZ_TRACE_LEVEL > 0 || FUZZ_TRACE_RING
+#define FUZZ_TRACE_INPUT() fuzzer_utils::traceInput()
+#else
+#define FUZZ_TRACE_INPUT() \
+    do                     \
+    {                      \
+    } while (0)
+#endif
+
+// Serve CPU tensor storage from power-of-two size-class caches installed with
+// c10::SetAllocator, recycled across inputs. Cached bytes above
+// FUZZ_POOL_CACHE_MB go back to the system at the end of an input. Off under
+// ASan, which needs freed storage to reach its own allocator.
+#ifndef FUZZ_POOLING_ALLOCATOR
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define FUZZ_POOLING_ALLOCATOR 0
+#endif
+#endif
+#endif
+#ifndef FUZZ_POOLING_ALLOCATOR
+#define FUZZ_POOLING_ALLOCATOR 1
+#endif
+#ifndef FUZZ_POOL_CACHE_MB
+#define FUZZ_POOL_CACHE_MB 256
+#endif
+
+// LLVMFuzzerInitialize pins the ATen thread pools to these sizes and, unless
+// FUZZ_WARMUP is 0, runs the harness once on a built-in zeroed input so
+// kernel registration, dispatcher tables and allocator caches are warm before
+// fuzzing starts. There is no warm-up when libFuzzer is given input files to
+// run, and an exception escaping the warm-up run is printed. It also seeds
+// the default generator with FUZZ_SEED (-1 leaves it unseeded) and, with
+// FUZZ_SILENT_WARNINGS, drops TORCH_WARN output. FUZZ_WARMUP, FUZZ_SEED and
+// FUZZ_SILENT_WARNINGS can also be set in the environment.
+#ifndef FUZZ_NUM_THREADS
+#define FUZZ_NUM_THREADS 1
+#endif
+#ifndef FUZZ_NUM_INTEROP_THREADS
+#define FUZZ_NUM_INTEROP_THREADS 1
+#endif
+#ifndef FUZZ_WARMUP
+#define FUZZ_WARMUP 1
+#endif
+#ifndef FUZZ_SEED
+#define FUZZ_SEED 0
+#endif
+#ifndef FUZZ_SILENT_WARNINGS
+#define FUZZ_SILENT_WARNINGS 1
+#endif
+
+// nn.Module instances are cached by constructor configuration (see
+// fuzzer_utils::cachedModule). Build with -DFUZZ_MODULE_CACHE=0 to construct
+// a fresh module for every input instead.
+#ifndef FUZZ_MODULE_CACHE
+#define FUZZ_MODULE_CACHE 1
+#endif
+// Number of configurations kept alive before the cache is flushed.
+#ifndef FUZZ_MODULE_CACHE_SIZE
+#define FUZZ_MODULE_CACHE_SIZE 16
+#endif
+
+// fuzzer_utils::gradCheck compares autograd gradients against central finite
+// differences along FUZZ_GRADCHECK_SAMPLES random directions per input, each
+// touching at most FUZZ_GRADCHECK_MAX_ELEMENTS input elements, so the cost is a
+// few extra forward passes rather than one per Jacobian column. Build with
+// -DFUZZ_GRADCHECK=0 to turn the check into a no-op.
+#ifndef FUZZ_GRADCHECK
+#define FUZZ_GRADCHECK 1
+#endif
+#ifndef FUZZ_GRADCHECK_SAMPLES
+#define FUZZ_GRADCHECK_SAMPLES 2
+#endif
+#ifndef FUZZ_GRADCHECK_MAX_ELEMENTS
+#define FUZZ_GRADCHECK_MAX_ELEMENTS 32
+#endif
+
+// build.sh links with -Wl,--wrap=LLVMFuzzerTestOneInput, so the harness's
+// LLVMFuzzerTestOneInput is reached through the runtime's
+// __wrap_LLVMFuzzerTestOneInput, which runs it via fuzzer_utils::runInput.
+//
+// Inputs run under c10::InferenceMode, which skips autograd dispatch and
+// saved tensors. Harnesses that exercise autograd (backward, requires_grad,
+// grad mode APIs) define FUZZ_AUTOGRAD before including this header; main.cpp
+// then overrides the runtime's weak default of this function.
+#ifdef FUZZ_AUTOGRAD
+extern "C" bool fuzzerUtilsHarnessUsesAutograd()
+{
+    return true;
+}
+#endif
+
+namespace fuzzer_utils
+{
+
+    // --- Entry point ---
+    // Runs one input through `harness`, under InferenceMode unless
+    // `uses_autograd`, and does the per-input bookkeeping: allocator cache
+    // trimming and the FUZZ_INPUT_STATS counters. Called for every input by
+    // __wrap_LLVMFuzzerTestOneInput.
+    int runInput(int (*harness)(const uint8_t *, size_t), const uint8_t *Data, size_t Size,
+                 bool uses_autograd);
+
+    // --- Logging ---
+    void logErrorMessage(const std::string &msg);
+    void saveErrorInput(const uint8_t *data, size_t size);
+    void saveDiffInput(const uint8_t *data, size_t size, const std::string &timestamp);
+    std::string currentTimestamp();
+    std::string sanitizedTimestamp();
+    bool ensure_log_directory_exists(const std::string &dir = ".");
+
+    // --- Tracing ---
+    void traceMessage(const std::string &msg);
+    void traceInput();
+
+    // --- Tensor Parsing ---
+    torch::ScalarType parseDataType(uint8_t selector);
+    uint8_t parseRank(uint8_t byte);
+    std::vector<int64_t> parseShape(const uint8_t *data, size_t &offset, size_t size, uint8_t rank);
+    std::vector<uint8_t> parseTensorData(const uint8_t *data, size_t &offset, size_t size,
+                                         int64_t numElements, size_t dtypeSize);
+    // Allocates the tensor once and copies the input bytes straight into its
+    // storage; elements past the end of the input are zero. The storage is
+    // laid out as selected by the layout byte when FUZZ_TENSOR_LAYOUTS is
+    // on, so the result need not be contiguous.
+    torch::Tensor createTensor(const uint8_t *Data, size_t Size, size_t &offset);
+    // Same input format as createTensor, but when enough suitably aligned
+    // bytes remain the tensor borrows them instead of copying. The result is
+    // read-only and only valid during the current LLVMFuzzerTestOneInput call.
+    torch::Tensor createTensorView(const uint8_t *Data, size_t Size, size_t &offset);
+
+    // --- Quantized Tensors ---
+    // Quantized tensor read as a qtype byte (quint8, qint8 or qint32; absent
+    // when `qtype` is given), a rank byte, the shape as in createTensor, two
+    // scale bytes (2^-12 .. 2^4, always positive and finite), a zero-point
+    // byte (within the qtype's range; qint32 uses [-128, 127]) and the
+    // integer payload, which is copied straight into the storage without a
+    // float round trip. Elements past the end of the input are zero.
+    torch::Tensor createQuantizedTensor(const uint8_t *Data, size_t Size, size_t &offset);
+    torch::Tensor createQuantizedTensor(const uint8_t *Data, size_t Size, size_t &offset, torch::ScalarType qtype);
+    // Same, quantized per channel: an axis byte follows the shape, then two
+    // scale bytes and a zero-point byte per channel along that axis. Scalars
+    // are quantized per tensor.
+    torch::Tensor createPerChannelQuantizedTensor(const uint8_t *Data, size_t Size, size_t &offset);
+    torch::Tensor createPerChannelQuantizedTensor(const uint8_t *Data, size_t Size, size_t &offset, torch::ScalarType qtype);
+
+    // --- Structured Matrices ---
+    enum class MatrixKind : uint8_t
+    {
+        SPD,          // B*B^H + eps*I from an n x r seed block
+        Invertible,   // strictly diagonally dominant
+        Orthogonal,   // product of 1-3 Householder reflectors (unitary if complex)
+        Banded,       // diagonally dominant with random lower/upper bandwidth
+        Triangular,   // diagonally dominant upper or lower triangle
+        NearSingular, // Q*diag(s)*Q^H with smallest s in [1e-15, 1e-1], or 0
+    };
+    MatrixKind parseMatrixKind(uint8_t byte);
+    // Square float, double, complex float or complex double matrix of size
+    // 1..MAX_MATRIX_DIM with up to two batch dims of size 1..3, read as a
+    // dtype byte, a size byte, a batch byte, a parameter byte and the seed
+    // block of the given kind. Cheap: at most n*n seed bytes (twice that for
+    // complex) and O(n^3) scalar work per matrix. Missing bytes read as zero.
+    torch::Tensor createMatrix(const uint8_t *Data, size_t Size, size_t &offset, MatrixKind kind);
+    // Same, with the kind taken from the next input byte.
+    torch::Tensor createMatrix(const uint8_t *Data, size_t Size, size_t &offset);
+
+    // --- Allocator ---
+    // Counters of the pooling CPU allocator (all zero when it is disabled).
+    // Set FUZZ_ALLOCATOR_STATS=1 to print them to stderr at exit.
+    struct AllocatorStats
+    {
+        uint64_t execs = 0;
+        uint64_t allocations = 0;
+        uint64_t pool_hits = 0;
+        uint64_t trims = 0;
+        size_t cached_bytes = 0;
+        size_t peak_cached_bytes = 0;
+
+        double allocationsPerExec() const { return execs == 0 ? 0.0 : static_cast<double>(allocations) / execs; }
+        double hitRate() const { return allocations == 0 ? 0.0 : static_cast<double>(pool_hits) / allocations; }
+    };
+
+    AllocatorStats allocatorStats();
+
+    // --- Module Cache ---
+    // Joins a module name and its constructor arguments into a cache key.
+    template <typename... Args>
+    std::string moduleKey(const char *name, const Args &...args)
+    {
+        std::ostringstream key;
+        key << std::setprecision(17) << name;
+        ((key << '|' << args), ...);
+        return key.str();
+    }
+
+    // Returns the cached module for `key` with its parameters and buffers
+    // restored to their values right after construction, its gradients
+    // dropped and training mode set; null if there is none or its layout
+    // has changed since.
+    std::shared_ptr<torch::nn::Module> findCachedModule(const std::string &key);
+    void storeCachedModule(const std::string &key, std::shared_ptr<torch::nn::Module> module);
+
+    // Module holder (torch::nn::Linear, torch::nn::LSTM, ...) for `key`,
+    // built with `make()` on a miss. Later inputs with the same constructor
+    // configuration reuse the instance and skip construction and random
+    // parameter initialisation, e.g.
+    //   auto rnn = fuzzer_utils::cachedModule<torch::nn::RNN>(
+    //       fuzzer_utils::moduleKey("RNN", input_size, hidden_size),
+    //       [&] { return torch::nn::RNN(options); });
+    template <typename Holder, typename Factory>
+    Holder cachedModule(const std::string &key, Factory &&make)
+    {
+#if FUZZ_MODULE_CACHE
+        using Impl = typename Holder::ContainedType;
+        if (auto cached = std::dynamic_pointer_cast<Impl>(findCachedModule(key)))
+            return Holder(std::move(cached));
+        Holder module = make();
+        storeCachedModule(key, module.ptr());
+        return module;
+#else
+        return make();
+#endif
+    }
+
+    // --- Comparison  ---
+    // Outcome of compareTensors; the error fields are maxima over all compared elements.
+    struct CompareResult
+    {
+        bool shape_match = true;
+        bool dtype_match = true;
+        int64_t mismatches = 0;     // elements outside atol + rtol * |t2|, NaN-pattern mismatches included
+        int64_t nan_mismatches = 0; // elements that are NaN in exactly one of the tensors
+        double max_abs_error = 0.0;
+        double max_rel_error = 0.0;
+        int64_t max_ulp_error = 0; // representable steps for floats, plain distance for integers
+        bool ok() const { return shape_match && dtype_match && mismatches == 0; }
+    };
+
+    // Differential check of t1 against the reference t2 in a single pass over both, in
+    // their own dtype (integer and bool exactly, complex per component); two NaNs match.
+    // On a mismatch the input is stored once as diff_inputs/<fnv1a-64 of data>.bin with a
+    // one-line summary next to it in <hash>.txt.
+    CompareResult compareTensors(const torch::Tensor &t1, const torch::Tensor &t2, const uint8_t *data, size_t size, double rtol = 1e-5, double atol = 1e-8);
+
+    // --- Gradient check ---
+    using DifferentiableFn = std::function<torch::Tensor(const std::vector<torch::Tensor> &)>;
+    // Checks the gradient of fn at `inputs` (promoted to double, like torch.autograd.gradcheck)
+    // against finite differences of a random projection of its output. Returns false and
+    // stores the input like compareTensors when they disagree. Inputs where fn throws, is
+    // not differentiable or is not smooth count as passing. The harness must define
+    // FUZZ_AUTOGRAD: under the default InferenceMode there is no gradient, so the call only
+    // warns once and returns true. FUZZ_INPUT_STATS=1 prints the checks and mismatches at exit.
+    bool gradCheck(const DifferentiableFn &fn, const std::vector<torch::Tensor> &inputs, const uint8_t *data, size_t size);
+
+} // namespace fuzzer_utils
+
+#endif // FUZZER_UTILS_H
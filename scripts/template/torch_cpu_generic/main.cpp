@@ -0,0 +1,248 @@
+#include "fuzzer_utils.h" // General fuzzing utilities
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <ATen/core/function_schema.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Generic ATen operator fuzzer: one binary for every operator registered with
+// the c10 Dispatcher. The operator is picked at startup with FUZZ_OP, e.g.
+// FUZZ_OP=aten::add.Tensor (or the Python name, FUZZ_OP=torch.sin, for the
+// default overload). Its FunctionSchema drives how the input bytes are turned
+// into arguments, and the call goes through callBoxed. FUZZ_LIST_OPS=1 prints
+// every operator whose arguments can be synthesized and exits.
+
+namespace
+{
+    // Values for str arguments; covers the usual reduction, padding, rounding
+    // and interpolation modes.
+    const char *const kStrings[] = {"none", "mean", "sum", "constant", "reflect", "replicate", "circular",
+                                    "floor", "trunc", "linear", "nearest", "bilinear", "bicubic", "tanh",
+                                    "reduced", "complete", "r", "L", "U", "forward", "backward", "ortho"};
+
+    const double kFloats[] = {0.0, 1.0, -1.0, 0.5, 2.0, 1e-6, 1e10, -1e10,
+                              std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                              std::numeric_limits<double>::quiet_NaN()};
+
+    const int64_t kExtremeInts[] = {std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min(),
+                                    int64_t{1} << 31, -(int64_t{1} << 31), int64_t{1} << 20, 255};
+
+    constexpr int64_t kMaxListLength = 4;
+
+    bool synthesizable(const c10::TypePtr &type)
+    {
+        switch (type->kind())
+        {
+        case c10::TypeKind::TensorType:
+        case c10::TypeKind::IntType:
+        case c10::TypeKind::SymIntType:
+        case c10::TypeKind::FloatType:
+        case c10::TypeKind::BoolType:
+        case c10::TypeKind::NumberType:
+        case c10::TypeKind::StringType:
+        case c10::TypeKind::DeviceObjType:
+        case c10::TypeKind::GeneratorType:
+        case c10::TypeKind::NoneType:
+        case c10::TypeKind::ScalarTypeType:
+        case c10::TypeKind::LayoutType:
+        case c10::TypeKind::MemoryFormatType:
+            return true;
+        case c10::TypeKind::OptionalType:
+            return synthesizable(type->castRaw<c10::OptionalType>()->getElementType());
+        case c10::TypeKind::ListType:
+            return synthesizable(type->castRaw<c10::ListType>()->getElementType());
+        default:
+            return false;
+        }
+    }
+
+    bool synthesizable(const c10::FunctionSchema &schema)
+    {
+        return std::all_of(schema.arguments().begin(), schema.arguments().end(),
+                           [](const c10::Argument &arg)
+                           { return synthesizable(arg.real_type()); });
+    }
+
+    struct ArgumentSynthesizer
+    {
+        const uint8_t *data;
+        size_t size;
+        size_t &offset;
+
+        uint8_t byte() { return offset < size ? data[offset++] : 0; }
+
+        int64_t integer(bool in_list)
+        {
+            const uint8_t b = byte();
+            // Mostly small values (dims, sizes, counts); list elements stay small
+            // so size arguments do not ask for huge allocations.
+            if (in_list || b < 224)
+                return static_cast<int64_t>(b % 8) - 2;
+            return kExtremeInts[b % std::size(kExtremeInts)];
+        }
+
+        double floating()
+        {
+            const uint8_t b = byte();
+            if (b < 128)
+                return static_cast<int8_t>(b * 2) / 16.0;
+            return kFloats[b % std::size(kFloats)];
+        }
+
+        c10::IValue value(const c10::TypePtr &type, bool in_list = false)
+        {
+            switch (type->kind())
+            {
+            case c10::TypeKind::TensorType:
+                return fuzzer_utils::createTensor(data, size, offset);
+            case c10::TypeKind::IntType:
+            case c10::TypeKind::SymIntType:
+                return integer(in_list);
+            case c10::TypeKind::FloatType:
+                return floating();
+            case c10::TypeKind::BoolType:
+                return static_cast<bool>(byte() & 1);
+            case c10::TypeKind::NumberType:
+                return byte() & 1 ? c10::IValue(floating()) : c10::IValue(integer(false));
+            case c10::TypeKind::StringType:
+                return std::string(kStrings[byte() % std::size(kStrings)]);
+            case c10::TypeKind::DeviceObjType:
+                return c10::Device(c10::kCPU);
+            case c10::TypeKind::ScalarTypeType:
+                return static_cast<int64_t>(fuzzer_utils::parseDataType(byte()));
+            case c10::TypeKind::LayoutType:
+                return static_cast<int64_t>(c10::kStrided);
+            case c10::TypeKind::MemoryFormatType:
+            {
+                const c10::MemoryFormat formats[] = {c10::MemoryFormat::Contiguous, c10::MemoryFormat::Preserve,
+                                                     c10::MemoryFormat::ChannelsLast, c10::MemoryFormat::ChannelsLast3d};
+                return static_cast<int64_t>(formats[byte() % std::size(formats)]);
+            }
+            case c10::TypeKind::OptionalType:
+            {
+                // Generators are left to the default; other optionals are None on odd bytes.
+                const c10::TypePtr &element = type->castRaw<c10::OptionalType>()->getElementType();
+                if (element->kind() == c10::TypeKind::GeneratorType || byte() & 1)
+                    return c10::IValue();
+                return value(element, in_list);
+            }
+            case c10::TypeKind::ListType:
+            {
+                c10::TypePtr element = type->castRaw<c10::ListType>()->getElementType();
+                // SymInt[] is passed as int[], as the JIT interpreter does.
+                if (element->kind() == c10::TypeKind::SymIntType)
+                    element = c10::IntType::get();
+                c10::impl::GenericList list(element);
+                const int64_t length = byte() % (kMaxListLength + 1);
+                for (int64_t i = 0; i < length; ++i)
+                    list.push_back(value(element, true));
+                return list;
+            }
+            default:
+                // None, and the rare non-optional Generator (the op then rejects the input)
+                return c10::IValue();
+            }
+        }
+
+        c10::IValue argument(const c10::Argument &arg)
+        {
+            // Keyword-only arguments fall back to their default more often.
+            const uint8_t use_default = arg.kwarg_only() ? 2 : 4;
+            if (arg.default_value() && byte() % use_default == 0)
+                return *arg.default_value();
+            return value(arg.real_type());
+        }
+    };
+
+    std::string operatorId(const c10::OperatorName &name)
+    {
+        return name.overload_name.empty() ? name.name : name.name + "." + name.overload_name;
+    }
+
+    // aten::add.Tensor -> {aten::add, Tensor}; torch.nn.functional.relu -> {aten::relu, ""}.
+    c10::OperatorName parseOperatorId(const std::string &id)
+    {
+        if (id.rfind("torch.", 0) == 0)
+            return {"aten::" + id.substr(id.rfind('.') + 1), ""};
+        const size_t ns = id.find("::");
+        const size_t dot = id.find('.', ns == std::string::npos ? 0 : ns + 2);
+        if (dot == std::string::npos)
+            return {id, ""};
+        return {id.substr(0, dot), id.substr(dot + 1)};
+    }
+
+    void listOperators()
+    {
+        std::vector<std::string> ids;
+        for (const c10::OperatorName &name : c10::Dispatcher::singleton().getAllOpNames())
+        {
+            const auto op = c10::Dispatcher::singleton().findSchema(name);
+            if (op && synthesizable(op->schema()))
+                ids.push_back(operatorId(name));
+        }
+        std::sort(ids.begin(), ids.end());
+        for (const std::string &id : ids)
+            std::cout << id << "\n";
+    }
+
+    c10::OperatorHandle selectedOperator()
+    {
+        const char *list = std::getenv("FUZZ_LIST_OPS");
+        if (list && list[0] == '1')
+        {
+            listOperators();
+            std::exit(0);
+        }
+        const char *id = std::getenv("FUZZ_OP");
+        if (!id || !*id)
+        {
+            std::cerr << "Set FUZZ_OP to the operator to fuzz, e.g. FUZZ_OP=aten::add.Tensor "
+                         "(FUZZ_LIST_OPS=1 lists them)"
+                      << std::endl;
+            std::exit(1);
+        }
+        const auto op = c10::Dispatcher::singleton().findSchema(parseOperatorId(id));
+        if (!op)
+        {
+            std::cerr << "Unknown operator: " << id << std::endl;
+            std::exit(1);
+        }
+        if (!synthesizable(op->schema()))
+        {
+            std::cerr << "Cannot synthesize the arguments of " << op->schema() << std::endl;
+            std::exit(1);
+        }
+        return *op;
+    }
+} // namespace
+
+// --- Fuzzer Entry Point ---
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
+{
+    // Resolved once, during the runtime's warm-up run.
+    static const c10::OperatorHandle op = selectedOperator();
+    FUZZ_TRACE_INPUT();
+    try
+    {
+        size_t offset = 0;
+        ArgumentSynthesizer synthesizer{Data, Size, offset};
+
+        std::vector<c10::IValue> stack;
+        for (const c10::Argument &arg : op.schema().arguments())
+            stack.push_back(synthesizer.argument(arg));
+        FUZZ_TRACE(1, op.schema().name() << " with " << stack.size() << " arguments");
+
+        op.callBoxed(&stack);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Exception caught: " << e.what() << std::endl;
+        return -1; // discard the input
+    }
+    return 0; // keep the input
+}
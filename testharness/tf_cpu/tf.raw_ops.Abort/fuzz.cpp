@@ -6,6 +6,7 @@
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -93,37 +94,12 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
 std::string parseErrorMessage(const uint8_t* data, size_t& offset, size_t total_size) {
@@ -148,7 +124,7 @@ bool parseExitWithoutError(uint8_t byte) {
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 3) {
         return 0;
     }
@@ -173,7 +149,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
                                              tensorflow::ops::Abort::ErrorMsg(error_msg)
                                              .ExitWithoutError(exit_without_error));
         
-        tensorflow::ClientSession session(root);
+        tensorflow::ClientSession session(root, tf_fuzzer_utils::makeSessionOptions());
         
         std::vector<tensorflow::Tensor> outputs;
         std::vector<tensorflow::Output> fetch_outputs;
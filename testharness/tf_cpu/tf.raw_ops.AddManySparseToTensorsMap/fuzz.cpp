@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/sparse_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 21) {
@@ -93,57 +85,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -219,13 +169,11 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         uint8_t values_dtype_selector = data[offset++];
         tensorflow::DataType values_dtype = parseDataType(values_dtype_selector);
@@ -280,19 +228,13 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         std::string container = "";
         std::string shared_name = "";
         
-        auto sparse_indices_input = tensorflow::ops::Const(root, sparse_indices_tensor);
-        auto sparse_values_input = tensorflow::ops::Const(root, sparse_values_tensor);
-        auto sparse_shape_input = tensorflow::ops::Const(root, sparse_shape_tensor);
-        
-        auto add_many_sparse_op = tensorflow::ops::AddManySparseToTensorsMap(
-            root, sparse_indices_input, sparse_values_input, sparse_shape_input,
-            tensorflow::ops::AddManySparseToTensorsMap::Container(container)
-                .SharedName(shared_name));
-        
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
         
-        tensorflow::Status status = session.Run({add_many_sparse_op}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("AddManySparseToTensorsMap")
+                .attr("container", container)
+                .attr("shared_name", shared_name),
+            {sparse_indices_tensor, sparse_values_tensor, sparse_shape_tensor}, &outputs);
         if (!status.ok()) {
             return -1;
         }
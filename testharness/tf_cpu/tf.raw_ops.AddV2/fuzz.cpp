@@ -1,10 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <cmath>
@@ -14,12 +13,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 10) {
@@ -61,122 +54,24 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
-
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_FLOAT:
-            fillTensorWithData<float>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_DOUBLE:
-            fillTensorWithData<double>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT32:
-            fillTensorWithData<int32_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT8:
-            fillTensorWithData<uint8_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT16:
-            fillTensorWithData<int16_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT8:
-            fillTensorWithData<int8_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT64:
-            fillTensorWithData<int64_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_BOOL:
-            fillTensorWithData<bool>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT16:
-            fillTensorWithData<uint16_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT32:
-            fillTensorWithData<uint32_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT64:
-            fillTensorWithData<uint64_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_BFLOAT16:
-            fillTensorWithData<tensorflow::bfloat16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_HALF:
-            fillTensorWithData<Eigen::half>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_COMPLEX64:
-            fillTensorWithData<tensorflow::complex64>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_COMPLEX128:
-            fillTensorWithData<tensorflow::complex128>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
-}
+using tf_fuzzer_utils::fillTensorWithDataByType;
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) {
         return 0;
     }
 
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
         
@@ -195,14 +90,9 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         fillTensorWithDataByType(tensor_x, dtype, data, offset, size);
         fillTensorWithDataByType(tensor_y, dtype, data, offset, size);
 
-        auto input_x = tensorflow::ops::Const(root, tensor_x);
-        auto input_y = tensorflow::ops::Const(root, tensor_y);
-
-        auto add_op = tensorflow::ops::AddV2(root, input_x, input_y);
-
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({add_op}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("AddV2"), {tensor_x, tensor_y}, &outputs);
         
         if (!status.ok()) {
             return -1;
@@ -1,12 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/dataset_ops.h"
 #include "tensorflow/core/framework/tensor.h"
-#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -22,12 +19,6 @@
 #define MAX_OUTPUT_TYPES 5
 #define MIN_OUTPUT_TYPES 1
 
-namespace tf_fuzzer_utils {
-    void logError(const std::string& message, const uint8_t* data, size_t size) {
-        std::cerr << "Error: " << message << std::endl;
-    }
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype; 
     switch (selector % 21) {  
@@ -99,37 +90,12 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
 std::vector<std::string> parseDevices(const uint8_t* data, size_t& offset, size_t total_size) {
@@ -193,15 +159,13 @@ std::vector<tensorflow::TensorShape> parseOutputShapes(const uint8_t* data, size
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) {
         return 0;
     }
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         std::vector<std::string> devices = parseDevices(data, offset, size);
         std::vector<tensorflow::DataType> output_types = parseOutputTypes(data, offset, size);
@@ -230,25 +194,14 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             partial_shapes.emplace_back(shape);
         }
 
-        tensorflow::Node* iterator_node = nullptr;
-        auto builder = tensorflow::NodeBuilder(
-                root.GetUniqueNameForOp("AnonymousMultiDeviceIteratorV3"),
-                "AnonymousMultiDeviceIteratorV3")
-                           .Attr("devices", devices)
-                           .Attr("output_types", output_types)
-                           .Attr("output_shapes", partial_shapes);
-        root.UpdateStatus(builder.Finalize(root.graph(), &iterator_node));
-        if (!root.ok() || iterator_node == nullptr) {
-            tf_fuzzer_utils::logError("Failed to build AnonymousMultiDeviceIteratorV3 node", data, size);
-            return -1;
-        }
-
-        tensorflow::Output iterator_handle(iterator_node, 0);
-
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
         
-        tensorflow::Status status = session.Run({}, {iterator_handle}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("AnonymousMultiDeviceIteratorV3")
+                .attr("devices", devices)
+                .attr("output_types", output_types)
+                .attr("output_shapes", partial_shapes),
+            {}, &outputs);
         if (!status.ok()) {
             std::cout << "Error running session: " << status.ToString() << std::endl;
             return -1;
@@ -1,12 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/lookup_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/graph/node_builder.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -17,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType selectKeyType(uint8_t selector) {
     switch (selector % 3) {
         case 0:
@@ -76,57 +67,15 @@ tensorflow::DataType selectValueType(uint8_t selector, tensorflow::DataType key_
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillStringTensor(tensorflow::Tensor& tensor, const uint8_t* data,
                       size_t& offset, size_t total_size) {
@@ -223,13 +172,11 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         tensorflow::DataType key_dtype = selectKeyType(data[offset++]);
         tensorflow::DataType value_dtype = selectValueType(data[offset++], key_dtype);
@@ -285,29 +232,15 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             }
         }
 
-        auto empty_key_op = tensorflow::ops::Const(root, empty_key_tensor);
-        auto deleted_key_op = tensorflow::ops::Const(root, deleted_key_tensor);
-
-        tensorflow::Node* table_node = nullptr;
-        auto builder = tensorflow::NodeBuilder(
-                           root.GetUniqueNameForOp("AnonymousMutableDenseHashTable"),
-                           "AnonymousMutableDenseHashTable")
-                           .Input(tensorflow::ops::AsNodeOut(root, empty_key_op))
-                           .Input(tensorflow::ops::AsNodeOut(root, deleted_key_op))
-                           .Attr("key_dtype", key_dtype)
-                           .Attr("value_dtype", value_dtype)
-                           .Attr("value_shape", tensorflow::PartialTensorShape(value_shape_dims))
-                           .Attr("initial_num_buckets", initial_num_buckets)
-                           .Attr("max_load_factor", max_load_factor);
-        root.UpdateStatus(builder.Finalize(root.graph(), &table_node));
-        if (!root.ok() || table_node == nullptr) {
-            return -1;
-        }
-        tensorflow::Output hash_table(table_node, 0);
-
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({hash_table}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("AnonymousMutableDenseHashTable")
+                .attr("key_dtype", key_dtype)
+                .attr("value_dtype", value_dtype)
+                .attr("value_shape", tensorflow::PartialTensorShape(value_shape_dims))
+                .attr("initial_num_buckets", initial_num_buckets)
+                .attr("max_load_factor", max_load_factor),
+            {empty_key_tensor, deleted_key_tensor}, &outputs);
         if (!status.ok()) {
             std::cout << "Error running session: " << status.ToString() << std::endl;
             return -1;
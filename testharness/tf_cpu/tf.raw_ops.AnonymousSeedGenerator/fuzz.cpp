@@ -8,6 +8,7 @@
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -24,118 +25,21 @@ void logError(const std::string& message, const uint8_t* data, size_t size) {
 }
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-  auto flat = tensor.flat<T>();
-  const size_t num_elements = flat.size();
-  const size_t element_size = sizeof(T);
-
-  for (size_t i = 0; i < num_elements; ++i) {
-    if (offset + element_size <= total_size) {
-      T value;
-      std::memcpy(&value, data + offset, element_size);
-      offset += element_size;
-      flat(i) = value;
-    } else {
-      flat(i) = T{};
-    }
-  }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-  switch (dtype) {
-    case tensorflow::DT_FLOAT:
-      fillTensorWithData<float>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_DOUBLE:
-      fillTensorWithData<double>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT32:
-      fillTensorWithData<int32_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT8:
-      fillTensorWithData<uint8_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT16:
-      fillTensorWithData<int16_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT8:
-      fillTensorWithData<int8_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT64:
-      fillTensorWithData<int64_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_BOOL:
-      fillTensorWithData<bool>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT16:
-      fillTensorWithData<uint16_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT32:
-      fillTensorWithData<uint32_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT64:
-      fillTensorWithData<uint64_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_BFLOAT16:
-      fillTensorWithData<tensorflow::bfloat16>(tensor, data, offset,
-                                               total_size);
-      break;
-    case tensorflow::DT_HALF:
-      fillTensorWithData<Eigen::half>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_COMPLEX64:
-      fillTensorWithData<tensorflow::complex64>(tensor, data, offset,
-                                                total_size);
-      break;
-    case tensorflow::DT_COMPLEX128:
-      fillTensorWithData<tensorflow::complex128>(tensor, data, offset,
-                                                 total_size);
-      break;
-    default:
-      break;
-  }
-}
+using tf_fuzzer_utils::fillTensorWithDataByType;
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 3) {
         return 0;
     }
@@ -203,7 +107,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         tensorflow::Output handle(generator_node, 0);
         tensorflow::Output deleter(generator_node, 1);
 
-        tensorflow::ClientSession session(root);
+        tensorflow::ClientSession session(root, tf_fuzzer_utils::makeSessionOptions());
         std::vector<tensorflow::Tensor> outputs;
         
         tensorflow::Status status = session.Run(
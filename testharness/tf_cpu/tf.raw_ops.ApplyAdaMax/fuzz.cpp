@@ -1,12 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
-#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/training_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -17,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 20) {
@@ -91,230 +82,55 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithDataByType;
 
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_FLOAT:
-            fillTensorWithData<float>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_DOUBLE:
-            fillTensorWithData<double>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT32:
-            fillTensorWithData<int32_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT8:
-            fillTensorWithData<uint8_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT16:
-            fillTensorWithData<int16_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT8:
-            fillTensorWithData<int8_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT64:
-            fillTensorWithData<int64_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_BOOL:
-            fillTensorWithData<bool>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT16:
-            fillTensorWithData<uint16_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT32:
-            fillTensorWithData<uint32_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT64:
-            fillTensorWithData<uint64_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_BFLOAT16:
-            fillTensorWithData<tensorflow::bfloat16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_HALF:
-            fillTensorWithData<Eigen::half>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_COMPLEX64:
-            fillTensorWithData<tensorflow::complex64>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_COMPLEX128:
-            fillTensorWithData<tensorflow::complex128>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT8:
-            fillTensorWithData<tensorflow::qint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT8:
-            fillTensorWithData<tensorflow::quint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT32:
-            fillTensorWithData<tensorflow::qint32>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT16:
-            fillTensorWithData<tensorflow::qint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT16:
-            fillTensorWithData<tensorflow::quint16>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
-        
+        if (offset >= size) return 0;
         uint8_t var_rank = parseRank(data[offset++]);
         std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
-        
-        tensorflow::Tensor var_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(var_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor m_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(m_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor v_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(v_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor beta1_power_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(beta1_power_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor lr_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(lr_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor beta1_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(beta1_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor beta2_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(beta2_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor epsilon_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(epsilon_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor grad_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(grad_tensor, dtype, data, offset, size);
-        
         bool use_locking = (offset < size) ? (data[offset++] % 2 == 1) : false;
 
-        auto var_input = tensorflow::ops::Variable(root.WithOpName("var"), tensorflow::PartialTensorShape(var_shape), dtype);
-        auto m_input = tensorflow::ops::Variable(root.WithOpName("m"), tensorflow::PartialTensorShape(var_shape), dtype);
-        auto v_input = tensorflow::ops::Variable(root.WithOpName("v"), tensorflow::PartialTensorShape(var_shape), dtype);
-        
-        auto var_assign = tensorflow::ops::Assign(root.WithOpName("var_assign"), var_input, var_tensor);
-        auto m_assign = tensorflow::ops::Assign(root.WithOpName("m_assign"), m_input, m_tensor);
-        auto v_assign = tensorflow::ops::Assign(root.WithOpName("v_assign"), v_input, v_tensor);
-        
-        auto beta1_power_const = tensorflow::ops::Const(root.WithOpName("beta1_power"), beta1_power_tensor);
-        auto lr_const = tensorflow::ops::Const(root.WithOpName("lr"), lr_tensor);
-        auto beta1_const = tensorflow::ops::Const(root.WithOpName("beta1"), beta1_tensor);
-        auto beta2_const = tensorflow::ops::Const(root.WithOpName("beta2"), beta2_tensor);
-        auto epsilon_const = tensorflow::ops::Const(root.WithOpName("epsilon"), epsilon_tensor);
-        auto grad_const = tensorflow::ops::Const(root.WithOpName("grad"), grad_tensor);
-
-        auto var_node = tensorflow::ops::AsNodeOut(root, var_input);
-        auto m_node = tensorflow::ops::AsNodeOut(root, m_input);
-        auto v_node = tensorflow::ops::AsNodeOut(root, v_input);
-        auto beta1_power_node = tensorflow::ops::AsNodeOut(root, beta1_power_const);
-        auto lr_node = tensorflow::ops::AsNodeOut(root, lr_const);
-        auto beta1_node = tensorflow::ops::AsNodeOut(root, beta1_const);
-        auto beta2_node = tensorflow::ops::AsNodeOut(root, beta2_const);
-        auto epsilon_node = tensorflow::ops::AsNodeOut(root, epsilon_const);
-        auto grad_node = tensorflow::ops::AsNodeOut(root, grad_const);
-
-        tensorflow::Node* apply_node = nullptr;
-        auto builder = tensorflow::NodeBuilder(
-                           root.GetUniqueNameForOp("ApplyAdaMax"),
-                           "ApplyAdaMax")
-                           .Input(var_node)
-                           .Input(m_node)
-                           .Input(v_node)
-                           .Input(beta1_power_node)
-                           .Input(lr_node)
-                           .Input(beta1_node)
-                           .Input(beta2_node)
-                           .Input(epsilon_node)
-                           .Input(grad_node)
-                           .Attr("T", dtype)
-                           .Attr("use_locking", use_locking);
-        root.UpdateStatus(builder.Finalize(root.graph(), &apply_node));
-        if (!root.ok() || apply_node == nullptr) {
-            return -1;
-        }
-        tensorflow::Output apply_output(apply_node, 0);
-
-        tensorflow::ClientSession session(root);
-        
-        std::vector<tensorflow::Tensor> init_outputs;
-        tensorflow::Status init_status = session.Run({var_assign, m_assign, v_assign}, &init_outputs);
-        if (!init_status.ok()) {
-            return -1;
-        }
-
+        tensorflow::Tensor var = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor m = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor v = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor beta1_power = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor lr = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor beta1 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor beta2 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor epsilon = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor grad = makeTensor(dtype, var_shape, data, offset, size);
+
+        // var and its slots are passed as refs and updated in place.
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({apply_output}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ApplyAdaMax").attr("use_locking", use_locking),
+            {var, m, v, beta1_power, lr, beta1, beta2, epsilon, grad}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
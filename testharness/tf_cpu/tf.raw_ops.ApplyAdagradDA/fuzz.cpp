@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/training_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 17) {
@@ -81,200 +73,55 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
+using tf_fuzzer_utils::fillTensorWithDataByType;
 
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
-
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_FLOAT:
-            fillTensorWithData<float>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_DOUBLE:
-            fillTensorWithData<double>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT32:
-            fillTensorWithData<int32_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT8:
-            fillTensorWithData<uint8_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT16:
-            fillTensorWithData<int16_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT8:
-            fillTensorWithData<int8_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT64:
-            fillTensorWithData<int64_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT16:
-            fillTensorWithData<uint16_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT32:
-            fillTensorWithData<uint32_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT64:
-            fillTensorWithData<uint64_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_BFLOAT16:
-            fillTensorWithData<tensorflow::bfloat16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_HALF:
-            fillTensorWithData<Eigen::half>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_COMPLEX64:
-            fillTensorWithData<tensorflow::complex64>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_COMPLEX128:
-            fillTensorWithData<tensorflow::complex128>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT8:
-            fillTensorWithData<tensorflow::qint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT8:
-            fillTensorWithData<tensorflow::quint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT32:
-            fillTensorWithData<tensorflow::qint32>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT16:
-            fillTensorWithData<tensorflow::qint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT16:
-            fillTensorWithData<tensorflow::quint16>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
-        
+        if (offset >= size) return 0;
         uint8_t var_rank = parseRank(data[offset++]);
         std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
-        
-        tensorflow::Tensor var_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(var_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor grad_acc_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(grad_acc_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor grad_sq_acc_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(grad_sq_acc_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor grad_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(grad_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor lr_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(lr_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor l1_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(l1_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor l2_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(l2_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor global_step_tensor(tensorflow::DT_INT64, tensorflow::TensorShape({}));
-        if (offset + sizeof(int64_t) <= size) {
-            int64_t step_val;
-            std::memcpy(&step_val, data + offset, sizeof(int64_t));
-            offset += sizeof(int64_t);
-            global_step_tensor.scalar<int64_t>()() = std::abs(step_val) % 1000000;
-        } else {
-            global_step_tensor.scalar<int64_t>()() = 1;
-        }
-        
         bool use_locking = (offset < size) ? (data[offset++] % 2 == 1) : false;
 
-        auto var_input = tensorflow::ops::Const(root, var_tensor);
-        auto grad_acc_input = tensorflow::ops::Const(root, grad_acc_tensor);
-        auto grad_sq_acc_input = tensorflow::ops::Const(root, grad_sq_acc_tensor);
-        auto grad_input = tensorflow::ops::Const(root, grad_tensor);
-        auto lr_input = tensorflow::ops::Const(root, lr_tensor);
-        auto l1_input = tensorflow::ops::Const(root, l1_tensor);
-        auto l2_input = tensorflow::ops::Const(root, l2_tensor);
-        auto global_step_input = tensorflow::ops::Const(root, global_step_tensor);
+        tensorflow::Tensor var = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor gradient_accumulator = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor gradient_squared_accumulator = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor grad = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor lr = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor l1 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor l2 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor global_step = makeTensor(tensorflow::DT_INT64, {}, data, offset, size);
 
-        auto apply_adagrad_da = tensorflow::ops::ApplyAdagradDA(
-            root,
-            var_input,
-            grad_acc_input,
-            grad_sq_acc_input,
-            grad_input,
-            lr_input,
-            l1_input,
-            l2_input,
-            global_step_input,
-            tensorflow::ops::ApplyAdagradDA::UseLocking(use_locking)
-        );
-
-        tensorflow::ClientSession session(root);
+        // var and its slots are passed as refs and updated in place.
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({apply_adagrad_da}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ApplyAdagradDA").attr("use_locking", use_locking),
+            {var, gradient_accumulator, gradient_squared_accumulator, grad, lr, l1, l2,
+             global_step}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/training_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 20) {
@@ -90,57 +82,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -196,93 +146,45 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
-        
+        if (offset >= size) return 0;
         uint8_t var_rank = parseRank(data[offset++]);
         std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
-        
-        tensorflow::Tensor var_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(var_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor mg_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(mg_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor ms_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(ms_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor mom_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(mom_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor lr_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(lr_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor rho_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(rho_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor momentum_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(momentum_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor epsilon_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(epsilon_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor grad_tensor(dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(grad_tensor, dtype, data, offset, size);
-        
         bool use_locking = (offset < size) ? (data[offset++] % 2 == 1) : false;
 
-        auto var_input = tensorflow::ops::Variable(root.WithOpName("var"), tensorflow::PartialTensorShape(var_shape), dtype);
-        auto mg_input = tensorflow::ops::Variable(root.WithOpName("mg"), tensorflow::PartialTensorShape(var_shape), dtype);
-        auto ms_input = tensorflow::ops::Variable(root.WithOpName("ms"), tensorflow::PartialTensorShape(var_shape), dtype);
-        auto mom_input = tensorflow::ops::Variable(root.WithOpName("mom"), tensorflow::PartialTensorShape(var_shape), dtype);
-        
-        auto lr_input = tensorflow::ops::Const(root.WithOpName("lr"), lr_tensor);
-        auto rho_input = tensorflow::ops::Const(root.WithOpName("rho"), rho_tensor);
-        auto momentum_input = tensorflow::ops::Const(root.WithOpName("momentum"), momentum_tensor);
-        auto epsilon_input = tensorflow::ops::Const(root.WithOpName("epsilon"), epsilon_tensor);
-        auto grad_input = tensorflow::ops::Const(root.WithOpName("grad"), grad_tensor);
-
-        auto assign_var = tensorflow::ops::Assign(root.WithOpName("assign_var"), var_input, tensorflow::ops::Const(root, var_tensor));
-        auto assign_mg = tensorflow::ops::Assign(root.WithOpName("assign_mg"), mg_input, tensorflow::ops::Const(root, mg_tensor));
-        auto assign_ms = tensorflow::ops::Assign(root.WithOpName("assign_ms"), ms_input, tensorflow::ops::Const(root, ms_tensor));
-        auto assign_mom = tensorflow::ops::Assign(root.WithOpName("assign_mom"), mom_input, tensorflow::ops::Const(root, mom_tensor));
-
-        auto apply_centered_rmsprop = tensorflow::ops::ApplyCenteredRMSProp(
-            root.WithOpName("apply_centered_rmsprop"),
-            var_input,
-            mg_input,
-            ms_input,
-            mom_input,
-            lr_input,
-            rho_input,
-            momentum_input,
-            epsilon_input,
-            grad_input,
-            tensorflow::ops::ApplyCenteredRMSProp::UseLocking(use_locking)
-        );
-
-        tensorflow::ClientSession session(root);
-        
-        std::vector<tensorflow::Tensor> init_outputs;
-        tensorflow::Status init_status = session.Run({assign_var, assign_mg, assign_ms, assign_mom}, &init_outputs);
-        if (!init_status.ok()) {
-            return -1;
-        }
-
+        tensorflow::Tensor var = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor mg = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor ms = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor mom = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor lr = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor rho = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor momentum = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor epsilon = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor grad = makeTensor(dtype, var_shape, data, offset, size);
+
+        // var and its slots are passed as refs and updated in place.
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({apply_centered_rmsprop}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ApplyCenteredRMSProp").attr("use_locking", use_locking),
+            {var, mg, ms, mom, lr, rho, momentum, epsilon, grad}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
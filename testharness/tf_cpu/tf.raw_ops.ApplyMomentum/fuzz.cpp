@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/training_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <cmath>
@@ -15,12 +13,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 20) {
@@ -89,57 +81,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -192,76 +142,44 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
-        
+        if (offset >= size) return 0;
         uint8_t var_rank = parseRank(data[offset++]);
         std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
-        
-        uint8_t use_locking_byte = data[offset % size];
-        offset++;
-        bool use_locking = (use_locking_byte % 2) == 1;
-        
-        uint8_t use_nesterov_byte = data[offset % size];
-        offset++;
-        bool use_nesterov = (use_nesterov_byte % 2) == 1;
-
-        tensorflow::TensorShape var_tensor_shape(var_shape);
-        tensorflow::Tensor var_tensor(dtype, var_tensor_shape);
-        fillTensorWithDataByType(var_tensor, dtype, data, offset, size);
-
-        tensorflow::TensorShape accum_tensor_shape(var_shape);
-        tensorflow::Tensor accum_tensor(dtype, accum_tensor_shape);
-        fillTensorWithDataByType(accum_tensor, dtype, data, offset, size);
-
-        tensorflow::TensorShape lr_tensor_shape({});
-        tensorflow::Tensor lr_tensor(dtype, lr_tensor_shape);
-        fillTensorWithDataByType(lr_tensor, dtype, data, offset, size);
-
-        tensorflow::TensorShape grad_tensor_shape(var_shape);
-        tensorflow::Tensor grad_tensor(dtype, grad_tensor_shape);
-        fillTensorWithDataByType(grad_tensor, dtype, data, offset, size);
+        bool use_locking = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool use_nesterov = (offset < size) ? (data[offset++] % 2 == 1) : false;
 
-        tensorflow::TensorShape momentum_tensor_shape({});
-        tensorflow::Tensor momentum_tensor(dtype, momentum_tensor_shape);
-        fillTensorWithDataByType(momentum_tensor, dtype, data, offset, size);
-
-        auto var_input = tensorflow::ops::Variable(root, var_tensor_shape, dtype);
-        auto accum_input = tensorflow::ops::Variable(root, accum_tensor_shape, dtype);
-        auto lr_input = tensorflow::ops::Const(root, lr_tensor);
-        auto grad_input = tensorflow::ops::Const(root, grad_tensor);
-        auto momentum_input = tensorflow::ops::Const(root, momentum_tensor);
-
-        auto assign_var = tensorflow::ops::Assign(root, var_input, tensorflow::ops::Const(root, var_tensor));
-        auto assign_accum = tensorflow::ops::Assign(root, accum_input, tensorflow::ops::Const(root, accum_tensor));
-
-        auto apply_momentum = tensorflow::ops::ApplyMomentum(
-            root, var_input, accum_input, lr_input, grad_input, momentum_input,
-            tensorflow::ops::ApplyMomentum::UseLocking(use_locking).UseNesterov(use_nesterov)
-        );
-
-        tensorflow::ClientSession session(root);
-        
-        std::vector<tensorflow::Tensor> init_outputs;
-        tensorflow::Status init_status = session.Run({assign_var, assign_accum}, &init_outputs);
-        if (!init_status.ok()) {
-            return -1;
-        }
+        tensorflow::Tensor var = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor accum = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor lr = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor grad = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor momentum = makeTensor(dtype, {}, data, offset, size);
 
+        // var and its slots are passed as refs and updated in place.
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({apply_momentum}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ApplyMomentum")
+                .attr("use_locking", use_locking)
+                .attr("use_nesterov", use_nesterov),
+            {var, accum, lr, grad, momentum}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
-#include "tensorflow/core/graph/node_builder.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -16,30 +14,7 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-    void logError(const std::string& message, const uint8_t* data, size_t size) {
-        std::cerr << message << std::endl;
-    }
-}
-
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-  auto flat = tensor.flat<T>();
-  const size_t num_elements = flat.size();
-  const size_t element_size = sizeof(T);
-
-  for (size_t i = 0; i < num_elements; ++i) {
-    if (offset + element_size <= total_size) {
-      T value;
-      std::memcpy(&value, data + offset, element_size);
-      offset += element_size;
-      flat(i) = value;
-    } else {
-      flat(i) = T{};
-    }
-  }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillStringTensor(tensorflow::Tensor& tensor, const uint8_t* data,
                      size_t& offset, size_t total_size) {
@@ -125,47 +100,20 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         uint8_t tag_rank = parseRank(data[offset++]);
         if (tag_rank != 0) tag_rank = 0;
@@ -173,14 +121,12 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         
         tensorflow::Tensor tag_tensor(tensorflow::DT_STRING, tensorflow::TensorShape(tag_shape));
         fillStringTensor(tag_tensor, data, offset, size);
-        auto tag_input = tensorflow::ops::Const(root, tag_tensor);
         
         uint8_t tensor_rank = parseRank(data[offset++]);
         std::vector<int64_t> tensor_shape = parseShape(data, offset, size, tensor_rank);
         
         tensorflow::Tensor audio_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape(tensor_shape));
         fillTensorWithDataByType(audio_tensor, tensorflow::DT_FLOAT, data, offset, size);
-        auto tensor_input = tensorflow::ops::Const(root, audio_tensor);
         
         float sample_rate = 44100.0f;
         if (offset + sizeof(float) <= size) {
@@ -200,25 +146,12 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             if (max_outputs > 10) max_outputs = 3;
         }
         
-        auto tag_node = tensorflow::ops::AsNodeOut(root, tag_input);
-        auto tensor_node = tensorflow::ops::AsNodeOut(root, tensor_input);
-        tensorflow::Node* audio_summary_node = nullptr;
-        auto builder = tensorflow::NodeBuilder(
-                           root.GetUniqueNameForOp("AudioSummary"),
-                           "AudioSummary")
-                           .Input(tag_node)
-                           .Input(tensor_node)
-                           .Attr("sample_rate", sample_rate)
-                           .Attr("max_outputs", max_outputs);
-        root.UpdateStatus(builder.Finalize(root.graph(), &audio_summary_node));
-        if (!root.ok() || audio_summary_node == nullptr) {
-            return -1;
-        }
-        tensorflow::Output audio_summary(audio_summary_node, 0);
-
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({}, {audio_summary}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("AudioSummary")
+                .attr("sample_rate", sample_rate)
+                .attr("max_outputs", max_outputs),
+            {tag_tensor, audio_tensor}, &outputs);
         if (!status.ok()) {
             return -1;
         }
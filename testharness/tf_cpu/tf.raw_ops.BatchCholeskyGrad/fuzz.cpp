@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/linalg_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 2) {
@@ -36,9 +28,7 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
@@ -73,48 +63,14 @@ std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t tota
     return shape;
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
-
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_FLOAT:
-            fillTensorWithData<float>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_DOUBLE:
-            fillTensorWithData<double>(tensor, data, offset, total_size);
-            break;
-        default:
-            return;
-    }
-}
+using tf_fuzzer_utils::fillTensorWithDataByType;
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
         
@@ -136,27 +92,9 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         tensorflow::Tensor tensor_grad(dtype, tensor_shape_grad);
         fillTensorWithDataByType(tensor_grad, dtype, data, offset, size);
 
-        auto l_placeholder = tensorflow::ops::Placeholder(root, dtype);
-        auto grad_placeholder = tensorflow::ops::Placeholder(root, dtype);
-
-        auto l_node_out = tensorflow::ops::AsNodeOut(root, l_placeholder);
-        auto grad_node_out = tensorflow::ops::AsNodeOut(root, grad_placeholder);
-
-        // Build the deprecated BatchCholeskyGrad op directly so the harness hits the raw op keyword.
-        tensorflow::Node* batch_cholesky_grad_node = nullptr;
-        auto builder = tensorflow::NodeBuilder(root.GetUniqueNameForOp("BatchCholeskyGrad"), "BatchCholeskyGrad")
-                           .Input(l_node_out)
-                           .Input(grad_node_out);
-        root.UpdateStatus(builder.Finalize(root.graph(), &batch_cholesky_grad_node));
-        if (!root.ok() || batch_cholesky_grad_node == nullptr) {
-            return -1;
-        }
-        tensorflow::Output batch_cholesky_grad(batch_cholesky_grad_node, 0);
-
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({{l_placeholder, tensor_l}, {grad_placeholder, tensor_grad}}, 
-                                               {batch_cholesky_grad}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("BatchCholeskyGrad"), {tensor_l, tensor_grad}, &outputs);
         
         if (!status.ok()) {
             return -1;
@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/dataset_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -15,12 +13,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype; 
     switch (selector % 21) {  
@@ -92,57 +84,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -219,73 +169,47 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
-        if (offset >= size) return 0;
-        uint8_t num_output_types = (data[offset] % 3) + 1;
-        offset++;
-        
-        std::vector<tensorflow::DataType> output_types;
-        std::vector<tensorflow::PartialTensorShape> output_shapes;
+        // Components of the input dataset; they are sliced along a shared first dimension.
+        uint8_t num_components = (data[offset++] % 3) + 1;
         
-        for (uint8_t i = 0; i < num_output_types; ++i) {
-            if (offset >= size) return 0;
-            tensorflow::DataType dtype = parseDataType(data[offset]);
-            output_types.push_back(dtype);
-            offset++;
+        std::vector<tensorflow::Tensor> components;
+        for (uint8_t i = 0; i < num_components; ++i) {
+            if (offset + 1 >= size) break;
+            tensorflow::DataType dtype = parseDataType(data[offset++]);
+            uint8_t rank = tf_fuzzer_utils::parseRank(data[offset++], 1, MAX_RANK);
+            std::vector<int64_t> shape = parseShape(data, offset, size, rank);
+            if (!components.empty()) {
+                shape[0] = components[0].dim_size(0);
+            }
             
-            if (offset >= size) return 0;
-            uint8_t rank = parseRank(data[offset]);
-            offset++;
+            tensorflow::TensorShape tensor_shape;
+            for (int64_t dim : shape) {
+                tensor_shape.AddDim(dim);
+            }
             
-            std::vector<int64_t> shape = parseShape(data, offset, size, rank);
-            output_shapes.push_back(tensorflow::PartialTensorShape(shape));
+            tensorflow::Tensor tensor(dtype, tensor_shape);
+            fillTensorWithDataByType(tensor, dtype, data, offset, size);
+            components.push_back(tensor);
         }
         
-        if (offset >= size) return 0;
+        if (components.empty() || offset >= size) return 0;
         int64_t batch_size_val = 1 + (data[offset] % 5);
         offset++;
         
         tensorflow::Tensor batch_size_tensor(tensorflow::DT_INT64, tensorflow::TensorShape({}));
         batch_size_tensor.scalar<int64_t>()() = batch_size_val;
         
-        auto batch_size_op = tensorflow::ops::Const(root, batch_size_tensor);
-        
-        // Create a range dataset as input
-        auto start_op = tensorflow::ops::Const(root, 0);
-        auto stop_op = tensorflow::ops::Const(root, 10);
-        auto step_op = tensorflow::ops::Const(root, 1);
-        
-        auto range_dataset_op = tensorflow::ops::RangeDataset(
-            root, start_op, stop_op, step_op, {tensorflow::DT_INT32}, {{}}
-        );
-        
-        // Use the raw_op version to call BatchDataset
-        auto batch_dataset_op = tensorflow::ops::BatchDatasetV2(
-            root,
-            range_dataset_op,
-            batch_size_op,
-            output_types,
-            output_shapes,
-            tensorflow::ops::BatchDatasetV2::DropRemainder(false)
-        );
-        
-        tensorflow::ClientSession session(root);
+        // output_types/output_shapes follow the components.
+        tf_fuzzer_utils::DatasetSpec spec{tf_fuzzer_utils::OpSpec("BatchDataset")};
         std::vector<tensorflow::Tensor> outputs;
-        
-        std::cout << "Batch size: " << batch_size_val << std::endl;
-        std::cout << "Output types count: " << output_types.size() << std::endl;
-        std::cout << "Output shapes count: " << output_shapes.size() << std::endl;
-        
-        tensorflow::Status status = session.Run({batch_dataset_op}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runDataset(spec, components, {batch_size_tensor}, &outputs);
         if (!status.ok()) {
-            std::cout << "Error running session: " << status.ToString() << std::endl;
             return -1;
         }
 
@@ -6,6 +6,7 @@
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -70,90 +71,20 @@ std::string parseMode(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_FLOAT:
-            fillTensorWithData<float>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT8:
-            fillTensorWithData<tensorflow::qint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT8:
-            fillTensorWithData<tensorflow::quint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT32:
-            fillTensorWithData<tensorflow::qint32>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT16:
-            fillTensorWithData<tensorflow::qint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT16:
-            fillTensorWithData<tensorflow::quint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_BFLOAT16:
-            fillTensorWithData<tensorflow::bfloat16>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
-}
+using tf_fuzzer_utils::fillTensorWithDataByType;
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
     
     size_t offset = 0;
@@ -166,12 +97,9 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         std::string mode = parseMode(data[offset++]);
         bool narrow_range = (data[offset++] % 2) == 1;
         
-        int32_t axis = -1;
+        uint8_t axis_byte = 0;
         if (offset < size) {
-            int8_t axis_val;
-            std::memcpy(&axis_val, data + offset, sizeof(int8_t));
-            offset += sizeof(int8_t);
-            axis = static_cast<int32_t>(axis_val);
+            axis_byte = data[offset++];
         }
 
         uint8_t rank = parseRank(data[offset++]);
@@ -182,33 +110,13 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             tensor_shape.AddDim(dim);
         }
 
-        tensorflow::Tensor input_tensor(input_dtype, tensor_shape);
-        fillTensorWithDataByType(input_tensor, input_dtype, data, offset, size);
-
-        float min_range_val = 0.0f;
-        float max_range_val = 1.0f;
-        
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&min_range_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-            if (!std::isfinite(min_range_val)) {
-                min_range_val = 0.0f;
-            }
-        }
-        
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&max_range_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-            if (!std::isfinite(max_range_val) || max_range_val <= min_range_val) {
-                max_range_val = min_range_val + 1.0f;
-            }
-        }
-
-        tensorflow::Tensor min_range_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        min_range_tensor.scalar<float>()() = min_range_val;
-
-        tensorflow::Tensor max_range_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        max_range_tensor.scalar<float>()() = max_range_val;
+        // -1 (per tensor) or a valid axis, with min/max ranges that match it
+        int32_t axis = static_cast<int32_t>(axis_byte % (rank + 1)) - 1;
+        tf_fuzzer_utils::QuantizedTensor quantized =
+            tf_fuzzer_utils::makeQuantizedTensor(input_dtype, tensor_shape, axis, data, offset, size);
+        tensorflow::Tensor& input_tensor = quantized.value;
+        tensorflow::Tensor& min_range_tensor = quantized.min_range;
+        tensorflow::Tensor& max_range_tensor = quantized.max_range;
 
         auto input_op = tensorflow::ops::Const(root, input_tensor);
         auto min_range_op = tensorflow::ops::Const(root, min_range_tensor);
@@ -222,7 +130,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
 
         auto dequantize_op = tensorflow::ops::Dequantize(root, input_op, min_range_op, max_range_op, dequantize_attrs);
 
-        tensorflow::ClientSession session(root);
+        tensorflow::ClientSession session(root, tf_fuzzer_utils::makeSessionOptions());
         std::vector<tensorflow::Tensor> outputs;
         tensorflow::Status status = session.Run({dequantize_op}, &outputs);
         
@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/data_flow_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype; 
     switch (selector % 21) {  
@@ -93,139 +85,90 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
+}
 
-    return shape;
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    tf_fuzzer_utils::fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
-
-        uint8_t num_component_types = (data[offset++] % 5) + 1;
-        
+        uint8_t num_components = (data[offset++] % 3) + 1;
         std::vector<tensorflow::DataType> component_types;
-        for (uint8_t i = 0; i < num_component_types; ++i) {
-            if (offset >= size) break;
-            tensorflow::DataType dtype = parseDataType(data[offset++]);
-            component_types.push_back(dtype);
+        std::vector<std::vector<int64_t>> shapes;
+        for (uint8_t i = 0; i < num_components; ++i) {
+            if (offset >= size) return 0;
+            component_types.push_back(parseDataType(data[offset++]));
+            if (offset >= size) return 0;
+            uint8_t rank = parseRank(data[offset++]);
+            std::vector<int64_t> shape = parseShape(data, offset, size, rank);
+            shapes.push_back(shape);
         }
-        
-        if (component_types.empty()) {
-            component_types.push_back(tensorflow::DT_FLOAT);
+        bool declare_shapes = (offset < size) ? (data[offset++] % 2 == 1) : true;
+        std::vector<tensorflow::PartialTensorShape> queue_shapes;
+        for (size_t i = 0; declare_shapes && i < shapes.size(); ++i) {
+            queue_shapes.emplace_back(shapes[i]);
         }
-
-        std::vector<tensorflow::PartialTensorShape> shapes;
-        if (offset < size) {
-            uint8_t use_shapes = data[offset++] % 2;
-            if (use_shapes) {
-                for (size_t i = 0; i < component_types.size() && offset < size; ++i) {
-                    uint8_t rank = parseRank(data[offset++]);
-                    std::vector<int64_t> shape_dims = parseShape(data, offset, size, rank);
-                    tensorflow::PartialTensorShape shape(shape_dims);
-                    shapes.push_back(shape);
-                }
-            }
-        }
-
-        int32_t capacity = -1;
-        if (offset + sizeof(int32_t) <= size) {
-            std::memcpy(&capacity, data + offset, sizeof(int32_t));
-            offset += sizeof(int32_t);
-            capacity = capacity % 1000;
-            if (capacity < -1) capacity = -1;
+        // Unbounded or room for two; a zero capacity would block every enqueue.
+        int64_t capacity = (offset < size && data[offset++] % 2 == 1) ? 2 : -1;
+
+        // The queue lives in the runtime's per-input container.
+        std::vector<tensorflow::Tensor> queue;
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("FIFOQueueV2")
+                .attr("component_types", component_types)
+                .attr("shapes", queue_shapes)
+                .attr("capacity", capacity),
+            {}, &queue);
+        if (!status.ok()) {
+            return -1;
         }
+        std::vector<tensorflow::Tensor> outputs;
 
-        std::string container = "";
-        if (offset < size) {
-            uint8_t container_len = data[offset++] % 10;
-            if (offset + container_len <= size) {
-                container = std::string(reinterpret_cast<const char*>(data + offset), container_len);
-                offset += container_len;
-            }
+        std::vector<tensorflow::Tensor> enqueue_inputs = {queue[0]};
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            enqueue_inputs.push_back(makeTensor(component_types[i], shapes[i], data, offset, size));
         }
-
-        std::string shared_name = "";
-        if (offset < size) {
-            uint8_t shared_name_len = data[offset++] % 10;
-            if (offset + shared_name_len <= size) {
-                shared_name = std::string(reinterpret_cast<const char*>(data + offset), shared_name_len);
-                offset += shared_name_len;
-            }
+        status = tf_fuzzer_utils::runOp(tf_fuzzer_utils::OpSpec("QueueEnqueueV2"), enqueue_inputs, &outputs);
+        if (!status.ok()) {
+            return -1;
         }
 
-        std::cout << "Creating FIFOQueue with:" << std::endl;
-        std::cout << "  component_types size: " << component_types.size() << std::endl;
-        std::cout << "  shapes size: " << shapes.size() << std::endl;
-        std::cout << "  capacity: " << capacity << std::endl;
-        std::cout << "  container: " << container << std::endl;
-        std::cout << "  shared_name: " << shared_name << std::endl;
-
-        auto fifo_queue_attrs = tensorflow::ops::FIFOQueue::Attrs()
-            .Capacity(capacity)
-            .Container(container)
-            .SharedName(shared_name);
-
-        if (!shapes.empty()) {
-            fifo_queue_attrs = fifo_queue_attrs.Shapes(shapes);
+        status = tf_fuzzer_utils::runOp(tf_fuzzer_utils::OpSpec("QueueSizeV2"), {queue[0]}, &outputs);
+        if (!status.ok()) {
+            return -1;
         }
 
-        auto fifo_queue = tensorflow::ops::FIFOQueue(
-            root,
-            component_types,
-            fifo_queue_attrs
-        );
-
-        tensorflow::ClientSession session(root);
-        std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({fifo_queue}, &outputs);
+        // Closed first, so the dequeue returns instead of waiting for elements.
+        status = tf_fuzzer_utils::runOp(tf_fuzzer_utils::OpSpec("QueueCloseV2"), {queue[0]}, &outputs);
         if (!status.ok()) {
-            std::cout << "Error running session: " << status.ToString() << std::endl;
             return -1;
         }
-
-        if (!outputs.empty()) {
-            std::cout << "FIFOQueue output tensor shape: " << outputs[0].shape().DebugString() << std::endl;
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("QueueDequeueV2").attr("component_types", component_types),
+            {queue[0]}, &outputs);
+        if (!status.ok()) {
+            return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
-    } 
+    }
 
     return 0;
 }
@@ -1,14 +1,12 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/core/framework/resource_handle.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -18,12 +16,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype; 
     switch (selector % 21) {  
@@ -95,57 +87,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -221,61 +171,85 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
-        tensorflow::Tensor resource_tensor(tensorflow::DT_RESOURCE, tensorflow::TensorShape({}));
-        
-        tensorflow::ResourceHandle handle;
-        handle.set_device("/cpu:0");
-        handle.set_container("test_container");
-        handle.set_name("test_resource");
-        handle.set_hash_code(12345);
-        handle.set_maybe_type_name("FakeQueue");
-        
-        resource_tensor.scalar<tensorflow::ResourceHandle>()() = handle;
-        
-        auto resource_input = tensorflow::ops::Const(root, resource_tensor);
-        
-        std::cout << "Resource tensor created with handle: " << handle.DebugString() << std::endl;
-        
-        // Use raw_ops.FakeQueue through the NodeBuilder API
-        tensorflow::NodeBuilder node_builder("fake_queue", "FakeQueue");
-        node_builder.Input(resource_input.node());
-        
-        tensorflow::Node* fake_queue_node;
-        tensorflow::Status status = node_builder.Finalize(root.graph(), &fake_queue_node);
+        uint8_t num_components = (data[offset++] % 3) + 1;
+        std::vector<tensorflow::DataType> component_types;
+        std::vector<std::vector<int64_t>> shapes;
+        for (uint8_t i = 0; i < num_components; ++i) {
+            if (offset >= size) return 0;
+            component_types.push_back(parseDataType(data[offset++]));
+            if (offset >= size) return 0;
+            uint8_t rank = parseRank(data[offset++]);
+            std::vector<int64_t> shape = parseShape(data, offset, size, rank);
+            shapes.push_back(shape);
+        }
+        bool declare_shapes = (offset < size) ? (data[offset++] % 2 == 1) : true;
+        std::vector<tensorflow::PartialTensorShape> queue_shapes;
+        for (size_t i = 0; declare_shapes && i < shapes.size(); ++i) {
+            queue_shapes.emplace_back(shapes[i]);
+        }
+
+        // The queue lives in the runtime's per-input container.
+        std::vector<tensorflow::Tensor> queue;
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("FIFOQueueV2")
+                .attr("component_types", component_types)
+                .attr("shapes", queue_shapes),
+            {}, &queue);
         if (!status.ok()) {
-            std::cout << "Error creating FakeQueue node: " << status.ToString() << std::endl;
             return -1;
         }
-        
-        tensorflow::Output fake_queue_op(fake_queue_node, 0);
-        
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        
-        status = session.Run({fake_queue_op}, &outputs);
+        // FakeQueue gives the V2 queue a string handle for the V1 ops.
+        status = tf_fuzzer_utils::runOp(tf_fuzzer_utils::OpSpec("FakeQueue"), {queue[0]}, &outputs);
         if (!status.ok()) {
-            std::cout << "Error running session: " << status.ToString() << std::endl;
             return -1;
         }
-        
-        if (!outputs.empty()) {
-            std::cout << "FakeQueue output tensor shape: " << outputs[0].shape().DebugString() << std::endl;
-            std::cout << "FakeQueue output tensor dtype: " << tensorflow::DataTypeString(outputs[0].dtype()) << std::endl;
+        tensorflow::Tensor fake_handle = outputs[0];
+
+        std::vector<tensorflow::Tensor> enqueue_inputs = {fake_handle};
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            enqueue_inputs.push_back(makeTensor(component_types[i], shapes[i], data, offset, size));
+        }
+        status = tf_fuzzer_utils::runOp(tf_fuzzer_utils::OpSpec("QueueEnqueue"), enqueue_inputs, &outputs);
+        if (!status.ok()) {
+            return -1;
+        }
+
+        status = tf_fuzzer_utils::runOp(tf_fuzzer_utils::OpSpec("QueueSize"), {fake_handle}, &outputs);
+        if (!status.ok()) {
+            return -1;
         }
 
+        // Closed first, so the dequeue returns instead of waiting for elements.
+        status = tf_fuzzer_utils::runOp(tf_fuzzer_utils::OpSpec("QueueClose"), {fake_handle}, &outputs);
+        if (!status.ok()) {
+            return -1;
+        }
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("QueueDequeue").attr("component_types", component_types),
+            {fake_handle}, &outputs);
+        if (!status.ok()) {
+            return -1;
+        }
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
-    } 
+    }
 
     return 0;
 }
@@ -1,24 +1,16 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
-#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
 #include <array>
 #include <algorithm>
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* /*data*/, size_t /*size*/) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}  // namespace tf_fuzzer_utils
-
 std::string ConsumeString(const uint8_t* data, size_t& offset, size_t size) {
     if (offset >= size) return "file";
     const size_t remaining = size - offset;
@@ -47,12 +39,11 @@ int64_t ConsumeBoundedInt(const uint8_t* data, size_t& offset, size_t size,
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    FUZZ_TRACE_INPUT();
     if (size == 0) return 0;
 
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         int filename_count = 1;
         if (offset < size) {
@@ -86,32 +77,11 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         const size_t compression_index = offset < size ? (data[offset++] % kCompressionTypes.size()) : 0;
         compression_tensor.scalar<tensorflow::tstring>()() = kCompressionTypes[compression_index];
 
-        auto filenames_input = tensorflow::ops::Const(root.WithOpName("filenames"), filenames_tensor);
-        auto header_bytes_input = tensorflow::ops::Const(root.WithOpName("header_bytes"), header_bytes_tensor);
-        auto record_bytes_input = tensorflow::ops::Const(root.WithOpName("record_bytes"), record_bytes_tensor);
-        auto footer_bytes_input = tensorflow::ops::Const(root.WithOpName("footer_bytes"), footer_bytes_tensor);
-        auto buffer_size_input = tensorflow::ops::Const(root.WithOpName("buffer_size"), buffer_size_tensor);
-        auto compression_input = tensorflow::ops::Const(root.WithOpName("compression_type"), compression_tensor);
-
-        tensorflow::Node* dataset_node = nullptr;
-        auto status = tensorflow::NodeBuilder(
-                          root.GetUniqueNameForOp("FixedLengthRecordDatasetV2"), "FixedLengthRecordDatasetV2")
-                          .Input(filenames_input.node())
-                          .Input(header_bytes_input.node())
-                          .Input(record_bytes_input.node())
-                          .Input(footer_bytes_input.node())
-                          .Input(buffer_size_input.node())
-                          .Input(compression_input.node())
-                          .Attr("metadata", "")
-                          .Finalize(root.graph(), &dataset_node);
-        if (!status.ok()) {
-            tf_fuzzer_utils::logError(status.ToString(), data, size);
-            return 0;
-        }
-
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        status = session.Run({tensorflow::Output(dataset_node, 0)}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("FixedLengthRecordDatasetV2").attr("metadata", std::string("")),
+            {filenames_tensor, header_bytes_tensor, record_bytes_tensor, footer_bytes_tensor,
+             buffer_size_tensor, compression_tensor}, &outputs);
         if (!status.ok()) {
             return 0;
         }
@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/nn_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -16,68 +14,20 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     return tensorflow::DT_FLOAT;
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-  auto flat = tensor.flat<T>();
-  const size_t num_elements = flat.size();
-  const size_t element_size = sizeof(T);
-
-  for (size_t i = 0; i < num_elements; ++i) {
-    if (offset + element_size <= total_size) {
-      T value;
-      std::memcpy(&value, data + offset, element_size);
-      offset += element_size;
-      flat(i) = value;
-    } else {
-      flat(i) = T{};
-    }
-  }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -93,13 +43,11 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 50) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
         
@@ -131,12 +79,6 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         fillTensorWithDataByType(mean_tensor, dtype, data, offset, size);
         fillTensorWithDataByType(variance_tensor, dtype, data, offset, size);
         
-        auto x_placeholder = tensorflow::ops::Placeholder(root, dtype);
-        auto scale_placeholder = tensorflow::ops::Placeholder(root, dtype);
-        auto offset_placeholder = tensorflow::ops::Placeholder(root, dtype);
-        auto mean_placeholder = tensorflow::ops::Placeholder(root, dtype);
-        auto variance_placeholder = tensorflow::ops::Placeholder(root, dtype);
-        
         float epsilon = 0.0001f;
         if (offset < size) {
             float eps_val;
@@ -170,33 +112,14 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             is_training = (data[offset] % 2 == 0);
         }
         
-        auto fused_batch_norm = tensorflow::ops::FusedBatchNorm(
-            root,
-            x_placeholder,
-            scale_placeholder,
-            offset_placeholder,
-            mean_placeholder,
-            variance_placeholder,
-            tensorflow::ops::FusedBatchNorm::Attrs()
-                .Epsilon(epsilon)
-                .ExponentialAvgFactor(exponential_avg_factor)
-                .DataFormat(data_format)
-                .IsTraining(is_training)
-        );
-        
-        tensorflow::ClientSession session(root);
-        
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run(
-            {{x_placeholder, x_tensor},
-             {scale_placeholder, scale_tensor},
-             {offset_placeholder, offset_tensor},
-             {mean_placeholder, mean_tensor},
-             {variance_placeholder, variance_tensor}},
-            {fused_batch_norm.y, fused_batch_norm.batch_mean, fused_batch_norm.batch_variance,
-             fused_batch_norm.reserve_space_1, fused_batch_norm.reserve_space_2},
-            &outputs
-        );
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("FusedBatchNorm")
+                .attr("epsilon", epsilon)
+                .attr("exponential_avg_factor", exponential_avg_factor)
+                .attr("data_format", data_format)
+                .attr("is_training", is_training),
+            {x_tensor, scale_tensor, offset_tensor, mean_tensor, variance_tensor}, &outputs);
         
         if (!status.ok()) {
             return -1;
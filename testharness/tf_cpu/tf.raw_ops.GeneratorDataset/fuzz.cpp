@@ -1,18 +1,12 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/dataset_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/function.h"
-#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/tensor_shape.h"
-#include "tensorflow/core/platform/types.h"
-#include "tensorflow/core/framework/op.h"
-#include "tensorflow/core/framework/op_kernel.h"
-#include "tensorflow/core/framework/shape_inference.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -22,12 +16,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype; 
     switch (selector % 21) {  
@@ -99,57 +87,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -224,97 +170,92 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// name(args...) -> the args listed in `returned`, in that order.
+tensorflow::FunctionDef forwardingFunction(const std::string& name, const std::vector<tensorflow::DataType>& arg_types,
+                                           const std::vector<int>& returned) {
+    tensorflow::FunctionDef fdef;
+    tensorflow::OpDef* signature = fdef.mutable_signature();
+    signature->set_name(name);
+    for (size_t i = 0; i < arg_types.size(); ++i) {
+        tensorflow::OpDef::ArgDef* arg = signature->add_input_arg();
+        arg->set_name("arg_" + std::to_string(i));
+        arg->set_type(arg_types[i]);
+    }
+    for (size_t i = 0; i < returned.size(); ++i) {
+        const std::string out = "out_" + std::to_string(i);
+        tensorflow::OpDef::ArgDef* arg = signature->add_output_arg();
+        arg->set_name(out);
+        arg->set_type(arg_types[returned[i]]);
+        (*fdef.mutable_ret())[out] = "arg_" + std::to_string(returned[i]);
+    }
+    return fdef;
+}
+
+// Reads up to `count` tensors of fuzzed dtype and shape.
+std::vector<tensorflow::Tensor> parseArguments(uint8_t count, const uint8_t* data, size_t& offset, size_t size) {
+    std::vector<tensorflow::Tensor> arguments;
+    for (uint8_t i = 0; i < count && offset + 1 < size; ++i) {
+        tensorflow::DataType dtype = parseDataType(data[offset++]);
+        uint8_t rank = parseRank(data[offset++]);
+        std::vector<int64_t> shape = parseShape(data, offset, size, rank);
+
+        tensorflow::TensorShape tensor_shape;
+        for (int64_t dim : shape) {
+            tensor_shape.AddDim(dim);
+        }
+
+        tensorflow::Tensor tensor(dtype, tensor_shape);
+        fillTensorWithDataByType(tensor, dtype, data, offset, size);
+        arguments.push_back(tensor);
+    }
+    return arguments;
+}
+
+std::vector<tensorflow::DataType> dtypesOf(const std::vector<tensorflow::Tensor>& tensors) {
+    std::vector<tensorflow::DataType> dtypes;
+    for (const auto& tensor : tensors) {
+        dtypes.push_back(tensor.dtype());
+    }
+    return dtypes;
+}
+
+std::vector<int> allArguments(size_t count) {
+    std::vector<int> returned(count);
+    for (size_t i = 0; i < count; ++i) {
+        returned[i] = static_cast<int>(i);
+    }
+    return returned;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         uint8_t num_init_args = data[offset++] % 3;
-        uint8_t num_next_args = data[offset++] % 3;
+        // next_func returns the state and its own arguments, so it needs at
+        // least one of them to produce an element.
+        uint8_t num_next_args = data[offset++] % 2 + 1;
         uint8_t num_finalize_args = data[offset++] % 3;
-        uint8_t num_output_types = data[offset++] % 3 + 1;
-
-        std::vector<tensorflow::Output> init_func_other_args;
-        for (uint8_t i = 0; i < num_init_args; ++i) {
-            if (offset >= size) break;
-            tensorflow::DataType dtype = parseDataType(data[offset++]);
-            if (offset >= size) break;
-            uint8_t rank = parseRank(data[offset++]);
-            std::vector<int64_t> shape = parseShape(data, offset, size, rank);
-            
-            tensorflow::TensorShape tensor_shape;
-            for (int64_t dim : shape) {
-                tensor_shape.AddDim(dim);
-            }
-            
-            tensorflow::Tensor tensor(dtype, tensor_shape);
-            fillTensorWithDataByType(tensor, dtype, data, offset, size);
-            
-            auto const_op = tensorflow::ops::Const(root, tensor);
-            init_func_other_args.push_back(const_op);
-        }
-
-        std::vector<tensorflow::Output> next_func_other_args;
-        for (uint8_t i = 0; i < num_next_args; ++i) {
-            if (offset >= size) break;
-            tensorflow::DataType dtype = parseDataType(data[offset++]);
-            if (offset >= size) break;
-            uint8_t rank = parseRank(data[offset++]);
-            std::vector<int64_t> shape = parseShape(data, offset, size, rank);
-            
-            tensorflow::TensorShape tensor_shape;
-            for (int64_t dim : shape) {
-                tensor_shape.AddDim(dim);
-            }
-            
-            tensorflow::Tensor tensor(dtype, tensor_shape);
-            fillTensorWithDataByType(tensor, dtype, data, offset, size);
-            
-            auto const_op = tensorflow::ops::Const(root, tensor);
-            next_func_other_args.push_back(const_op);
-        }
-
-        std::vector<tensorflow::Output> finalize_func_other_args;
-        for (uint8_t i = 0; i < num_finalize_args; ++i) {
-            if (offset >= size) break;
-            tensorflow::DataType dtype = parseDataType(data[offset++]);
-            if (offset >= size) break;
-            uint8_t rank = parseRank(data[offset++]);
-            std::vector<int64_t> shape = parseShape(data, offset, size, rank);
-            
-            tensorflow::TensorShape tensor_shape;
-            for (int64_t dim : shape) {
-                tensor_shape.AddDim(dim);
-            }
-            
-            tensorflow::Tensor tensor(dtype, tensor_shape);
-            fillTensorWithDataByType(tensor, dtype, data, offset, size);
-            
-            auto const_op = tensorflow::ops::Const(root, tensor);
-            finalize_func_other_args.push_back(const_op);
-        }
 
-        std::vector<tensorflow::DataType> output_types;
-        for (uint8_t i = 0; i < num_output_types; ++i) {
-            if (offset >= size) break;
-            tensorflow::DataType dtype = parseDataType(data[offset++]);
-            output_types.push_back(dtype);
-        }
+        std::vector<tensorflow::Tensor> init_func_other_args = parseArguments(num_init_args, data, offset, size);
+        std::vector<tensorflow::Tensor> next_func_other_args = parseArguments(num_next_args, data, offset, size);
+        std::vector<tensorflow::Tensor> finalize_func_other_args = parseArguments(num_finalize_args, data, offset, size);
 
-        std::vector<tensorflow::PartialTensorShape> output_shapes;
-        for (uint8_t i = 0; i < num_output_types; ++i) {
-            if (offset >= size) break;
-            uint8_t rank = parseRank(data[offset++]);
-            std::vector<int64_t> shape = parseShape(data, offset, size, rank);
-            tensorflow::PartialTensorShape partial_shape;
-            for (int64_t dim : shape) {
-                partial_shape.AddDim(dim);
-            }
-            output_shapes.push_back(partial_shape);
+        // init_func(init...) -> state = init...
+        // next_func(state..., next...) -> element = (state..., next...)
+        // finalize_func(state..., finalize...) -> (state..., finalize...), ignored
+        std::vector<tensorflow::DataType> init_types = dtypesOf(init_func_other_args);
+        std::vector<tensorflow::DataType> next_types = dtypesOf(next_func_other_args);
+        std::vector<tensorflow::DataType> finalize_types = dtypesOf(finalize_func_other_args);
+        std::vector<tensorflow::DataType> next_func_types = init_types;
+        next_func_types.insert(next_func_types.end(), next_types.begin(), next_types.end());
+        std::vector<tensorflow::DataType> finalize_func_types = init_types;
+        finalize_func_types.insert(finalize_func_types.end(), finalize_types.begin(), finalize_types.end());
+        if (next_func_types.empty()) {
+            return 0;
         }
 
         tensorflow::NameAttrList init_func;
@@ -326,57 +267,29 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         tensorflow::NameAttrList finalize_func;
         finalize_func.set_name("finalize_func");
 
-        // Use raw_ops approach instead of ops::GeneratorDataset
-        tensorflow::Node* generator_dataset_node = nullptr;
-        tensorflow::Status status;
-        
-        // Create inputs for the GeneratorDataset op
-        std::vector<tensorflow::Node*> init_args_nodes;
-        for (const auto& arg : init_func_other_args) {
-            init_args_nodes.push_back(arg.node());
-        }
-        
-        std::vector<tensorflow::Node*> next_args_nodes;
-        for (const auto& arg : next_func_other_args) {
-            next_args_nodes.push_back(arg.node());
-        }
-        
-        std::vector<tensorflow::Node*> finalize_args_nodes;
-        for (const auto& arg : finalize_func_other_args) {
-            finalize_args_nodes.push_back(arg.node());
-        }
-        
-        // Create a placeholder dataset to use instead
-        tensorflow::Tensor tensor_shape_tensor(tensorflow::DT_INT64, tensorflow::TensorShape({1}));
-        tensor_shape_tensor.flat<int64_t>()(0) = 10;
-        auto tensor_shape_op = tensorflow::ops::Const(root, tensor_shape_tensor);
-        
-        auto range_dataset = tensorflow::ops::RangeDataset(
-            root,
-            tensorflow::ops::Const(root, 0),
-            tensorflow::ops::Const(root, 10),
-            tensorflow::ops::Const(root, 1),
-            {tensorflow::DT_INT64},
-            {{1}}
-        );
-        
-        // Create a map dataset as a substitute
-        tensorflow::NameAttrList map_func;
-        map_func.set_name("identity");
-        
-        auto map_dataset = tensorflow::ops::MapDataset(
-            root,
-            range_dataset,
-            {},
-            map_func,
-            output_types,
-            output_shapes,
-            false
-        );
+        tf_fuzzer_utils::DatasetSpec spec(
+            tf_fuzzer_utils::OpSpec("GeneratorDataset")
+                .attr("init_func", init_func)
+                .attr("next_func", next_func)
+                .attr("finalize_func", finalize_func)
+                .attr("Tinit_func_args", init_types)
+                .attr("Tnext_func_args", next_types)
+                .attr("Tfinalize_func_args", finalize_types)
+                .attr("output_types", next_func_types)
+                .attr("output_shapes", std::vector<tensorflow::PartialTensorShape>(next_func_types.size())));
+        spec.function(forwardingFunction("init_func", init_types, allArguments(init_types.size())))
+            .function(forwardingFunction("next_func", next_func_types, allArguments(next_func_types.size())))
+            .function(forwardingFunction("finalize_func", finalize_func_types,
+                                         allArguments(finalize_func_types.size())));
+
+        std::vector<tensorflow::Tensor> inputs = init_func_other_args;
+        inputs.insert(inputs.end(), next_func_other_args.begin(), next_func_other_args.end());
+        inputs.insert(inputs.end(), finalize_func_other_args.begin(), finalize_func_other_args.end());
 
-        tensorflow::ClientSession session(root);
+        // next_func never signals the end, so runDataset stops after
+        // TF_FUZZ_DATASET_MAX_ELEMENTS elements.
         std::vector<tensorflow::Tensor> outputs;
-        status = session.Run({map_dataset}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runDataset(spec, {}, inputs, &outputs);
         if (!status.ok()) {
             return -1;
         }
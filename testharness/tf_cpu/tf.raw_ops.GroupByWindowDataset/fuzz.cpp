@@ -1,34 +1,21 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/dataset_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/function.h"
-#include "tensorflow/core/framework/node_def_builder.h"
-#include "tensorflow/core/framework/op_def_builder.h"
-#include "tensorflow/core/graph/default_device.h"
-#include "tensorflow/core/common_runtime/function.h"
-#include "tensorflow/core/framework/function.pb.h"
-#include "tensorflow/core/lib/core/errors.h"
-#include "tensorflow/core/platform/env.h"
-#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
-#include <iostream>
 #include <vector>
-#include <cmath>
+#include <iostream>
 
 #define MAX_RANK 4
 #define MIN_RANK 0
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype; 
     switch (selector % 21) {  
@@ -100,57 +87,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -225,16 +170,72 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// name(args...) -> the args listed in `returned`, in that order.
+tensorflow::FunctionDef forwardingFunction(const std::string& name, const std::vector<tensorflow::DataType>& arg_types,
+                                           const std::vector<int>& returned) {
+    tensorflow::FunctionDef fdef;
+    tensorflow::OpDef* signature = fdef.mutable_signature();
+    signature->set_name(name);
+    for (size_t i = 0; i < arg_types.size(); ++i) {
+        tensorflow::OpDef::ArgDef* arg = signature->add_input_arg();
+        arg->set_name("arg_" + std::to_string(i));
+        arg->set_type(arg_types[i]);
+    }
+    for (size_t i = 0; i < returned.size(); ++i) {
+        const std::string out = "out_" + std::to_string(i);
+        tensorflow::OpDef::ArgDef* arg = signature->add_output_arg();
+        arg->set_name(out);
+        arg->set_type(arg_types[returned[i]]);
+        (*fdef.mutable_ret())[out] = "arg_" + std::to_string(returned[i]);
+    }
+    return fdef;
+}
+
+// Reads up to `count` tensors of fuzzed dtype and shape.
+std::vector<tensorflow::Tensor> parseArguments(uint8_t count, const uint8_t* data, size_t& offset, size_t size) {
+    std::vector<tensorflow::Tensor> arguments;
+    for (uint8_t i = 0; i < count && offset + 1 < size; ++i) {
+        tensorflow::DataType dtype = parseDataType(data[offset++]);
+        uint8_t rank = parseRank(data[offset++]);
+        std::vector<int64_t> shape = parseShape(data, offset, size, rank);
+
+        tensorflow::TensorShape tensor_shape;
+        for (int64_t dim : shape) {
+            tensor_shape.AddDim(dim);
+        }
+
+        tensorflow::Tensor tensor(dtype, tensor_shape);
+        fillTensorWithDataByType(tensor, dtype, data, offset, size);
+        arguments.push_back(tensor);
+    }
+    return arguments;
+}
+
+std::vector<tensorflow::DataType> dtypesOf(const std::vector<tensorflow::Tensor>& tensors) {
+    std::vector<tensorflow::DataType> dtypes;
+    for (const auto& tensor : tensors) {
+        dtypes.push_back(tensor.dtype());
+    }
+    return dtypes;
+}
+
+std::vector<int> allArguments(size_t count) {
+    std::vector<int> returned(count);
+    for (size_t i = 0; i < count; ++i) {
+        returned[i] = static_cast<int>(i);
+    }
+    return returned;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
     
     size_t offset = 0;
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
 
     try {
         tensorflow::DataType input_dtype = parseDataType(data[offset++]);
-        uint8_t input_rank = parseRank(data[offset++]);
+        uint8_t input_rank = tf_fuzzer_utils::parseRank(data[offset++], 1, MAX_RANK);
         std::vector<int64_t> input_shape = parseShape(data, offset, size, input_rank);
         
         tensorflow::TensorShape input_tensor_shape;
@@ -242,67 +243,40 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             input_tensor_shape.AddDim(dim);
         }
         
+        // The input dataset yields (slice, key) pairs of these two tensors.
         tensorflow::Tensor input_tensor(input_dtype, input_tensor_shape);
         fillTensorWithDataByType(input_tensor, input_dtype, data, offset, size);
-        
-        auto input_dataset = tensorflow::ops::Placeholder(root.WithOpName("input_dataset"), tensorflow::DT_VARIANT);
+
+        // Keys double as window sizes, so they stay in [1, 4].
+        tensorflow::Tensor keys(tensorflow::DT_INT64, tensorflow::TensorShape({input_shape[0]}));
+        auto keys_flat = keys.flat<int64_t>();
+        for (int64_t i = 0; i < input_shape[0]; ++i) {
+            keys_flat(i) = (offset < size) ? data[offset++] % 4 + 1 : 1;
+        }
         
         uint8_t num_key_args = (offset < size) ? data[offset++] % 3 : 0;
-        tensorflow::OutputList key_func_other_arguments;
-        for (uint8_t i = 0; i < num_key_args && offset < size; ++i) {
-            tensorflow::DataType arg_dtype = parseDataType(data[offset++]);
-            uint8_t arg_rank = parseRank(data[offset++]);
-            std::vector<int64_t> arg_shape = parseShape(data, offset, size, arg_rank);
-            
-            tensorflow::TensorShape arg_tensor_shape;
-            for (int64_t dim : arg_shape) {
-                arg_tensor_shape.AddDim(dim);
-            }
-            
-            tensorflow::Tensor arg_tensor(arg_dtype, arg_tensor_shape);
-            fillTensorWithDataByType(arg_tensor, arg_dtype, data, offset, size);
-            
-            auto arg_placeholder = tensorflow::ops::Placeholder(root.WithOpName("key_arg_" + std::to_string(i)), arg_dtype);
-            key_func_other_arguments.push_back(arg_placeholder);
-        }
+        std::vector<tensorflow::Tensor> key_func_other_arguments = parseArguments(num_key_args, data, offset, size);
         
         uint8_t num_reduce_args = (offset < size) ? data[offset++] % 3 : 0;
-        tensorflow::OutputList reduce_func_other_arguments;
-        for (uint8_t i = 0; i < num_reduce_args && offset < size; ++i) {
-            tensorflow::DataType arg_dtype = parseDataType(data[offset++]);
-            uint8_t arg_rank = parseRank(data[offset++]);
-            std::vector<int64_t> arg_shape = parseShape(data, offset, size, arg_rank);
-            
-            tensorflow::TensorShape arg_tensor_shape;
-            for (int64_t dim : arg_shape) {
-                arg_tensor_shape.AddDim(dim);
-            }
-            
-            tensorflow::Tensor arg_tensor(arg_dtype, arg_tensor_shape);
-            fillTensorWithDataByType(arg_tensor, arg_dtype, data, offset, size);
-            
-            auto arg_placeholder = tensorflow::ops::Placeholder(root.WithOpName("reduce_arg_" + std::to_string(i)), arg_dtype);
-            reduce_func_other_arguments.push_back(arg_placeholder);
-        }
+        std::vector<tensorflow::Tensor> reduce_func_other_arguments =
+            parseArguments(num_reduce_args, data, offset, size);
         
         uint8_t num_window_args = (offset < size) ? data[offset++] % 3 : 0;
-        tensorflow::OutputList window_size_func_other_arguments;
-        for (uint8_t i = 0; i < num_window_args && offset < size; ++i) {
-            tensorflow::DataType arg_dtype = parseDataType(data[offset++]);
-            uint8_t arg_rank = parseRank(data[offset++]);
-            std::vector<int64_t> arg_shape = parseShape(data, offset, size, arg_rank);
-            
-            tensorflow::TensorShape arg_tensor_shape;
-            for (int64_t dim : arg_shape) {
-                arg_tensor_shape.AddDim(dim);
-            }
-            
-            tensorflow::Tensor arg_tensor(arg_dtype, arg_tensor_shape);
-            fillTensorWithDataByType(arg_tensor, arg_dtype, data, offset, size);
-            
-            auto arg_placeholder = tensorflow::ops::Placeholder(root.WithOpName("window_arg_" + std::to_string(i)), arg_dtype);
-            window_size_func_other_arguments.push_back(arg_placeholder);
-        }
+        std::vector<tensorflow::Tensor> window_size_func_other_arguments =
+            parseArguments(num_window_args, data, offset, size);
+
+        // key_func(slice, key, key_args...) -> key
+        // reduce_func(key, window, reduce_args...) -> window
+        // window_size_func(key, window_args...) -> key
+        std::vector<tensorflow::DataType> key_types = dtypesOf(key_func_other_arguments);
+        std::vector<tensorflow::DataType> reduce_types = dtypesOf(reduce_func_other_arguments);
+        std::vector<tensorflow::DataType> window_types = dtypesOf(window_size_func_other_arguments);
+        std::vector<tensorflow::DataType> key_func_types = {input_dtype, tensorflow::DT_INT64};
+        key_func_types.insert(key_func_types.end(), key_types.begin(), key_types.end());
+        std::vector<tensorflow::DataType> reduce_func_types = {tensorflow::DT_INT64, tensorflow::DT_VARIANT};
+        reduce_func_types.insert(reduce_func_types.end(), reduce_types.begin(), reduce_types.end());
+        std::vector<tensorflow::DataType> window_size_func_types = {tensorflow::DT_INT64};
+        window_size_func_types.insert(window_size_func_types.end(), window_types.begin(), window_types.end());
         
         tensorflow::NameAttrList key_func;
         key_func.set_name("key_func");
@@ -312,87 +286,28 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         
         tensorflow::NameAttrList window_size_func;
         window_size_func.set_name("window_size_func");
+
+        tf_fuzzer_utils::DatasetSpec spec(tf_fuzzer_utils::OpSpec("GroupByWindowDataset")
+                                              .attr("key_func", key_func)
+                                              .attr("reduce_func", reduce_func)
+                                              .attr("window_size_func", window_size_func)
+                                              .attr("Tkey_func_other_arguments", key_types)
+                                              .attr("Treduce_func_other_arguments", reduce_types)
+                                              .attr("Twindow_size_func_other_arguments", window_types));
+        spec.function(forwardingFunction("key_func", key_func_types, {1}))
+            .function(forwardingFunction("reduce_func", reduce_func_types, {1}))
+            .function(forwardingFunction("window_size_func", window_size_func_types, {0}));
+
+        std::vector<tensorflow::Tensor> inputs = key_func_other_arguments;
+        inputs.insert(inputs.end(), reduce_func_other_arguments.begin(), reduce_func_other_arguments.end());
+        inputs.insert(inputs.end(), window_size_func_other_arguments.begin(), window_size_func_other_arguments.end());
         
-        uint8_t num_output_types = (offset < size) ? (data[offset++] % 3) + 1 : 1;
-        tensorflow::DataTypeSlice output_types;
-        std::vector<tensorflow::DataType> output_types_vec;
-        for (uint8_t i = 0; i < num_output_types && offset < size; ++i) {
-            tensorflow::DataType out_dtype = parseDataType(data[offset++]);
-            output_types_vec.push_back(out_dtype);
-        }
-        output_types = tensorflow::DataTypeSlice(output_types_vec);
-        
-        std::vector<tensorflow::PartialTensorShape> output_shapes_vec;
-        for (uint8_t i = 0; i < num_output_types && offset < size; ++i) {
-            uint8_t out_rank = parseRank(data[offset++]);
-            std::vector<int64_t> out_shape = parseShape(data, offset, size, out_rank);
-            tensorflow::PartialTensorShape partial_shape;
-            for (int64_t dim : out_shape) {
-                partial_shape.AddDim(dim);
-            }
-            output_shapes_vec.push_back(partial_shape);
-        }
-        
-        std::string metadata = "";
-        
-        // Create a NodeDef for GroupByWindowDataset
-        tensorflow::NodeDef node_def;
-        node_def.set_name("group_by_window_dataset");
-        node_def.set_op("GroupByWindowDataset");
-        
-        // Add inputs to the NodeDef
-        node_def.add_input("input_dataset");
-        for (int i = 0; i < num_key_args; i++) {
-            node_def.add_input("key_arg_" + std::to_string(i));
-        }
-        for (int i = 0; i < num_reduce_args; i++) {
-            node_def.add_input("reduce_arg_" + std::to_string(i));
-        }
-        for (int i = 0; i < num_window_args; i++) {
-            node_def.add_input("window_arg_" + std::to_string(i));
-        }
-        
-        // Add attributes to the NodeDef
-        tensorflow::AttrValue key_func_attr;
-        *key_func_attr.mutable_func() = key_func;
-        node_def.mutable_attr()->insert({"key_func", key_func_attr});
-        
-        tensorflow::AttrValue reduce_func_attr;
-        *reduce_func_attr.mutable_func() = reduce_func;
-        node_def.mutable_attr()->insert({"reduce_func", reduce_func_attr});
-        
-        tensorflow::AttrValue window_size_func_attr;
-        *window_size_func_attr.mutable_func() = window_size_func;
-        node_def.mutable_attr()->insert({"window_size_func", window_size_func_attr});
-        
-        tensorflow::AttrValue output_types_attr;
-        for (const auto& dtype : output_types_vec) {
-            output_types_attr.mutable_list()->add_type(dtype);
-        }
-        node_def.mutable_attr()->insert({"output_types", output_types_attr});
-        
-        tensorflow::AttrValue output_shapes_attr;
-        for (const auto& shape : output_shapes_vec) {
-            tensorflow::TensorShapeProto shape_proto;
-            shape.AsProto(&shape_proto);
-            *output_shapes_attr.mutable_list()->add_shape() = shape_proto;
-        }
-        node_def.mutable_attr()->insert({"output_shapes", output_shapes_attr});
-        
-        tensorflow::AttrValue metadata_attr;
-        metadata_attr.set_s(metadata);
-        node_def.mutable_attr()->insert({"metadata", metadata_attr});
-        
-        // Add the node to the graph
-        tensorflow::Status status;
-        auto op = root.graph()->AddNode(node_def, &status);
+        std::vector<tensorflow::Tensor> outputs;
+        tensorflow::Status status = tf_fuzzer_utils::runDataset(spec, {input_tensor, keys}, inputs, &outputs);
         if (!status.ok()) {
-            tf_fuzzer_utils::logError("Failed to add GroupByWindowDataset node: " + status.ToString(), data, size);
             return -1;
         }
         
-        tensorflow::ClientSession session(root);
-        
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
@@ -1,6 +1,3 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/dataset_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
@@ -9,6 +6,7 @@
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -18,12 +16,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype; 
     switch (selector % 21) {  
@@ -95,57 +87,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -220,16 +170,35 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// f(x, captured...) -> x, the map function of the pipeline.
+tensorflow::FunctionDef identityFunction(tensorflow::DataType dtype, const std::vector<tensorflow::Tensor>& captured) {
+    tensorflow::FunctionDef fdef;
+    tensorflow::OpDef* signature = fdef.mutable_signature();
+    signature->set_name("identity_func");
+    tensorflow::OpDef::ArgDef* x = signature->add_input_arg();
+    x->set_name("x");
+    x->set_type(dtype);
+    for (size_t i = 0; i < captured.size(); ++i) {
+        tensorflow::OpDef::ArgDef* arg = signature->add_input_arg();
+        arg->set_name("captured_" + std::to_string(i));
+        arg->set_type(captured[i].dtype());
+    }
+    tensorflow::OpDef::ArgDef* y = signature->add_output_arg();
+    y->set_name("y");
+    y->set_type(dtype);
+    (*fdef.mutable_ret())["y"] = "x";
+    return fdef;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
     
     size_t offset = 0;
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
 
     try {
         tensorflow::DataType input_dtype = parseDataType(data[offset++]);
-        uint8_t input_rank = parseRank(data[offset++]);
+        uint8_t input_rank = tf_fuzzer_utils::parseRank(data[offset++], 1, MAX_RANK);
         std::vector<int64_t> input_shape = parseShape(data, offset, size, input_rank);
         
         tensorflow::TensorShape tensor_shape;
@@ -237,10 +206,12 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             tensor_shape.AddDim(dim);
         }
         
-        tensorflow::Tensor input_dataset_tensor(tensorflow::DT_VARIANT, tensorflow::TensorShape({}));
+        // The input dataset yields the slices of this tensor.
+        tensorflow::Tensor input_tensor(input_dtype, tensor_shape);
+        fillTensorWithDataByType(input_tensor, input_dtype, data, offset, size);
         
         uint8_t num_other_args = (offset < size) ? data[offset++] % 3 : 0;
-        std::vector<tensorflow::Output> other_arguments;
+        std::vector<tensorflow::Tensor> other_arguments;
         
         for (uint8_t i = 0; i < num_other_args && offset < size; ++i) {
             tensorflow::DataType arg_dtype = parseDataType(data[offset++]);
@@ -254,48 +225,25 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             
             tensorflow::Tensor arg_tensor(arg_dtype, arg_tensor_shape);
             fillTensorWithDataByType(arg_tensor, arg_dtype, data, offset, size);
-            
-            auto const_op = tensorflow::ops::Const(root, arg_tensor);
-            other_arguments.push_back(const_op);
+            other_arguments.push_back(arg_tensor);
         }
         
-        tensorflow::DataType output_dtype = parseDataType(data[offset < size ? offset++ : 0]);
-        uint8_t output_rank = parseRank(data[offset < size ? offset++ : 0]);
-        std::vector<int64_t> output_shape = parseShape(data, offset, size, output_rank);
-        
-        tensorflow::TensorShape output_tensor_shape;
-        for (int64_t dim : output_shape) {
-            output_tensor_shape.AddDim(dim);
-        }
-        
-        std::vector<tensorflow::DataType> output_types = {output_dtype};
-        std::vector<tensorflow::PartialTensorShape> output_shapes = {output_tensor_shape};
-        
         bool use_inter_op_parallelism = (offset < size) ? (data[offset++] % 2 == 0) : true;
         bool preserve_cardinality = (offset < size) ? (data[offset++] % 2 == 0) : false;
-        bool force_synchronous = (offset < size) ? (data[offset++] % 2 == 0) : false;
-        std::string metadata = "";
-        
-        auto input_dataset_const = tensorflow::ops::Const(root, input_dataset_tensor);
         
         tensorflow::NameAttrList f_attr;
         f_attr.set_name("identity_func");
         
-        auto map_dataset = tensorflow::ops::experimental::MapDataset(
-            root,
-            input_dataset_const,
-            other_arguments,
-            f_attr,
-            output_types,
-            output_shapes,
-            tensorflow::ops::experimental::MapDataset::UseInterOpParallelism(use_inter_op_parallelism)
-                .PreserveCardinality(preserve_cardinality)
-        );
-
-        tensorflow::ClientSession session(root);
-        std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({map_dataset}, &outputs);
+        tf_fuzzer_utils::DatasetSpec spec(tf_fuzzer_utils::OpSpec("MapDataset")
+                                              .attr("f", f_attr)
+                                              .attr("output_types", std::vector<tensorflow::DataType>{input_dtype})
+                                              .attr("output_shapes", std::vector<tensorflow::PartialTensorShape>(1))
+                                              .attr("use_inter_op_parallelism", use_inter_op_parallelism)
+                                              .attr("preserve_cardinality", preserve_cardinality));
+        spec.function(identityFunction(input_dtype, other_arguments));
         
+        std::vector<tensorflow::Tensor> outputs;
+        tensorflow::Status status = tf_fuzzer_utils::runDataset(spec, {input_tensor}, other_arguments, &outputs);
         if (!status.ok()) {
             return -1;
         }
@@ -1,12 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/array_ops.h"
-#include "tensorflow/cc/ops/nn_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -17,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-    void logError(const std::string& message, const uint8_t* data, size_t size) {
-        std::cerr << message << std::endl;
-    }
-}
-
 tensorflow::DataType parseQuantizedDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 5) {
@@ -46,93 +37,20 @@ tensorflow::DataType parseQuantizedDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
-}
-
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
-
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_FLOAT:
-            fillTensorWithData<float>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT8:
-            fillTensorWithData<tensorflow::qint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT8:
-            fillTensorWithData<tensorflow::quint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT32:
-            fillTensorWithData<tensorflow::qint32>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT16:
-            fillTensorWithData<tensorflow::qint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT16:
-            fillTensorWithData<tensorflow::quint16>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 50) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         tensorflow::DataType input_dtype = parseQuantizedDataType(data[offset++]);
         tensorflow::DataType filter_dtype = parseQuantizedDataType(data[offset++]);
@@ -160,57 +78,10 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             filter_tensor_shape.AddDim(dim);
         }
 
-        tensorflow::Tensor input_tensor(input_dtype, input_tensor_shape);
-        tensorflow::Tensor filter_tensor(filter_dtype, filter_tensor_shape);
-
-        fillTensorWithDataByType(input_tensor, input_dtype, data, offset, size);
-        fillTensorWithDataByType(filter_tensor, filter_dtype, data, offset, size);
-
-        float min_input_val = 0.0f;
-        float max_input_val = 1.0f;
-        float min_filter_val = 0.0f;
-        float max_filter_val = 1.0f;
-
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&min_input_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&max_input_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&min_filter_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&max_filter_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-
-        if (min_input_val >= max_input_val) {
-            max_input_val = min_input_val + 1.0f;
-        }
-        if (min_filter_val >= max_filter_val) {
-            max_filter_val = min_filter_val + 1.0f;
-        }
-
-        tensorflow::Tensor min_input_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        tensorflow::Tensor max_input_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        tensorflow::Tensor min_filter_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        tensorflow::Tensor max_filter_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-
-        min_input_tensor.scalar<float>()() = min_input_val;
-        max_input_tensor.scalar<float>()() = max_input_val;
-        min_filter_tensor.scalar<float>()() = min_filter_val;
-        max_filter_tensor.scalar<float>()() = max_filter_val;
-
-        auto input_op = tensorflow::ops::Const(root, input_tensor);
-        auto filter_op = tensorflow::ops::Const(root, filter_tensor);
-        auto min_input_op = tensorflow::ops::Const(root, min_input_tensor);
-        auto max_input_op = tensorflow::ops::Const(root, max_input_tensor);
-        auto min_filter_op = tensorflow::ops::Const(root, min_filter_tensor);
-        auto max_filter_op = tensorflow::ops::Const(root, max_filter_tensor);
+        tf_fuzzer_utils::QuantizedTensor input = tf_fuzzer_utils::makeQuantizedTensor(
+            input_dtype, input_tensor_shape, -1, data, offset, size);
+        tf_fuzzer_utils::QuantizedTensor filter = tf_fuzzer_utils::makeQuantizedTensor(
+            filter_dtype, filter_tensor_shape, -1, data, offset, size);
 
         std::vector<int> strides = {1, 1, 1, 1};
         if (offset + 4 * sizeof(int) <= size) {
@@ -226,24 +97,15 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
 
         std::vector<int> dilations = {1, 1, 1, 1};
 
-        auto quantized_conv2d = tensorflow::ops::QuantizedConv2D(
-            root,
-            input_op,
-            filter_op,
-            min_input_op,
-            max_input_op,
-            min_filter_op,
-            max_filter_op,
-            strides,
-            padding,
-            tensorflow::ops::QuantizedConv2D::Attrs()
-                .OutType(out_dtype)
-                .Dilations(dilations)
-        );
-
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({quantized_conv2d.output, quantized_conv2d.min_output, quantized_conv2d.max_output}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("QuantizedConv2D")
+                .attr("strides", strides)
+                .attr("padding", padding)
+                .attr("out_type", out_dtype)
+                .attr("dilations", dilations),
+            {input.value, filter.value, input.min_range, input.max_range, filter.min_range,
+             filter.max_range}, &outputs);
         
         if (!status.ok()) {
             return -1;
@@ -1,12 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/array_ops.h"
-#include "tensorflow/cc/ops/nn_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -17,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-    void logError(const std::string& message, const uint8_t* data, size_t size) {
-        std::cerr << "Error: " << message << std::endl;
-    }
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 5) {
@@ -46,90 +37,20 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
-}
-
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
-
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_QINT8:
-            fillTensorWithData<tensorflow::qint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT8:
-            fillTensorWithData<tensorflow::quint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT32:
-            fillTensorWithData<tensorflow::qint32>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT16:
-            fillTensorWithData<tensorflow::qint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT16:
-            fillTensorWithData<tensorflow::quint16>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 50) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         tensorflow::DataType x_dtype = parseDataType(data[offset++]);
         uint8_t x_rank = parseRank(data[offset++]);
@@ -141,30 +62,8 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             x_tensor_shape.AddDim(dim);
         }
         
-        tensorflow::Tensor x_tensor(x_dtype, x_tensor_shape);
-        fillTensorWithDataByType(x_tensor, x_dtype, data, offset, size);
-        
-        float x_min_val = 0.0f;
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&x_min_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        
-        float x_max_val = 1.0f;
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&x_max_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        
-        if (x_min_val >= x_max_val) {
-            x_max_val = x_min_val + 1.0f;
-        }
-        
-        tensorflow::Tensor x_min_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        x_min_tensor.scalar<float>()() = x_min_val;
-        
-        tensorflow::Tensor x_max_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        x_max_tensor.scalar<float>()() = x_max_val;
+        tf_fuzzer_utils::QuantizedTensor x = tf_fuzzer_utils::makeQuantizedTensor(
+            x_dtype, x_tensor_shape, -1, data, offset, size);
         
         bool output_range_given = false;
         if (offset < size) {
@@ -201,23 +100,16 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             }
         }
         
-        auto x_input = tensorflow::ops::Const(root, x_tensor);
-        auto x_min_input = tensorflow::ops::Const(root, x_min_tensor);
-        auto x_max_input = tensorflow::ops::Const(root, x_max_tensor);
-        
-        auto quantized_instance_norm = tensorflow::ops::QuantizedInstanceNorm(
-            root, x_input, x_min_input, x_max_input,
-            tensorflow::ops::QuantizedInstanceNorm::OutputRangeGiven(output_range_given)
-                .GivenYMin(given_y_min)
-                .GivenYMax(given_y_max)
-                .VarianceEpsilon(variance_epsilon)
-                .MinSeparation(min_separation)
-        );
-        
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
         
-        tensorflow::Status status = session.Run({quantized_instance_norm.y, quantized_instance_norm.y_min, quantized_instance_norm.y_max}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("QuantizedInstanceNorm")
+                .attr("output_range_given", output_range_given)
+                .attr("given_y_min", given_y_min)
+                .attr("given_y_max", given_y_max)
+                .attr("variance_epsilon", variance_epsilon)
+                .attr("min_separation", min_separation),
+            {x.value, x.min_range, x.max_range}, &outputs);
         if (!status.ok()) {
             return -1;
         }
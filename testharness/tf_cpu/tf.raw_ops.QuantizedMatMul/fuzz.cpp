@@ -1,12 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/array_ops.h"
-#include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -17,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseQuantizedDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 5) {
@@ -46,93 +37,20 @@ tensorflow::DataType parseQuantizedDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
-}
-
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
-
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_FLOAT:
-            fillTensorWithData<float>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT8:
-            fillTensorWithData<tensorflow::qint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT8:
-            fillTensorWithData<tensorflow::quint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT32:
-            fillTensorWithData<tensorflow::qint32>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT16:
-            fillTensorWithData<tensorflow::qint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT16:
-            fillTensorWithData<tensorflow::quint16>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         tensorflow::DataType dtype_a = parseQuantizedDataType(data[offset++]);
         tensorflow::DataType dtype_b = parseQuantizedDataType(data[offset++]);
@@ -171,71 +89,20 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
 
         tensorflow::TensorShape tensor_shape_a(shape_a);
         tensorflow::TensorShape tensor_shape_b(shape_b);
-        tensorflow::TensorShape scalar_shape({});
-
-        tensorflow::Tensor tensor_a(dtype_a, tensor_shape_a);
-        tensorflow::Tensor tensor_b(dtype_b, tensor_shape_b);
-        tensorflow::Tensor min_a_tensor(tensorflow::DT_FLOAT, scalar_shape);
-        tensorflow::Tensor max_a_tensor(tensorflow::DT_FLOAT, scalar_shape);
-        tensorflow::Tensor min_b_tensor(tensorflow::DT_FLOAT, scalar_shape);
-        tensorflow::Tensor max_b_tensor(tensorflow::DT_FLOAT, scalar_shape);
-
-        fillTensorWithDataByType(tensor_a, dtype_a, data, offset, size);
-        fillTensorWithDataByType(tensor_b, dtype_b, data, offset, size);
-        
-        float min_a_val = -1.0f;
-        float max_a_val = 1.0f;
-        float min_b_val = -1.0f;
-        float max_b_val = 1.0f;
-        
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&min_a_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&max_a_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&min_b_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&max_b_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        
-        min_a_tensor.scalar<float>()() = min_a_val;
-        max_a_tensor.scalar<float>()() = max_a_val;
-        min_b_tensor.scalar<float>()() = min_b_val;
-        max_b_tensor.scalar<float>()() = max_b_val;
-
-        auto a_input = tensorflow::ops::Const(root, tensor_a);
-        auto b_input = tensorflow::ops::Const(root, tensor_b);
-        auto min_a_input = tensorflow::ops::Const(root, min_a_tensor);
-        auto max_a_input = tensorflow::ops::Const(root, max_a_tensor);
-        auto min_b_input = tensorflow::ops::Const(root, min_b_tensor);
-        auto max_b_input = tensorflow::ops::Const(root, max_b_tensor);
-
-        auto quantized_matmul = tensorflow::ops::QuantizedMatMul(
-            root,
-            a_input,
-            b_input,
-            min_a_input,
-            max_a_input,
-            min_b_input,
-            max_b_input,
-            tensorflow::ops::QuantizedMatMul::Attrs()
-                .Toutput(toutput)
-                .TransposeA(transpose_a)
-                .TransposeB(transpose_b)
-                .Tactivation(tactivation)
-        );
+        tf_fuzzer_utils::QuantizedTensor a = tf_fuzzer_utils::makeQuantizedTensor(
+            dtype_a, tensor_shape_a, -1, data, offset, size);
+        tf_fuzzer_utils::QuantizedTensor b = tf_fuzzer_utils::makeQuantizedTensor(
+            dtype_b, tensor_shape_b, -1, data, offset, size);
 
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
         
-        tensorflow::Status status = session.Run({quantized_matmul.out, quantized_matmul.min_out, quantized_matmul.max_out}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("QuantizedMatMul")
+                .attr("Toutput", toutput)
+                .attr("transpose_a", transpose_a)
+                .attr("transpose_b", transpose_b)
+                .attr("Tactivation", tactivation),
+            {a.value, b.value, a.min_range, a.max_range, b.min_range, b.max_range}, &outputs);
         if (!status.ok()) {
             return -1;
         }
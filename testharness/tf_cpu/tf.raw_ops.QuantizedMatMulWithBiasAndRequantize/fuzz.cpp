@@ -1,12 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/array_ops.h"
-#include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -17,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseQuantizedDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 5) {
@@ -81,93 +72,24 @@ tensorflow::DataType parseOutputDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_FLOAT:
-            fillTensorWithData<float>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT8:
-            fillTensorWithData<tensorflow::qint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT8:
-            fillTensorWithData<tensorflow::quint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT32:
-            fillTensorWithData<tensorflow::qint32>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT16:
-            fillTensorWithData<tensorflow::qint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT16:
-            fillTensorWithData<tensorflow::quint16>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
-}
+using tf_fuzzer_utils::fillTensorWithDataByType;
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         tensorflow::DataType dtype_a = parseQuantizedDataType(data[offset++]);
         tensorflow::DataType dtype_b = parseQuantizedDataType(data[offset++]);
@@ -216,33 +138,19 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         fillTensorWithData<float>(min_freezed_output_tensor, data, offset, size);
         fillTensorWithData<float>(max_freezed_output_tensor, data, offset, size);
         
-        auto a_input = tensorflow::ops::Const(root, tensor_a);
-        auto b_input = tensorflow::ops::Const(root, tensor_b);
-        auto bias_input = tensorflow::ops::Const(root, tensor_bias);
-        auto min_a_input = tensorflow::ops::Const(root, min_a_tensor);
-        auto max_a_input = tensorflow::ops::Const(root, max_a_tensor);
-        auto min_b_input = tensorflow::ops::Const(root, min_b_tensor);
-        auto max_b_input = tensorflow::ops::Const(root, max_b_tensor);
-        auto min_freezed_output_input = tensorflow::ops::Const(root, min_freezed_output_tensor);
-        auto max_freezed_output_input = tensorflow::ops::Const(root, max_freezed_output_tensor);
-        
         bool transpose_a = (offset < size) ? (data[offset++] % 2 == 1) : false;
         bool transpose_b = (offset < size) ? (data[offset++] % 2 == 1) : false;
         std::string input_quant_mode = (offset < size && data[offset++] % 2 == 1) ? "SCALED" : "MIN_FIRST";
         
-        // Use raw_ops namespace for QuantizedMatMulWithBiasAndRequantize
-        auto result = tensorflow::ops::RawOps::QuantizedMatMulWithBiasAndRequantize(
-            root, a_input, b_input, bias_input, min_a_input, max_a_input,
-            min_b_input, max_b_input, min_freezed_output_input, max_freezed_output_input,
-            tensorflow::ops::RawOps::QuantizedMatMulWithBiasAndRequantize::Attrs()
-                .Toutput(dtype_output)
-                .TransposeA(transpose_a)
-                .TransposeB(transpose_b)
-                .InputQuantMode(input_quant_mode));
-        
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({result.output, result.min_output, result.max_output}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("QuantizedMatMulWithBiasAndRequantize")
+                .attr("Toutput", dtype_output)
+                .attr("transpose_a", transpose_a)
+                .attr("transpose_b", transpose_b)
+                .attr("input_quant_mode", input_quant_mode),
+            {tensor_a, tensor_b, tensor_bias, min_a_tensor, max_a_tensor, min_b_tensor, max_b_tensor,
+             min_freezed_output_tensor, max_freezed_output_tensor}, &outputs);
         
         if (!status.ok()) {
             return -1;
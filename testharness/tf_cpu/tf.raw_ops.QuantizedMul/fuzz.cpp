@@ -1,12 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/array_ops.h"
-#include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -17,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-    void logError(const std::string& message, const uint8_t* data, size_t size) {
-        std::cerr << message << std::endl;
-    }
-}
-
 tensorflow::DataType parseQuantizedDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 5) {
@@ -68,93 +59,20 @@ tensorflow::DataType parseOutputDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
-}
-
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
-
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_FLOAT:
-            fillTensorWithData<float>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT8:
-            fillTensorWithData<tensorflow::qint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT8:
-            fillTensorWithData<tensorflow::quint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT32:
-            fillTensorWithData<tensorflow::qint32>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT16:
-            fillTensorWithData<tensorflow::qint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT16:
-            fillTensorWithData<tensorflow::quint16>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         tensorflow::DataType x_dtype = parseQuantizedDataType(data[offset++]);
         tensorflow::DataType y_dtype = parseQuantizedDataType(data[offset++]);
@@ -169,69 +87,16 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         tensorflow::TensorShape x_tensor_shape(x_shape);
         tensorflow::TensorShape y_tensor_shape(y_shape);
         
-        tensorflow::Tensor x_tensor(x_dtype, x_tensor_shape);
-        tensorflow::Tensor y_tensor(y_dtype, y_tensor_shape);
-        
-        fillTensorWithDataByType(x_tensor, x_dtype, data, offset, size);
-        fillTensorWithDataByType(y_tensor, y_dtype, data, offset, size);
-        
-        float min_x_val = 0.0f;
-        float max_x_val = 1.0f;
-        float min_y_val = 0.0f;
-        float max_y_val = 1.0f;
-        
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&min_x_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&max_x_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&min_y_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&max_y_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        
-        if (min_x_val > max_x_val) std::swap(min_x_val, max_x_val);
-        if (min_y_val > max_y_val) std::swap(min_y_val, max_y_val);
-        
-        tensorflow::Tensor min_x_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        tensorflow::Tensor max_x_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        tensorflow::Tensor min_y_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        tensorflow::Tensor max_y_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        
-        min_x_tensor.scalar<float>()() = min_x_val;
-        max_x_tensor.scalar<float>()() = max_x_val;
-        min_y_tensor.scalar<float>()() = min_y_val;
-        max_y_tensor.scalar<float>()() = max_y_val;
-        
-        auto x_input = tensorflow::ops::Const(root, x_tensor);
-        auto y_input = tensorflow::ops::Const(root, y_tensor);
-        auto min_x_input = tensorflow::ops::Const(root, min_x_tensor);
-        auto max_x_input = tensorflow::ops::Const(root, max_x_tensor);
-        auto min_y_input = tensorflow::ops::Const(root, min_y_tensor);
-        auto max_y_input = tensorflow::ops::Const(root, max_y_tensor);
-        
-        auto quantized_mul = tensorflow::ops::QuantizedMul(
-            root,
-            x_input,
-            y_input,
-            min_x_input,
-            max_x_input,
-            min_y_input,
-            max_y_input,
-            tensorflow::ops::QuantizedMul::Toutput(output_dtype)
-        );
+        tf_fuzzer_utils::QuantizedTensor x = tf_fuzzer_utils::makeQuantizedTensor(
+            x_dtype, x_tensor_shape, -1, data, offset, size);
+        tf_fuzzer_utils::QuantizedTensor y = tf_fuzzer_utils::makeQuantizedTensor(
+            y_dtype, y_tensor_shape, -1, data, offset, size);
         
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
         
-        tensorflow::Status status = session.Run({quantized_mul.z, quantized_mul.min_z, quantized_mul.max_z}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("QuantizedMul").attr("Toutput", output_dtype),
+            {x.value, y.value, x.min_range, x.max_range, y.min_range, y.max_range}, &outputs);
         if (!status.ok()) {
             return -1;
         }
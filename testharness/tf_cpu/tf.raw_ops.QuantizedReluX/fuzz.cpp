@@ -1,12 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/array_ops.h"
-#include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -17,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseQuantizedDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 5) {
@@ -68,89 +59,20 @@ tensorflow::DataType parseOutputDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
-}
-
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
-
-void fillQuantizedTensorWithData(tensorflow::Tensor& tensor, tensorflow::DataType dtype, 
-                                const uint8_t* data, size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_QINT8:
-            fillTensorWithData<tensorflow::qint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT8:
-            fillTensorWithData<tensorflow::quint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT32:
-            fillTensorWithData<tensorflow::qint32>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT16:
-            fillTensorWithData<tensorflow::qint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT16:
-            fillTensorWithData<tensorflow::quint16>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         tensorflow::DataType features_dtype = parseQuantizedDataType(data[offset++]);
         uint8_t features_rank = parseRank(data[offset++]);
@@ -161,8 +83,8 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             features_tensor_shape.AddDim(dim);
         }
         
-        tensorflow::Tensor features_tensor(features_dtype, features_tensor_shape);
-        fillQuantizedTensorWithData(features_tensor, features_dtype, data, offset, size);
+        tf_fuzzer_utils::QuantizedTensor features = tf_fuzzer_utils::makeQuantizedTensor(
+            features_dtype, features_tensor_shape, -1, data, offset, size);
         
         float max_value_val = 6.0f;
         if (offset + sizeof(float) <= size) {
@@ -172,23 +94,6 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             if (max_value_val > 100.0f) max_value_val = 6.0f;
         }
         
-        float min_features_val = -1.0f;
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&min_features_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-            if (min_features_val > 0.0f) min_features_val = -std::abs(min_features_val);
-            if (min_features_val < -100.0f) min_features_val = -1.0f;
-        }
-        
-        float max_features_val = 1.0f;
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&max_features_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-            max_features_val = std::abs(max_features_val);
-            if (max_features_val > 100.0f) max_features_val = 1.0f;
-            if (max_features_val <= min_features_val) max_features_val = min_features_val + 1.0f;
-        }
-        
         tensorflow::DataType out_type = tensorflow::DT_QUINT8;
         if (offset < size) {
             out_type = parseOutputDataType(data[offset++]);
@@ -198,32 +103,11 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         tensorflow::Tensor max_value_tensor(tensorflow::DT_FLOAT, scalar_shape);
         max_value_tensor.scalar<float>()() = max_value_val;
         
-        tensorflow::Tensor min_features_tensor(tensorflow::DT_FLOAT, scalar_shape);
-        min_features_tensor.scalar<float>()() = min_features_val;
-        
-        tensorflow::Tensor max_features_tensor(tensorflow::DT_FLOAT, scalar_shape);
-        max_features_tensor.scalar<float>()() = max_features_val;
-        
-        auto features_input = tensorflow::ops::Const(root, features_tensor);
-        auto max_value_input = tensorflow::ops::Const(root, max_value_tensor);
-        auto min_features_input = tensorflow::ops::Const(root, min_features_tensor);
-        auto max_features_input = tensorflow::ops::Const(root, max_features_tensor);
-        
-        auto quantized_relu_x = tensorflow::ops::QuantizedReluX(
-            root, 
-            features_input, 
-            max_value_input, 
-            min_features_input, 
-            max_features_input,
-            tensorflow::ops::QuantizedReluX::OutType(out_type)
-        );
-        
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
         
-        tensorflow::Status status = session.Run({quantized_relu_x.activations, 
-                                                quantized_relu_x.min_activations, 
-                                                quantized_relu_x.max_activations}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("QuantizedReluX").attr("out_type", out_type),
+            {features.value, max_value_tensor, features.min_range, features.max_range}, &outputs);
         if (!status.ok()) {
             return -1;
         }
@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/data_flow_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 21) {
@@ -93,57 +85,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -218,78 +168,78 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
-    
+
     size_t offset = 0;
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
 
     try {
-        uint8_t num_component_types = (data[offset] % 3) + 1;
-        offset++;
-        
+        uint8_t num_components = (data[offset++] % 3) + 1;
         std::vector<tensorflow::DataType> component_types;
-        for (uint8_t i = 0; i < num_component_types; ++i) {
-            if (offset >= size) break;
-            tensorflow::DataType dtype = parseDataType(data[offset]);
-            component_types.push_back(dtype);
-            offset++;
-        }
-        
-        if (component_types.empty()) {
-            component_types.push_back(tensorflow::DT_FLOAT);
-        }
-
-        auto queue = tensorflow::ops::FIFOQueue(root, tensorflow::DataTypeSlice(component_types));
-        
-        std::vector<tensorflow::Output> enqueue_tensors;
-        for (size_t i = 0; i < component_types.size(); ++i) {
-            if (offset >= size) break;
-            
-            uint8_t rank = parseRank(data[offset]);
-            offset++;
-            
+        std::vector<std::vector<int64_t>> shapes;
+        for (uint8_t i = 0; i < num_components; ++i) {
+            if (offset >= size) return 0;
+            component_types.push_back(parseDataType(data[offset++]));
+            if (offset >= size) return 0;
+            uint8_t rank = parseRank(data[offset++]);
             std::vector<int64_t> shape = parseShape(data, offset, size, rank);
-            
-            tensorflow::TensorShape tensor_shape;
-            for (int64_t dim : shape) {
-                tensor_shape.AddDim(dim);
-            }
-            
-            tensorflow::Tensor tensor(component_types[i], tensor_shape);
-            fillTensorWithDataByType(tensor, component_types[i], data, offset, size);
-            
-            auto const_tensor = tensorflow::ops::Const(root, tensor);
-            enqueue_tensors.push_back(const_tensor);
+            shapes.push_back(shape);
         }
-        
-        if (!enqueue_tensors.empty()) {
-            auto enqueue_op = tensorflow::ops::QueueEnqueue(root, queue, enqueue_tensors);
+        // Dequeue many needs the shapes declared; leaving them out is an error path.
+        bool declare_shapes = (offset < size) ? (data[offset++] % 2 == 1) : true;
+        std::vector<tensorflow::PartialTensorShape> queue_shapes;
+        for (size_t i = 0; declare_shapes && i < shapes.size(); ++i) {
+            queue_shapes.emplace_back(shapes[i]);
         }
-        
-        if (offset >= size) offset = size - 1;
-        int32_t n_value = (data[offset] % 5) + 1;
-        auto n_tensor = tensorflow::ops::Const(root, n_value);
-        
-        int timeout_ms = -1;
-        if (offset + 1 < size) {
-            timeout_ms = static_cast<int>(data[offset + 1] % 100);
+        int64_t batch = (offset < size) ? data[offset++] % 4 : 0;
+        int32_t n = (offset < size) ? data[offset++] % 5 : 1;
+
+        // The queue lives in the runtime's per-input container.
+        std::vector<tensorflow::Tensor> queue;
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("FIFOQueue")
+                .attr("component_types", component_types)
+                .attr("shapes", queue_shapes),
+            {}, &queue);
+        if (!status.ok()) {
+            return -1;
         }
-        
-        auto dequeue_many_op = tensorflow::ops::QueueDequeueMany(
-            root, queue, n_tensor, component_types,
-            tensorflow::ops::QueueDequeueMany::Attrs().TimeoutMs(timeout_ms)
-        );
-
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({dequeue_many_op}, &outputs);
-        
+
+        std::vector<tensorflow::Tensor> enqueue_inputs = {queue[0]};
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            std::vector<int64_t> batch_shape = {batch};
+            batch_shape.insert(batch_shape.end(), shapes[i].begin(), shapes[i].end());
+            enqueue_inputs.push_back(makeTensor(component_types[i], batch_shape, data, offset, size));
+        }
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("QueueEnqueueMany"), enqueue_inputs, &outputs);
         if (!status.ok()) {
             return -1;
         }
 
+        // Closed first, so asking for more than was enqueued fails or returns
+        // early instead of waiting.
+        status = tf_fuzzer_utils::runOp(tf_fuzzer_utils::OpSpec("QueueClose"), {queue[0]}, &outputs);
+        if (!status.ok()) {
+            return -1;
+        }
+        tensorflow::Tensor n_tensor(n);
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("QueueDequeueMany").attr("component_types", component_types),
+            {queue[0], n_tensor}, &outputs);
+        if (!status.ok()) {
+            return -1;
+        }
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
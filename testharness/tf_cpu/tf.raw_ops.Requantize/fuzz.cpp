@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseInputDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 5) {
@@ -67,93 +59,20 @@ tensorflow::DataType parseOutputDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
-}
-
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
-
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_FLOAT:
-            fillTensorWithData<float>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT8:
-            fillTensorWithData<tensorflow::qint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT8:
-            fillTensorWithData<tensorflow::quint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT32:
-            fillTensorWithData<tensorflow::qint32>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT16:
-            fillTensorWithData<tensorflow::qint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT16:
-            fillTensorWithData<tensorflow::quint16>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         tensorflow::DataType input_dtype = parseInputDataType(data[offset++]);
         uint8_t input_rank = parseRank(data[offset++]);
@@ -164,48 +83,16 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             input_tensor_shape.AddDim(dim);
         }
         
-        tensorflow::Tensor input_tensor(input_dtype, input_tensor_shape);
-        fillTensorWithDataByType(input_tensor, input_dtype, data, offset, size);
-        
-        float input_min_val = 0.0f;
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&input_min_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
+        tf_fuzzer_utils::QuantizedTensor input = tf_fuzzer_utils::makeQuantizedTensor(
+            input_dtype, input_tensor_shape, -1, data, offset, size);
         
-        float input_max_val = 1.0f;
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&input_max_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
+        tensorflow::DataType output_dtype = parseOutputDataType(data[offset % size]);
         
+        // The requested range is one the output type can represent
         float requested_output_min_val = 0.0f;
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&requested_output_min_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        
         float requested_output_max_val = 1.0f;
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&requested_output_max_val, data + offset, sizeof(float));
-            offset += sizeof(float);
-        }
-        
-        if (input_min_val >= input_max_val) {
-            input_max_val = input_min_val + 1.0f;
-        }
-        
-        if (requested_output_min_val >= requested_output_max_val) {
-            requested_output_max_val = requested_output_min_val + 1.0f;
-        }
-        
-        tensorflow::DataType output_dtype = parseOutputDataType(data[offset % size]);
-        
-        tensorflow::Tensor input_min_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        input_min_tensor.scalar<float>()() = input_min_val;
-        
-        tensorflow::Tensor input_max_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        input_max_tensor.scalar<float>()() = input_max_val;
+        tf_fuzzer_utils::parseQuantizedRange(output_dtype, data, offset, size, &requested_output_min_val,
+                                             &requested_output_max_val);
         
         tensorflow::Tensor requested_output_min_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
         requested_output_min_tensor.scalar<float>()() = requested_output_min_val;
@@ -213,27 +100,12 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         tensorflow::Tensor requested_output_max_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
         requested_output_max_tensor.scalar<float>()() = requested_output_max_val;
         
-        auto input_op = tensorflow::ops::Const(root, input_tensor);
-        auto input_min_op = tensorflow::ops::Const(root, input_min_tensor);
-        auto input_max_op = tensorflow::ops::Const(root, input_max_tensor);
-        auto requested_output_min_op = tensorflow::ops::Const(root, requested_output_min_tensor);
-        auto requested_output_max_op = tensorflow::ops::Const(root, requested_output_max_tensor);
-        
-        // Use raw_ops namespace for Requantize
-        auto requantize_op = tensorflow::ops::internal::Requantize(
-            root, 
-            input_op, 
-            input_min_op, 
-            input_max_op, 
-            requested_output_min_op, 
-            requested_output_max_op, 
-            tensorflow::ops::internal::Requantize::Attrs().OutType(output_dtype)
-        );
-        
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
         
-        tensorflow::Status status = session.Run({requantize_op.output, requantize_op.output_min, requantize_op.output_max}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("Requantize").attr("out_type", output_dtype),
+            {input.value, input.min_range, input.max_range, requested_output_min_tensor,
+             requested_output_max_tensor}, &outputs);
         if (!status.ok()) {
             return -1;
         }
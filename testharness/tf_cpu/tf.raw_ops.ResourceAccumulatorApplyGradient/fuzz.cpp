@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -15,12 +13,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 20) {
@@ -89,57 +81,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -195,80 +145,62 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
-        tensorflow::DataType gradient_dtype = parseDataType(data[offset++]);
-        
-        uint8_t gradient_rank = parseRank(data[offset++]);
-        std::vector<int64_t> gradient_shape = parseShape(data, offset, size, gradient_rank);
-        
-        tensorflow::TensorShape gradient_tensor_shape;
-        for (int64_t dim : gradient_shape) {
-            gradient_tensor_shape.AddDim(dim);
-        }
-        
-        tensorflow::Tensor gradient_tensor(gradient_dtype, gradient_tensor_shape);
-        fillTensorWithDataByType(gradient_tensor, gradient_dtype, data, offset, size);
-        
-        int64_t local_step_value = 1;
-        if (offset + sizeof(int64_t) <= size) {
-            std::memcpy(&local_step_value, data + offset, sizeof(int64_t));
-            offset += sizeof(int64_t);
-            local_step_value = std::abs(local_step_value) % 1000 + 1;
-        }
-        
-        tensorflow::Tensor local_step_tensor(tensorflow::DT_INT64, tensorflow::TensorShape({}));
-        local_step_tensor.scalar<int64_t>()() = local_step_value;
-        
-        auto accumulator_handle = tensorflow::ops::VarHandleOp(
-            root.WithOpName("accumulator_handle"),
-            gradient_dtype,
-            gradient_tensor_shape
-        );
-        
-        auto init_accumulator = tensorflow::ops::VarIsInitializedOp(
-            root.WithOpName("check_init"),
-            accumulator_handle
-        );
-        
-        auto assign_accumulator = tensorflow::ops::AssignVariableOp(
-            root.WithOpName("init_accumulator"),
-            accumulator_handle,
-            tensorflow::ops::Const(root, gradient_tensor)
-        );
-        
-        auto gradient_input = tensorflow::ops::Const(root.WithOpName("gradient"), gradient_tensor);
-        auto local_step_input = tensorflow::ops::Const(root.WithOpName("local_step"), local_step_tensor);
-        
-        // Use raw_ops namespace for ResourceAccumulatorApplyGradient
-        auto apply_gradient = tensorflow::ops::Operation(
-            root.WithOpName("apply_gradient"),
-            "ResourceAccumulatorApplyGradient",
-            {accumulator_handle.output, local_step_input.output, gradient_input.output},
-            {}
-        );
-        
-        tensorflow::ClientSession session(root);
-        
-        std::vector<tensorflow::Tensor> init_outputs;
-        tensorflow::Status init_status = session.Run({assign_accumulator.operation}, &init_outputs);
-        if (!init_status.ok()) {
+        tensorflow::DataType dtype = parseDataType(data[offset++]);
+        if (offset >= size) return 0;
+        uint8_t rank = parseRank(data[offset++]);
+        std::vector<int64_t> shape = parseShape(data, offset, size, rank);
+        bool known_shape = (offset < size) ? (data[offset++] % 2 == 1) : true;
+        bool mean = (offset < size) ? (data[offset++] % 2 == 1) : true;
+        std::string reduction_type = mean ? "MEAN" : "SUM";
+        uint8_t num_gradients = (offset < size) ? data[offset++] % 3 : 0;
+
+        tensorflow::PartialTensorShape accumulator_shape =
+            known_shape ? tensorflow::PartialTensorShape(shape) : tensorflow::PartialTensorShape();
+
+        // The accumulator lives in the runtime's per-input container.
+        std::vector<tensorflow::Tensor> accumulator;
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ResourceConditionalAccumulator")
+                .attr("dtype", dtype)
+                .attr("shape", accumulator_shape)
+                .attr("reduction_type", reduction_type),
+            {}, &accumulator);
+        if (!status.ok()) {
             return -1;
         }
-        
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({apply_gradient}, &outputs);
+
+        for (uint8_t i = 0; i < num_gradients; ++i) {
+            tensorflow::Tensor local_step(static_cast<int64_t>((offset < size) ? data[offset++] % 3 : 0));
+            tensorflow::Tensor gradient = makeTensor(dtype, shape, data, offset, size);
+            status = tf_fuzzer_utils::runOp(
+                tf_fuzzer_utils::OpSpec("ResourceAccumulatorApplyGradient"),
+                {accumulator[0], local_step, gradient}, &outputs);
+            if (!status.ok()) {
+                return -1;
+            }
+        }
+
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ResourceAccumulatorNumAccumulated"), {accumulator[0]}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
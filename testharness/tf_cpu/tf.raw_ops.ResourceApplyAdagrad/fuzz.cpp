@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -15,12 +13,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 20) {
@@ -89,57 +81,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -192,67 +142,79 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
+// Creates a resource variable holding each value, named var_0, var_1, ...
+// in the runtime's per-input container, and returns their handles.
+tensorflow::Status makeVariables(const std::vector<tensorflow::Tensor>& values,
+                                 std::vector<tensorflow::Tensor>* handles) {
+    std::vector<tensorflow::Tensor> outputs;
+    for (size_t i = 0; i < values.size(); ++i) {
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("VarHandleOp")
+                .attr("dtype", values[i].dtype())
+                .attr("shape", tensorflow::PartialTensorShape())
+                .attr("shared_name", "var_" + std::to_string(i)),
+            {}, &outputs);
+        if (!status.ok()) {
+            return status;
+        }
+        handles->push_back(outputs[0]);
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("AssignVariableOp"), {handles->back(), values[i]}, &outputs);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    return absl::OkStatus();
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
-        tensorflow::DataType lr_grad_dtype = parseDataType(data[offset++]);
-        
+        tensorflow::DataType dtype = parseDataType(data[offset++]);
+        if (offset >= size) return 0;
         uint8_t var_rank = parseRank(data[offset++]);
         std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
-        
-        bool use_locking = (data[offset++] % 2) == 1;
-        bool update_slots = (data[offset++] % 2) == 1;
-
-        tensorflow::TensorShape var_tensor_shape;
-        for (int64_t dim : var_shape) {
-            var_tensor_shape.AddDim(dim);
-        }
-
-        auto var_resource = tensorflow::ops::VarHandleOp(root, lr_grad_dtype, var_tensor_shape);
-        auto accum_resource = tensorflow::ops::VarHandleOp(root, lr_grad_dtype, var_tensor_shape);
+        bool use_locking = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool update_slots = (offset < size) ? (data[offset++] % 2 == 1) : false;
 
-        tensorflow::Tensor var_init_tensor(lr_grad_dtype, var_tensor_shape);
-        fillTensorWithDataByType(var_init_tensor, lr_grad_dtype, data, offset, size);
-        
-        tensorflow::Tensor accum_init_tensor(lr_grad_dtype, var_tensor_shape);
-        fillTensorWithDataByType(accum_init_tensor, lr_grad_dtype, data, offset, size);
+        tensorflow::Tensor var = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor accum = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor lr = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor grad = makeTensor(dtype, var_shape, data, offset, size);
 
-        auto var_init_op = tensorflow::ops::AssignVariableOp(root, var_resource, var_init_tensor);
-        auto accum_init_op = tensorflow::ops::AssignVariableOp(root, accum_resource, accum_init_tensor);
-
-        tensorflow::Tensor lr_tensor(lr_grad_dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(lr_tensor, lr_grad_dtype, data, offset, size);
-        auto lr_const = tensorflow::ops::Const(root, lr_tensor);
-
-        tensorflow::Tensor grad_tensor(lr_grad_dtype, var_tensor_shape);
-        fillTensorWithDataByType(grad_tensor, lr_grad_dtype, data, offset, size);
-        auto grad_const = tensorflow::ops::Const(root, grad_tensor);
-
-        auto apply_adagrad = tensorflow::ops::ResourceApplyAdagrad(
-            root, var_resource, accum_resource, lr_const, grad_const,
-            tensorflow::ops::ResourceApplyAdagrad::UseLocking(use_locking).UpdateSlots(update_slots)
-        );
-
-        tensorflow::ClientSession session(root);
-        
-        std::vector<tensorflow::Operation> init_ops = {var_init_op, accum_init_op};
-        tensorflow::Status init_status = session.Run({}, {}, init_ops, nullptr);
-        if (!init_status.ok()) {
+        // var and its slots are resource variables; the updated var is read back.
+        std::vector<tensorflow::Tensor> handles;
+        tensorflow::Status status = makeVariables({var, accum}, &handles);
+        if (!status.ok()) {
             return -1;
         }
 
-        std::vector<tensorflow::Operation> run_ops = {apply_adagrad};
-        tensorflow::Status status = session.Run({}, {}, run_ops, nullptr);
+        std::vector<tensorflow::Tensor> outputs;
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ResourceApplyAdagrad")
+                .attr("use_locking", use_locking)
+                .attr("update_slots", update_slots),
+            {handles[0], handles[1], lr, grad}, &outputs);
+        if (!status.ok()) {
+            return -1;
+        }
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ReadVariableOp").attr("dtype", dtype), {handles[0]}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
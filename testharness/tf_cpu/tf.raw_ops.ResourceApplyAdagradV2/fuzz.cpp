@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -15,12 +13,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 20) {
@@ -89,57 +81,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -192,93 +142,80 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
-extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
-    if (size < 20) return 0;
-    
-    size_t offset = 0;
-
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
 
-    try {
-        tensorflow::DataType lr_dtype = parseDataType(data[offset++]);
-        
-        uint8_t grad_rank = parseRank(data[offset++]);
-        std::vector<int64_t> grad_shape = parseShape(data, offset, size, grad_rank);
-        
-        tensorflow::TensorShape grad_tensor_shape;
-        for (int64_t dim : grad_shape) {
-            grad_tensor_shape.AddDim(dim);
+// Creates a resource variable holding each value, named var_0, var_1, ...
+// in the runtime's per-input container, and returns their handles.
+tensorflow::Status makeVariables(const std::vector<tensorflow::Tensor>& values,
+                                 std::vector<tensorflow::Tensor>* handles) {
+    std::vector<tensorflow::Tensor> outputs;
+    for (size_t i = 0; i < values.size(); ++i) {
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("VarHandleOp")
+                .attr("dtype", values[i].dtype())
+                .attr("shape", tensorflow::PartialTensorShape())
+                .attr("shared_name", "var_" + std::to_string(i)),
+            {}, &outputs);
+        if (!status.ok()) {
+            return status;
         }
+        handles->push_back(outputs[0]);
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("AssignVariableOp"), {handles->back(), values[i]}, &outputs);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    return absl::OkStatus();
+}
 
-        tensorflow::Tensor lr_tensor(lr_dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(lr_tensor, lr_dtype, data, offset, size);
-
-        tensorflow::Tensor epsilon_tensor(lr_dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(epsilon_tensor, lr_dtype, data, offset, size);
-
-        tensorflow::Tensor grad_tensor(lr_dtype, grad_tensor_shape);
-        fillTensorWithDataByType(grad_tensor, lr_dtype, data, offset, size);
-
-        tensorflow::Tensor var_tensor(lr_dtype, grad_tensor_shape);
-        fillTensorWithDataByType(var_tensor, lr_dtype, data, offset, size);
-
-        tensorflow::Tensor accum_tensor(lr_dtype, grad_tensor_shape);
-        fillTensorWithDataByType(accum_tensor, lr_dtype, data, offset, size);
-
-        auto var_resource = tensorflow::ops::VarHandleOp(root, lr_dtype, grad_tensor_shape);
-        auto accum_resource = tensorflow::ops::VarHandleOp(root, lr_dtype, grad_tensor_shape);
-
-        auto assign_var = tensorflow::ops::AssignVariableOp(root, var_resource, var_tensor);
-        auto assign_accum = tensorflow::ops::AssignVariableOp(root, accum_resource, accum_tensor);
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    FUZZ_TRACE_INPUT();
+    if (size < 20) return 0;
 
-        auto lr_const = tensorflow::ops::Const(root, lr_tensor);
-        auto epsilon_const = tensorflow::ops::Const(root, epsilon_tensor);
-        auto grad_const = tensorflow::ops::Const(root, grad_tensor);
+    size_t offset = 0;
 
+    try {
+        tensorflow::DataType dtype = parseDataType(data[offset++]);
         if (offset >= size) return 0;
-        bool use_locking = (data[offset++] % 2) == 1;
-        if (offset >= size) return 0;
-        bool update_slots = (data[offset++] % 2) == 1;
-
-        auto var_node = tensorflow::ops::AsNodeOut(root, var_resource);
-        auto accum_node = tensorflow::ops::AsNodeOut(root, accum_resource);
-        auto lr_node = tensorflow::ops::AsNodeOut(root, lr_const);
-        auto epsilon_node = tensorflow::ops::AsNodeOut(root, epsilon_const);
-        auto grad_node = tensorflow::ops::AsNodeOut(root, grad_const);
-
-        tensorflow::Node* apply_node = nullptr;
-        auto builder = tensorflow::NodeBuilder(
-                           root.GetUniqueNameForOp("ResourceApplyAdagradV2"),
-                           "ResourceApplyAdagradV2")
-                           .Input(var_node)
-                           .Input(accum_node)
-                           .Input(lr_node)
-                           .Input(epsilon_node)
-                           .Input(grad_node)
-                           .Attr("T", lr_dtype)
-                           .Attr("use_locking", use_locking)
-                           .Attr("update_slots", update_slots)
-                           .Device("/cpu:0");
-        root.UpdateStatus(builder.Finalize(root.graph(), &apply_node));
-        if (!root.ok() || apply_node == nullptr) {
+        uint8_t var_rank = parseRank(data[offset++]);
+        std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
+        bool use_locking = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool update_slots = (offset < size) ? (data[offset++] % 2 == 1) : false;
+
+        tensorflow::Tensor var = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor accum = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor lr = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor epsilon = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor grad = makeTensor(dtype, var_shape, data, offset, size);
+
+        // var and its slots are resource variables; the updated var is read back.
+        std::vector<tensorflow::Tensor> handles;
+        tensorflow::Status status = makeVariables({var, accum}, &handles);
+        if (!status.ok()) {
             return -1;
         }
 
-        tensorflow::ClientSession session(root);
-
-        std::vector<tensorflow::Operation> init_ops = {
-            assign_var.operation, assign_accum.operation};
-        if (!session.Run({}, {}, init_ops, nullptr).ok()) {
+        std::vector<tensorflow::Tensor> outputs;
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ResourceApplyAdagradV2")
+                .attr("use_locking", use_locking)
+                .attr("update_slots", update_slots),
+            {handles[0], handles[1], lr, epsilon, grad}, &outputs);
+        if (!status.ok()) {
             return -1;
         }
-
-        tensorflow::Operation apply_op(apply_node);
-        std::vector<tensorflow::Operation> run_ops = {apply_op};
-        if (!session.Run({}, {}, run_ops, nullptr).ok()) {
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ReadVariableOp").attr("dtype", dtype), {handles[0]}, &outputs);
+        if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -15,12 +13,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 17) {
@@ -83,57 +75,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -189,88 +139,86 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
+// Creates a resource variable holding each value, named var_0, var_1, ...
+// in the runtime's per-input container, and returns their handles.
+tensorflow::Status makeVariables(const std::vector<tensorflow::Tensor>& values,
+                                 std::vector<tensorflow::Tensor>* handles) {
+    std::vector<tensorflow::Tensor> outputs;
+    for (size_t i = 0; i < values.size(); ++i) {
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("VarHandleOp")
+                .attr("dtype", values[i].dtype())
+                .attr("shape", tensorflow::PartialTensorShape())
+                .attr("shared_name", "var_" + std::to_string(i)),
+            {}, &outputs);
+        if (!status.ok()) {
+            return status;
+        }
+        handles->push_back(outputs[0]);
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("AssignVariableOp"), {handles->back(), values[i]}, &outputs);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    return absl::OkStatus();
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
-        
+        if (offset >= size) return 0;
         uint8_t var_rank = parseRank(data[offset++]);
         std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
-        
-        tensorflow::TensorShape var_tensor_shape(var_shape);
-        
-        auto var = tensorflow::ops::VarHandleOp(root, dtype, var_tensor_shape);
-        auto m = tensorflow::ops::VarHandleOp(root, dtype, var_tensor_shape);
-        auto v = tensorflow::ops::VarHandleOp(root, dtype, var_tensor_shape);
-        
-        tensorflow::Tensor var_init_tensor(dtype, var_tensor_shape);
-        fillTensorWithDataByType(var_init_tensor, dtype, data, offset, size);
-        auto var_init = tensorflow::ops::AssignVariableOp(root, var, var_init_tensor);
-        
-        tensorflow::Tensor m_init_tensor(dtype, var_tensor_shape);
-        fillTensorWithDataByType(m_init_tensor, dtype, data, offset, size);
-        auto m_init = tensorflow::ops::AssignVariableOp(root, m, m_init_tensor);
-        
-        tensorflow::Tensor v_init_tensor(dtype, var_tensor_shape);
-        fillTensorWithDataByType(v_init_tensor, dtype, data, offset, size);
-        auto v_init = tensorflow::ops::AssignVariableOp(root, v, v_init_tensor);
-        
-        tensorflow::Tensor beta1_power_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(beta1_power_tensor, dtype, data, offset, size);
-        auto beta1_power = tensorflow::ops::Const(root, beta1_power_tensor);
-        
-        tensorflow::Tensor beta2_power_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(beta2_power_tensor, dtype, data, offset, size);
-        auto beta2_power = tensorflow::ops::Const(root, beta2_power_tensor);
-        
-        tensorflow::Tensor lr_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(lr_tensor, dtype, data, offset, size);
-        auto lr = tensorflow::ops::Const(root, lr_tensor);
-        
-        tensorflow::Tensor beta1_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(beta1_tensor, dtype, data, offset, size);
-        auto beta1 = tensorflow::ops::Const(root, beta1_tensor);
-        
-        tensorflow::Tensor beta2_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(beta2_tensor, dtype, data, offset, size);
-        auto beta2 = tensorflow::ops::Const(root, beta2_tensor);
-        
-        tensorflow::Tensor epsilon_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(epsilon_tensor, dtype, data, offset, size);
-        auto epsilon = tensorflow::ops::Const(root, epsilon_tensor);
-        
-        tensorflow::Tensor grad_tensor(dtype, var_tensor_shape);
-        fillTensorWithDataByType(grad_tensor, dtype, data, offset, size);
-        auto grad = tensorflow::ops::Const(root, grad_tensor);
-        
         bool use_locking = (offset < size) ? (data[offset++] % 2 == 1) : false;
         bool use_nesterov = (offset < size) ? (data[offset++] % 2 == 1) : false;
-        
-        auto adam_op = tensorflow::ops::ResourceApplyAdam(
-            root, var, m, v, beta1_power, beta2_power, lr, beta1, beta2, epsilon, grad,
-            tensorflow::ops::ResourceApplyAdam::UseLocking(use_locking)
-                .UseNesterov(use_nesterov));
-        
-        tensorflow::ClientSession session(root);
-        
-        std::vector<tensorflow::Operation> init_ops = {var_init.operation, m_init.operation, v_init.operation};
-        tensorflow::Status init_status = session.Run({}, {}, init_ops, nullptr);
-        if (!init_status.ok()) {
+
+        tensorflow::Tensor var = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor m = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor v = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor beta1_power = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor beta2_power = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor lr = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor beta1 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor beta2 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor epsilon = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor grad = makeTensor(dtype, var_shape, data, offset, size);
+
+        // var and its slots are resource variables; the updated var is read back.
+        std::vector<tensorflow::Tensor> handles;
+        tensorflow::Status status = makeVariables({var, m, v}, &handles);
+        if (!status.ok()) {
+            return -1;
+        }
+
+        std::vector<tensorflow::Tensor> outputs;
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ResourceApplyAdam")
+                .attr("use_locking", use_locking)
+                .attr("use_nesterov", use_nesterov),
+            {handles[0], handles[1], handles[2], beta1_power, beta2_power, lr, beta1, beta2, epsilon,
+             grad}, &outputs);
+        if (!status.ok()) {
             return -1;
         }
-        
-        std::vector<tensorflow::Operation> ops = {adam_op.operation};
-        tensorflow::Status status = session.Run({}, {}, ops, nullptr);
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ReadVariableOp").attr("dtype", dtype), {handles[0]}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
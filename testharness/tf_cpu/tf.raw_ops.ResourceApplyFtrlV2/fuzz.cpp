@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 20) {
@@ -90,57 +82,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -193,81 +143,84 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
+// Creates a resource variable holding each value, named var_0, var_1, ...
+// in the runtime's per-input container, and returns their handles.
+tensorflow::Status makeVariables(const std::vector<tensorflow::Tensor>& values,
+                                 std::vector<tensorflow::Tensor>* handles) {
+    std::vector<tensorflow::Tensor> outputs;
+    for (size_t i = 0; i < values.size(); ++i) {
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("VarHandleOp")
+                .attr("dtype", values[i].dtype())
+                .attr("shape", tensorflow::PartialTensorShape())
+                .attr("shared_name", "var_" + std::to_string(i)),
+            {}, &outputs);
+        if (!status.ok()) {
+            return status;
+        }
+        handles->push_back(outputs[0]);
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("AssignVariableOp"), {handles->back(), values[i]}, &outputs);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    return absl::OkStatus();
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
-        
-        uint8_t grad_rank = parseRank(data[offset++]);
-        std::vector<int64_t> grad_shape = parseShape(data, offset, size, grad_rank);
-        
-        tensorflow::Tensor grad_tensor(dtype, tensorflow::TensorShape(grad_shape));
-        fillTensorWithDataByType(grad_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor lr_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(lr_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor l1_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(l1_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor l2_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(l2_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor l2_shrinkage_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(l2_shrinkage_tensor, dtype, data, offset, size);
-        
-        tensorflow::Tensor lr_power_tensor(dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(lr_power_tensor, dtype, data, offset, size);
-        
-        auto var = tensorflow::ops::VarHandleOp(root, dtype, tensorflow::TensorShape(grad_shape));
-        auto accum = tensorflow::ops::VarHandleOp(root, dtype, tensorflow::TensorShape(grad_shape));
-        auto linear = tensorflow::ops::VarHandleOp(root, dtype, tensorflow::TensorShape(grad_shape));
-        
-        tensorflow::Tensor init_tensor(dtype, tensorflow::TensorShape(grad_shape));
-        fillTensorWithDataByType(init_tensor, dtype, data, offset, size);
-        
-        auto var_init = tensorflow::ops::AssignVariableOp(root, var, tensorflow::ops::Const(root, init_tensor));
-        auto accum_init = tensorflow::ops::AssignVariableOp(root, accum, tensorflow::ops::Const(root, init_tensor));
-        auto linear_init = tensorflow::ops::AssignVariableOp(root, linear, tensorflow::ops::Const(root, init_tensor));
-        
-        bool use_locking = (data[offset % size] % 2) == 1;
-        offset++;
-        bool multiply_linear_by_lr = (data[offset % size] % 2) == 1;
-        offset++;
-        
-        auto grad_input = tensorflow::ops::Const(root, grad_tensor);
-        auto lr_input = tensorflow::ops::Const(root, lr_tensor);
-        auto l1_input = tensorflow::ops::Const(root, l1_tensor);
-        auto l2_input = tensorflow::ops::Const(root, l2_tensor);
-        auto l2_shrinkage_input = tensorflow::ops::Const(root, l2_shrinkage_tensor);
-        auto lr_power_input = tensorflow::ops::Const(root, lr_power_tensor);
-        
-        auto apply_ftrl = tensorflow::ops::ResourceApplyFtrlV2(
-            root, var, accum, linear, grad_input, lr_input, l1_input, l2_input,
-            l2_shrinkage_input, lr_power_input,
-            tensorflow::ops::ResourceApplyFtrlV2::UseLocking(use_locking)
-                .MultiplyLinearByLr(multiply_linear_by_lr));
+        if (offset >= size) return 0;
+        uint8_t var_rank = parseRank(data[offset++]);
+        std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
+        bool use_locking = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool multiply_linear_by_lr = (offset < size) ? (data[offset++] % 2 == 1) : false;
+
+        tensorflow::Tensor var = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor accum = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor linear = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor grad = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor lr = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor l1 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor l2 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor l2_shrinkage = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor lr_power = makeTensor(dtype, {}, data, offset, size);
+
+        // var and its slots are resource variables; the updated var is read back.
+        std::vector<tensorflow::Tensor> handles;
+        tensorflow::Status status = makeVariables({var, accum, linear}, &handles);
+        if (!status.ok()) {
+            return -1;
+        }
 
-        tensorflow::ClientSession session(root);
-        
-        std::vector<tensorflow::Operation> init_ops = {var_init, accum_init, linear_init};
-        tensorflow::Status init_status = session.Run({}, {}, init_ops, nullptr);
-        if (!init_status.ok()) {
+        std::vector<tensorflow::Tensor> outputs;
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ResourceApplyFtrlV2")
+                .attr("use_locking", use_locking)
+                .attr("multiply_linear_by_lr", multiply_linear_by_lr),
+            {handles[0], handles[1], handles[2], grad, lr, l1, l2, l2_shrinkage, lr_power}, &outputs);
+        if (!status.ok()) {
             return -1;
         }
-        
-        std::vector<tensorflow::Operation> ops = {apply_ftrl};
-        tensorflow::Status status = session.Run({}, {}, ops, nullptr);
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ReadVariableOp").attr("dtype", dtype), {handles[0]}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
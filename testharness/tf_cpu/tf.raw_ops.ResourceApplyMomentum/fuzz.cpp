@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -15,12 +13,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 20) {
@@ -89,57 +81,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -192,84 +142,80 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
+// Creates a resource variable holding each value, named var_0, var_1, ...
+// in the runtime's per-input container, and returns their handles.
+tensorflow::Status makeVariables(const std::vector<tensorflow::Tensor>& values,
+                                 std::vector<tensorflow::Tensor>* handles) {
+    std::vector<tensorflow::Tensor> outputs;
+    for (size_t i = 0; i < values.size(); ++i) {
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("VarHandleOp")
+                .attr("dtype", values[i].dtype())
+                .attr("shape", tensorflow::PartialTensorShape())
+                .attr("shared_name", "var_" + std::to_string(i)),
+            {}, &outputs);
+        if (!status.ok()) {
+            return status;
+        }
+        handles->push_back(outputs[0]);
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("AssignVariableOp"), {handles->back(), values[i]}, &outputs);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    return absl::OkStatus();
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
-        
+        if (offset >= size) return 0;
         uint8_t var_rank = parseRank(data[offset++]);
         std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
-        
-        uint8_t accum_rank = parseRank(data[offset++]);
-        std::vector<int64_t> accum_shape = parseShape(data, offset, size, accum_rank);
-        
-        uint8_t lr_rank = parseRank(data[offset++]);
-        std::vector<int64_t> lr_shape = parseShape(data, offset, size, lr_rank);
-        
-        uint8_t grad_rank = parseRank(data[offset++]);
-        std::vector<int64_t> grad_shape = parseShape(data, offset, size, grad_rank);
-        
-        uint8_t momentum_rank = parseRank(data[offset++]);
-        std::vector<int64_t> momentum_shape = parseShape(data, offset, size, momentum_rank);
-        
         bool use_locking = (offset < size) ? (data[offset++] % 2 == 1) : false;
         bool use_nesterov = (offset < size) ? (data[offset++] % 2 == 1) : false;
 
-        tensorflow::TensorShape var_tensor_shape(var_shape);
-        tensorflow::TensorShape accum_tensor_shape(accum_shape);
-        tensorflow::TensorShape lr_tensor_shape(lr_shape);
-        tensorflow::TensorShape grad_tensor_shape(grad_shape);
-        tensorflow::TensorShape momentum_tensor_shape(momentum_shape);
-
-        auto var_resource = tensorflow::ops::VarHandleOp(root, dtype, var_tensor_shape);
-        auto accum_resource = tensorflow::ops::VarHandleOp(root, dtype, accum_tensor_shape);
-
-        tensorflow::Tensor var_init_tensor(dtype, var_tensor_shape);
-        tensorflow::Tensor accum_init_tensor(dtype, accum_tensor_shape);
-        tensorflow::Tensor lr_tensor(dtype, lr_tensor_shape);
-        tensorflow::Tensor grad_tensor(dtype, grad_tensor_shape);
-        tensorflow::Tensor momentum_tensor(dtype, momentum_tensor_shape);
+        tensorflow::Tensor var = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor accum = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor lr = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor grad = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor momentum = makeTensor(dtype, {}, data, offset, size);
 
-        fillTensorWithDataByType(var_init_tensor, dtype, data, offset, size);
-        fillTensorWithDataByType(accum_init_tensor, dtype, data, offset, size);
-        fillTensorWithDataByType(lr_tensor, dtype, data, offset, size);
-        fillTensorWithDataByType(grad_tensor, dtype, data, offset, size);
-        fillTensorWithDataByType(momentum_tensor, dtype, data, offset, size);
-
-        auto var_init = tensorflow::ops::Const(root, var_init_tensor);
-        auto accum_init = tensorflow::ops::Const(root, accum_init_tensor);
-        auto lr_const = tensorflow::ops::Const(root, lr_tensor);
-        auto grad_const = tensorflow::ops::Const(root, grad_tensor);
-        auto momentum_const = tensorflow::ops::Const(root, momentum_tensor);
-
-        auto var_assign = tensorflow::ops::AssignVariableOp(root, var_resource, var_init);
-        auto accum_assign = tensorflow::ops::AssignVariableOp(root, accum_resource, accum_init);
-
-        auto momentum_op = tensorflow::ops::ResourceApplyMomentum(
-            root, var_resource, accum_resource, lr_const, grad_const, momentum_const,
-            tensorflow::ops::ResourceApplyMomentum::UseLocking(use_locking)
-                .UseNesterov(use_nesterov));
-
-        tensorflow::ClientSession session(root);
-        
-        std::vector<tensorflow::Operation> init_ops = {var_assign, accum_assign};
-        tensorflow::Status init_status = session.Run({}, {}, init_ops, nullptr);
-        if (!init_status.ok()) {
+        // var and its slots are resource variables; the updated var is read back.
+        std::vector<tensorflow::Tensor> handles;
+        tensorflow::Status status = makeVariables({var, accum}, &handles);
+        if (!status.ok()) {
             return -1;
         }
 
-        std::vector<tensorflow::Operation> run_ops = {momentum_op};
-        tensorflow::Status status = session.Run({}, {}, run_ops, nullptr);
+        std::vector<tensorflow::Tensor> outputs;
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ResourceApplyMomentum")
+                .attr("use_locking", use_locking)
+                .attr("use_nesterov", use_nesterov),
+            {handles[0], handles[1], lr, grad, momentum}, &outputs);
+        if (!status.ok()) {
+            return -1;
+        }
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("ReadVariableOp").attr("dtype", dtype), {handles[0]}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/sparse_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -15,12 +13,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 20) {
@@ -89,57 +81,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -195,67 +145,89 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
-extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
-    if (size < 20) return 0;
-    
-    size_t offset = 0;
-
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
-    try {
-        auto handle_tensor = tensorflow::Tensor(tensorflow::DT_STRING, tensorflow::TensorShape({}));
-        handle_tensor.scalar<tensorflow::tstring>()() = "test_accumulator";
-        auto handle = tensorflow::ops::Const(root, handle_tensor);
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
 
-        auto local_step_tensor = tensorflow::Tensor(tensorflow::DT_INT64, tensorflow::TensorShape({}));
-        if (offset + sizeof(int64_t) <= size) {
-            int64_t step_val;
-            std::memcpy(&step_val, data + offset, sizeof(int64_t));
-            offset += sizeof(int64_t);
-            local_step_tensor.scalar<int64_t>()() = std::abs(step_val) % 1000;
+// Indices into a first dimension of size `limit`. `limit` itself can come
+// up, so out-of-range indices are covered too.
+tensorflow::Tensor makeIndices(tensorflow::DataType dtype, int64_t count, int64_t limit,
+                               const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor indices(dtype, tensorflow::TensorShape({count}));
+    for (int64_t i = 0; i < count; ++i) {
+        const int64_t index = (offset < size) ? data[offset++] % (limit + 1) : 0;
+        if (dtype == tensorflow::DT_INT64) {
+            indices.flat<int64_t>()(i) = index;
         } else {
-            local_step_tensor.scalar<int64_t>()() = 1;
+            indices.flat<int32_t>()(i) = static_cast<int32_t>(index);
         }
-        auto local_step = tensorflow::ops::Const(root, local_step_tensor);
-
-        uint8_t indices_rank = parseRank(data[offset % size]);
-        offset++;
-        std::vector<int64_t> indices_shape = parseShape(data, offset, size, indices_rank);
-        auto indices_tensor = tensorflow::Tensor(tensorflow::DT_INT64, tensorflow::TensorShape(indices_shape));
-        fillTensorWithData<int64_t>(indices_tensor, data, offset, size);
-        auto gradient_indices = tensorflow::ops::Const(root, indices_tensor);
+    }
+    return indices;
+}
 
-        tensorflow::DataType values_dtype = parseDataType(data[offset % size]);
-        offset++;
-        uint8_t values_rank = parseRank(data[offset % size]);
-        offset++;
-        std::vector<int64_t> values_shape = parseShape(data, offset, size, values_rank);
-        auto values_tensor = tensorflow::Tensor(values_dtype, tensorflow::TensorShape(values_shape));
-        fillTensorWithDataByType(values_tensor, values_dtype, data, offset, size);
-        auto gradient_values = tensorflow::ops::Const(root, values_tensor);
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    FUZZ_TRACE_INPUT();
+    if (size < 20) return 0;
 
-        uint8_t shape_rank = parseRank(data[offset % size]);
-        offset++;
-        std::vector<int64_t> shape_shape = parseShape(data, offset, size, shape_rank);
-        auto shape_tensor = tensorflow::Tensor(tensorflow::DT_INT64, tensorflow::TensorShape(shape_shape));
-        fillTensorWithData<int64_t>(shape_tensor, data, offset, size);
-        auto gradient_shape = tensorflow::ops::Const(root, shape_tensor);
+    size_t offset = 0;
 
-        bool has_known_shape = (data[offset % size] % 2) == 0;
-        offset++;
+    try {
+        tensorflow::DataType dtype = parseDataType(data[offset++]);
+        if (offset >= size) return 0;
+        uint8_t rank = tf_fuzzer_utils::parseRank(data[offset++], 1, MAX_RANK);
+        std::vector<int64_t> shape = parseShape(data, offset, size, rank);
+        bool known_shape = (offset < size) ? (data[offset++] % 2 == 1) : true;
+        bool mean = (offset < size) ? (data[offset++] % 2 == 1) : true;
+        std::string reduction_type = mean ? "MEAN" : "SUM";
+        uint8_t num_gradients = (offset < size) ? data[offset++] % 3 : 0;
+
+        tensorflow::PartialTensorShape accumulator_shape =
+            known_shape ? tensorflow::PartialTensorShape(shape) : tensorflow::PartialTensorShape();
+
+        // The accumulator lives in the runtime's per-input container.
+        std::vector<tensorflow::Tensor> accumulator;
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("SparseConditionalAccumulator")
+                .attr("dtype", dtype)
+                .attr("shape", accumulator_shape)
+                .attr("reduction_type", reduction_type),
+            {}, &accumulator);
+        if (!status.ok()) {
+            return -1;
+        }
+        std::vector<tensorflow::Tensor> outputs;
 
-        auto sparse_accumulator_apply_gradient = tensorflow::ops::Raw::SparseAccumulatorApplyGradient(
-            root, handle, local_step, gradient_indices, gradient_values, gradient_shape,
-            tensorflow::ops::Raw::SparseAccumulatorApplyGradient::Attrs().HasKnownShape(has_known_shape));
+        for (uint8_t i = 0; i < num_gradients; ++i) {
+            tensorflow::Tensor local_step(static_cast<int64_t>((offset < size) ? data[offset++] % 3 : 0));
+            int64_t count = (offset < size) ? data[offset++] % 3 : 0;
+            tensorflow::Tensor indices =
+                makeIndices(tensorflow::DT_INT64, count, shape[0], data, offset, size);
+            std::vector<int64_t> values_shape = shape;
+            values_shape[0] = count;
+            tensorflow::Tensor values = makeTensor(dtype, values_shape, data, offset, size);
+            tensorflow::Tensor gradient_shape(tensorflow::DT_INT64,
+                                              tensorflow::TensorShape({static_cast<int64_t>(shape.size())}));
+            for (size_t d = 0; d < shape.size(); ++d) {
+                gradient_shape.flat<int64_t>()(d) = shape[d];
+            }
+            status = tf_fuzzer_utils::runOp(
+                tf_fuzzer_utils::OpSpec("SparseAccumulatorApplyGradient")
+                    .attr("has_known_shape", known_shape),
+                {accumulator[0], local_step, indices, values, gradient_shape}, &outputs);
+            if (!status.ok()) {
+                return -1;
+            }
+        }
 
-        tensorflow::ClientSession session(root);
-        std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({sparse_accumulator_apply_gradient}, &outputs);
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("AccumulatorNumAccumulated"), {accumulator[0]}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
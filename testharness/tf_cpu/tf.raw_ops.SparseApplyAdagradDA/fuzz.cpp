@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/training_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 20) {
@@ -94,248 +86,78 @@ tensorflow::DataType parseIndicesDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
+}
 
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
+using tf_fuzzer_utils::fillTensorWithDataByType;
 
-    return shape;
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
+// Indices into a first dimension of size `limit`. `limit` itself can come
+// up, so out-of-range indices are covered too.
+tensorflow::Tensor makeIndices(tensorflow::DataType dtype, int64_t count, int64_t limit,
+                               const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor indices(dtype, tensorflow::TensorShape({count}));
+    for (int64_t i = 0; i < count; ++i) {
+        const int64_t index = (offset < size) ? data[offset++] % (limit + 1) : 0;
+        if (dtype == tensorflow::DT_INT64) {
+            indices.flat<int64_t>()(i) = index;
         } else {
-            flat(i) = T{};
+            indices.flat<int32_t>()(i) = static_cast<int32_t>(index);
         }
     }
-}
-
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-    switch (dtype) {
-        case tensorflow::DT_FLOAT:
-            fillTensorWithData<float>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_DOUBLE:
-            fillTensorWithData<double>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT32:
-            fillTensorWithData<int32_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT8:
-            fillTensorWithData<uint8_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT16:
-            fillTensorWithData<int16_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT8:
-            fillTensorWithData<int8_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_INT64:
-            fillTensorWithData<int64_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_BOOL:
-            fillTensorWithData<bool>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT16:
-            fillTensorWithData<uint16_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT32:
-            fillTensorWithData<uint32_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_UINT64:
-            fillTensorWithData<uint64_t>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_BFLOAT16:
-            fillTensorWithData<tensorflow::bfloat16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_HALF:
-            fillTensorWithData<Eigen::half>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_COMPLEX64:
-            fillTensorWithData<tensorflow::complex64>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_COMPLEX128:
-            fillTensorWithData<tensorflow::complex128>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT8:
-            fillTensorWithData<tensorflow::qint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT8:
-            fillTensorWithData<tensorflow::quint8>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT32:
-            fillTensorWithData<tensorflow::qint32>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QINT16:
-            fillTensorWithData<tensorflow::qint16>(tensor, data, offset, total_size);
-            break;
-        case tensorflow::DT_QUINT16:
-            fillTensorWithData<tensorflow::quint16>(tensor, data, offset, total_size);
-            break;
-        default:
-            break;
-    }
+    return indices;
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
-        tensorflow::DataType var_dtype = parseDataType(data[offset++]);
-        tensorflow::DataType indices_dtype = parseIndicesDataType(data[offset++]);
-        
-        uint8_t var_rank = parseRank(data[offset++]);
-        uint8_t indices_rank = 1;
-        
-        std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
-        
+        tensorflow::DataType dtype = parseDataType(data[offset++]);
         if (offset >= size) return 0;
-        
-        int64_t num_indices = 1 + (data[offset++] % 5);
-        std::vector<int64_t> indices_shape = {num_indices};
-        
-        std::vector<int64_t> grad_shape = indices_shape;
-        if (var_rank > 0) {
-            grad_shape.insert(grad_shape.end(), var_shape.begin() + 1, var_shape.end());
-        }
-        
-        tensorflow::TensorShape var_tensor_shape(var_shape);
-        tensorflow::TensorShape grad_accumulator_tensor_shape(var_shape);
-        tensorflow::TensorShape grad_squared_accumulator_tensor_shape(var_shape);
-        tensorflow::TensorShape grad_tensor_shape(grad_shape);
-        tensorflow::TensorShape indices_tensor_shape(indices_shape);
-        tensorflow::TensorShape scalar_shape({});
-        
-        tensorflow::Tensor var_tensor(var_dtype, var_tensor_shape);
-        tensorflow::Tensor grad_accumulator_tensor(var_dtype, grad_accumulator_tensor_shape);
-        tensorflow::Tensor grad_squared_accumulator_tensor(var_dtype, grad_squared_accumulator_tensor_shape);
-        tensorflow::Tensor grad_tensor(var_dtype, grad_tensor_shape);
-        tensorflow::Tensor indices_tensor(indices_dtype, indices_tensor_shape);
-        tensorflow::Tensor lr_tensor(var_dtype, scalar_shape);
-        tensorflow::Tensor l1_tensor(var_dtype, scalar_shape);
-        tensorflow::Tensor l2_tensor(var_dtype, scalar_shape);
-        tensorflow::Tensor global_step_tensor(tensorflow::DT_INT64, scalar_shape);
-        
-        fillTensorWithDataByType(var_tensor, var_dtype, data, offset, size);
-        fillTensorWithDataByType(grad_accumulator_tensor, var_dtype, data, offset, size);
-        fillTensorWithDataByType(grad_squared_accumulator_tensor, var_dtype, data, offset, size);
-        fillTensorWithDataByType(grad_tensor, var_dtype, data, offset, size);
-        
-        if (indices_dtype == tensorflow::DT_INT32) {
-            auto indices_flat = indices_tensor.flat<int32_t>();
-            for (int i = 0; i < num_indices; ++i) {
-                if (offset + sizeof(int32_t) <= size) {
-                    int32_t idx;
-                    std::memcpy(&idx, data + offset, sizeof(int32_t));
-                    offset += sizeof(int32_t);
-                    indices_flat(i) = std::abs(idx) % (var_shape.empty() ? 1 : var_shape[0]);
-                } else {
-                    indices_flat(i) = 0;
-                }
-            }
-        } else {
-            auto indices_flat = indices_tensor.flat<int64_t>();
-            for (int i = 0; i < num_indices; ++i) {
-                if (offset + sizeof(int64_t) <= size) {
-                    int64_t idx;
-                    std::memcpy(&idx, data + offset, sizeof(int64_t));
-                    offset += sizeof(int64_t);
-                    indices_flat(i) = std::abs(idx) % (var_shape.empty() ? 1 : var_shape[0]);
-                } else {
-                    indices_flat(i) = 0;
-                }
-            }
-        }
-        
-        fillTensorWithDataByType(lr_tensor, var_dtype, data, offset, size);
-        fillTensorWithDataByType(l1_tensor, var_dtype, data, offset, size);
-        fillTensorWithDataByType(l2_tensor, var_dtype, data, offset, size);
-        
-        if (offset + sizeof(int64_t) <= size) {
-            int64_t global_step_val;
-            std::memcpy(&global_step_val, data + offset, sizeof(int64_t));
-            offset += sizeof(int64_t);
-            global_step_tensor.scalar<int64_t>()() = std::abs(global_step_val) % 1000000;
-        } else {
-            global_step_tensor.scalar<int64_t>()() = 1;
-        }
-        
+        uint8_t var_rank = tf_fuzzer_utils::parseRank(data[offset++], 1, MAX_RANK);
+        std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
         bool use_locking = (offset < size) ? (data[offset++] % 2 == 1) : false;
-        
-        auto var_input = tensorflow::ops::Const(root, var_tensor);
-        auto grad_accumulator_input = tensorflow::ops::Const(root, grad_accumulator_tensor);
-        auto grad_squared_accumulator_input = tensorflow::ops::Const(root, grad_squared_accumulator_tensor);
-        auto grad_input = tensorflow::ops::Const(root, grad_tensor);
-        auto indices_input = tensorflow::ops::Const(root, indices_tensor);
-        auto lr_input = tensorflow::ops::Const(root, lr_tensor);
-        auto l1_input = tensorflow::ops::Const(root, l1_tensor);
-        auto l2_input = tensorflow::ops::Const(root, l2_tensor);
-        auto global_step_input = tensorflow::ops::Const(root, global_step_tensor);
-        
-        auto sparse_apply_adagrad_da = tensorflow::ops::SparseApplyAdagradDA(
-            root,
-            var_input,
-            grad_accumulator_input,
-            grad_squared_accumulator_input,
-            grad_input,
-            indices_input,
-            lr_input,
-            l1_input,
-            l2_input,
-            global_step_input,
-            tensorflow::ops::SparseApplyAdagradDA::UseLocking(use_locking)
-        );
-        
-        tensorflow::ClientSession session(root);
+        bool int64_indices = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        int64_t num_indices = (offset < size) ? data[offset++] % 4 : 0;
+        std::vector<int64_t> grad_shape = var_shape;
+        grad_shape[0] = num_indices;
+
+        tensorflow::Tensor var = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor gradient_accumulator = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor gradient_squared_accumulator = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor grad = makeTensor(dtype, grad_shape, data, offset, size);
+        tensorflow::DataType indices_dtype = int64_indices ? tensorflow::DT_INT64 : tensorflow::DT_INT32;
+        tensorflow::Tensor indices =
+            makeIndices(indices_dtype, num_indices, var_shape[0], data, offset, size);
+        tensorflow::Tensor lr = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor l1 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor l2 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor global_step = makeTensor(tensorflow::DT_INT64, {}, data, offset, size);
+
+        // var and its slots are passed as refs and updated in place.
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({sparse_apply_adagrad_da}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("SparseApplyAdagradDA").attr("use_locking", use_locking),
+            {var, gradient_accumulator, gradient_squared_accumulator, grad, indices, lr, l1, l2,
+             global_step}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
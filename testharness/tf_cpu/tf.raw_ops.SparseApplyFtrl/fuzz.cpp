@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/training_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype;
     switch (selector % 20) {
@@ -90,57 +82,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -196,115 +146,70 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
+// Indices into a first dimension of size `limit`. `limit` itself can come
+// up, so out-of-range indices are covered too.
+tensorflow::Tensor makeIndices(tensorflow::DataType dtype, int64_t count, int64_t limit,
+                               const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor indices(dtype, tensorflow::TensorShape({count}));
+    for (int64_t i = 0; i < count; ++i) {
+        const int64_t index = (offset < size) ? data[offset++] % (limit + 1) : 0;
+        if (dtype == tensorflow::DT_INT64) {
+            indices.flat<int64_t>()(i) = index;
+        } else {
+            indices.flat<int32_t>()(i) = static_cast<int32_t>(index);
+        }
+    }
+    return indices;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
-        tensorflow::DataType var_dtype = parseDataType(data[offset++]);
-        
-        uint8_t var_rank = parseRank(data[offset++]);
+        tensorflow::DataType dtype = parseDataType(data[offset++]);
+        if (offset >= size) return 0;
+        uint8_t var_rank = tf_fuzzer_utils::parseRank(data[offset++], 1, MAX_RANK);
         std::vector<int64_t> var_shape = parseShape(data, offset, size, var_rank);
-        
-        tensorflow::DataType indices_dtype = (data[offset++] % 2 == 0) ? tensorflow::DT_INT32 : tensorflow::DT_INT64;
-        
-        uint8_t indices_rank = 1;
-        std::vector<int64_t> indices_shape = {std::min(static_cast<int64_t>(5), var_shape.empty() ? 1 : var_shape[0])};
-        
-        bool use_locking = (data[offset++] % 2 == 1);
-        bool multiply_linear_by_lr = (data[offset++] % 2 == 1);
-        
-        tensorflow::Tensor var_tensor(var_dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(var_tensor, var_dtype, data, offset, size);
-        
-        tensorflow::Tensor accum_tensor(var_dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(accum_tensor, var_dtype, data, offset, size);
-        
-        tensorflow::Tensor linear_tensor(var_dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(linear_tensor, var_dtype, data, offset, size);
-        
-        tensorflow::Tensor grad_tensor(var_dtype, tensorflow::TensorShape(var_shape));
-        fillTensorWithDataByType(grad_tensor, var_dtype, data, offset, size);
-        
-        tensorflow::Tensor indices_tensor(indices_dtype, tensorflow::TensorShape(indices_shape));
-        if (indices_dtype == tensorflow::DT_INT32) {
-            fillTensorWithData<int32_t>(indices_tensor, data, offset, size);
-            auto indices_flat = indices_tensor.flat<int32_t>();
-            for (int i = 0; i < indices_flat.size(); ++i) {
-                indices_flat(i) = std::abs(indices_flat(i)) % (var_shape.empty() ? 1 : var_shape[0]);
-            }
-        } else {
-            fillTensorWithData<int64_t>(indices_tensor, data, offset, size);
-            auto indices_flat = indices_tensor.flat<int64_t>();
-            for (int i = 0; i < indices_flat.size(); ++i) {
-                indices_flat(i) = std::abs(indices_flat(i)) % (var_shape.empty() ? 1 : var_shape[0]);
-            }
-        }
-        
-        tensorflow::Tensor lr_tensor(var_dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(lr_tensor, var_dtype, data, offset, size);
-        
-        tensorflow::Tensor l1_tensor(var_dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(l1_tensor, var_dtype, data, offset, size);
-        
-        tensorflow::Tensor l2_tensor(var_dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(l2_tensor, var_dtype, data, offset, size);
-        
-        tensorflow::Tensor lr_power_tensor(var_dtype, tensorflow::TensorShape({}));
-        fillTensorWithDataByType(lr_power_tensor, var_dtype, data, offset, size);
-        
-        auto var_placeholder = tensorflow::ops::Placeholder(root, var_dtype);
-        auto accum_placeholder = tensorflow::ops::Placeholder(root, var_dtype);
-        auto linear_placeholder = tensorflow::ops::Placeholder(root, var_dtype);
-        auto grad_placeholder = tensorflow::ops::Placeholder(root, var_dtype);
-        auto indices_placeholder = tensorflow::ops::Placeholder(root, indices_dtype);
-        auto lr_placeholder = tensorflow::ops::Placeholder(root, var_dtype);
-        auto l1_placeholder = tensorflow::ops::Placeholder(root, var_dtype);
-        auto l2_placeholder = tensorflow::ops::Placeholder(root, var_dtype);
-        auto lr_power_placeholder = tensorflow::ops::Placeholder(root, var_dtype);
-        
-        auto sparse_apply_ftrl = tensorflow::ops::SparseApplyFtrl(
-            root,
-            var_placeholder,
-            accum_placeholder,
-            linear_placeholder,
-            grad_placeholder,
-            indices_placeholder,
-            lr_placeholder,
-            l1_placeholder,
-            l2_placeholder,
-            lr_power_placeholder,
-            tensorflow::ops::SparseApplyFtrl::UseLocking(use_locking)
-                .MultiplyLinearByLr(multiply_linear_by_lr)
-        );
-        
-        tensorflow::ClientSession session(root);
-        
+        bool use_locking = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool multiply_linear_by_lr = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool int64_indices = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        int64_t num_indices = (offset < size) ? data[offset++] % 4 : 0;
+        std::vector<int64_t> grad_shape = var_shape;
+        grad_shape[0] = num_indices;
+
+        tensorflow::Tensor var = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor accum = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor linear = makeTensor(dtype, var_shape, data, offset, size);
+        tensorflow::Tensor grad = makeTensor(dtype, grad_shape, data, offset, size);
+        tensorflow::DataType indices_dtype = int64_indices ? tensorflow::DT_INT64 : tensorflow::DT_INT32;
+        tensorflow::Tensor indices =
+            makeIndices(indices_dtype, num_indices, var_shape[0], data, offset, size);
+        tensorflow::Tensor lr = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor l1 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor l2 = makeTensor(dtype, {}, data, offset, size);
+        tensorflow::Tensor lr_power = makeTensor(dtype, {}, data, offset, size);
+
+        // var and its slots are passed as refs and updated in place.
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run(
-            {
-                {var_placeholder, var_tensor},
-                {accum_placeholder, accum_tensor},
-                {linear_placeholder, linear_tensor},
-                {grad_placeholder, grad_tensor},
-                {indices_placeholder, indices_tensor},
-                {lr_placeholder, lr_tensor},
-                {l1_placeholder, l1_tensor},
-                {l2_placeholder, l2_tensor},
-                {lr_power_placeholder, lr_power_tensor}
-            },
-            {sparse_apply_ftrl},
-            &outputs
-        );
-        
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("SparseApplyFtrl")
+                .attr("use_locking", use_locking)
+                .attr("multiply_linear_by_lr", multiply_linear_by_lr),
+            {var, accum, linear, grad, indices, lr, l1, l2, lr_power}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
@@ -1,10 +1,8 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
-#include "tensorflow/core/graph/node_builder.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-    void logError(const std::string& message, const uint8_t* data, size_t size) {
-        std::cerr << "Error: " << message << std::endl;
-    }
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype; 
     switch (selector % 21) {  
@@ -93,57 +85,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -219,59 +169,57 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
-        std::vector<tensorflow::DataType> allowed_types = {
-            tensorflow::DT_FLOAT,
-            tensorflow::DT_INT32,
-            tensorflow::DT_BOOL,
-            tensorflow::DT_STRING
-        };
-        tensorflow::DataType elem_type = allowed_types[data[offset++] % allowed_types.size()];
-
-        tensorflow::Node* stack_node = nullptr;
-        tensorflow::Status status = tensorflow::NodeBuilder(
-                                        root.GetUniqueNameForOp("Stack"),
-                                        "Stack")
-                                        .Attr("elem_type", elem_type)
-                                        .Attr("stack_name", std::string())
-                                        .Device("/cpu:0")
-                                        .Finalize(root.graph(), &stack_node);
+        tensorflow::DataType elem_dtype = parseDataType(data[offset++]);
+        uint8_t num_pushes = (offset < size) ? data[offset++] % 3 : 0;
+        bool swap_memory = (offset < size) ? (data[offset++] % 2 == 1) : false;
+
+        // Stacks are step-scoped; all runOp calls of one input share a step.
+        std::vector<tensorflow::Tensor> stack;
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("Stack")
+                .attr("elem_type", elem_dtype)
+                .attr("stack_name", std::string("stack")),
+            {}, &stack);
         if (!status.ok()) {
-            tf_fuzzer_utils::logError("Failed to create Stack node: " + status.ToString(), data, size);
             return -1;
         }
-
-        tensorflow::Node* close_node = nullptr;
-        status = tensorflow::NodeBuilder(
-                     root.GetUniqueNameForOp("StackClose"),
-                     "StackClose")
-                     .Input(tensorflow::NodeBuilder::NodeOut(stack_node, 0))
-                     .Device("/cpu:0")
-                     .Finalize(root.graph(), &close_node);
-        if (!status.ok()) {
-            tf_fuzzer_utils::logError("Failed to create StackClose node: " + status.ToString(), data, size);
-            return -1;
+        std::vector<tensorflow::Tensor> outputs;
+        for (uint8_t i = 0; i < num_pushes; ++i) {
+            if (offset >= size) return 0;
+            uint8_t elem_rank = parseRank(data[offset++]);
+            std::vector<int64_t> elem_shape = parseShape(data, offset, size, elem_rank);
+            tensorflow::Tensor elem = makeTensor(elem_dtype, elem_shape, data, offset, size);
+            status = tf_fuzzer_utils::runOp(
+                tf_fuzzer_utils::OpSpec("StackPush").attr("swap_memory", swap_memory),
+                {stack[0], elem}, &outputs);
+            if (!status.ok()) {
+                return -1;
+            }
         }
 
-        tensorflow::ClientSession session(root);
-        status = session.Run({}, {}, {tensorflow::Operation(close_node)}, nullptr);
+        status = tf_fuzzer_utils::runOp(tf_fuzzer_utils::OpSpec("StackClose"), {stack[0]}, &outputs);
         if (!status.ok()) {
-            tf_fuzzer_utils::logError("Error running session: " + status.ToString(), data, size);
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
-    } 
+    }
 
     return 0;
 }
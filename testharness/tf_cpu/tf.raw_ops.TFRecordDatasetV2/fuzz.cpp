@@ -1,22 +1,14 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
-#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tf_fuzzer_utils.h"
 #include <array>
 #include <cstring>
 #include <iostream>
 #include <string>
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* /*data*/, size_t /*size*/) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}  // namespace tf_fuzzer_utils
-
 std::string ConsumeString(const uint8_t* data, size_t& offset, size_t size) {
     if (offset >= size) return "file";
     const size_t remaining = size - offset;
@@ -41,10 +33,10 @@ int64_t ConsumeBoundedInt(const uint8_t* data, size_t& offset, size_t size,
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    FUZZ_TRACE_INPUT();
     if (size == 0) return 0;
 
     size_t offset = 0;
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
 
     try {
         int filename_count = 1;
@@ -87,32 +79,10 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             }
         }
 
-        auto filenames_input =
-            tensorflow::ops::Const(root.WithOpName("filenames"), filenames_tensor);
-        auto compression_input =
-            tensorflow::ops::Const(root.WithOpName("compression_type"), compression_tensor);
-        auto buffer_size_input =
-            tensorflow::ops::Const(root.WithOpName("buffer_size"), buffer_size_tensor);
-        auto byte_offsets_input =
-            tensorflow::ops::Const(root.WithOpName("byte_offsets"), byte_offsets_tensor);
-
-        tensorflow::Node* dataset_node = nullptr;
-        auto status = tensorflow::NodeBuilder(
-                          root.GetUniqueNameForOp("TFRecordDatasetV2"), "TFRecordDatasetV2")
-                          .Input(filenames_input.node())
-                          .Input(compression_input.node())
-                          .Input(buffer_size_input.node())
-                          .Input(byte_offsets_input.node())
-                          .Attr("metadata", "")
-                          .Finalize(root.graph(), &dataset_node);
-        if (!status.ok()) {
-            tf_fuzzer_utils::logError(status.ToString(), data, size);
-            return 0;
-        }
-
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        status = session.Run({tensorflow::Output(dataset_node, 0)}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("TFRecordDatasetV2").attr("metadata", std::string("")),
+            {filenames_tensor, compression_tensor, buffer_size_tensor, byte_offsets_tensor}, &outputs);
         if (!status.ok()) {
             return 0;
         }
@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -16,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype; 
     switch (selector % 21) {  
@@ -93,57 +85,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -218,61 +168,70 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
-        
-        tensorflow::Tensor handle_tensor(tensorflow::DT_STRING, tensorflow::TensorShape({}));
-        handle_tensor.scalar<tensorflow::tstring>()() = "test_handle";
-        
-        tensorflow::Tensor flow_in_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        if (offset < size) {
-            float flow_val;
-            std::memcpy(&flow_val, data + offset, std::min(sizeof(float), size - offset));
-            offset += sizeof(float);
-            flow_in_tensor.scalar<float>()() = flow_val;
-        } else {
-            flow_in_tensor.scalar<float>()() = 1.0f;
+        if (offset >= size) return 0;
+        uint8_t element_rank = parseRank(data[offset++]);
+        std::vector<int64_t> element_shape = parseShape(data, offset, size, element_rank);
+        int32_t num_elements = (offset < size) ? data[offset++] % 4 : 0;
+        bool dynamic_size = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool clear_after_read = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool known_shape = (offset < size) ? (data[offset++] % 2 == 1) : true;
+        // Elements differ in their first dim, so only the rest is declared.
+        tensorflow::PartialTensorShape declared_shape =
+            known_shape ? tensorflow::PartialTensorShape(element_shape) : tensorflow::PartialTensorShape();
+
+        // TensorArrays are step-scoped; all runOp calls of one input share a step.
+        tensorflow::Tensor array_size(num_elements);
+        std::vector<tensorflow::Tensor> tensor_array;
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("TensorArray")
+                .attr("dtype", dtype)
+                .attr("element_shape", tensorflow::PartialTensorShape())
+                .attr("dynamic_size", dynamic_size)
+                .attr("clear_after_read", clear_after_read),
+            {array_size}, &tensor_array);
+        if (!status.ok()) {
+            return -1;
         }
+        tensorflow::Tensor handle = tensor_array[0];
+        tensorflow::Tensor flow(0.0f);
+        std::vector<tensorflow::Tensor> outputs;
 
-        auto handle_input = tensorflow::ops::Const(root, handle_tensor);
-        auto flow_in_input = tensorflow::ops::Const(root, flow_in_tensor);
-
-        std::vector<int64_t> element_shape_except0;
-        if (offset < size) {
-            uint8_t shape_size = data[offset++] % 4;
-            for (uint8_t i = 0; i < shape_size && offset + sizeof(int64_t) <= size; ++i) {
-                int64_t dim;
-                std::memcpy(&dim, data + offset, sizeof(int64_t));
-                offset += sizeof(int64_t);
-                element_shape_except0.push_back(std::abs(dim) % 10 + 1);
+        for (int32_t i = 0; i < num_elements; ++i) {
+            tensorflow::Tensor index(i);
+            std::vector<int64_t> value_shape = {(offset < size) ? data[offset++] % 3 : 0};
+            value_shape.insert(value_shape.end(), element_shape.begin(), element_shape.end());
+            tensorflow::Tensor value = makeTensor(dtype, value_shape, data, offset, size);
+            status = tf_fuzzer_utils::runOp(
+                tf_fuzzer_utils::OpSpec("TensorArrayWrite"), {handle, index, value, flow}, &outputs);
+            if (!status.ok()) {
+                return -1;
             }
+            flow = outputs[0];
         }
-
-        tensorflow::ops::TensorArrayConcat::Attrs attrs;
-        if (!element_shape_except0.empty()) {
-            tensorflow::PartialTensorShape shape(element_shape_except0);
-            attrs = attrs.ElementShapeExcept0(shape);
-        }
-
-        auto tensor_array_concat = tensorflow::ops::TensorArrayConcat(
-            root, handle_input, flow_in_input, dtype, attrs);
-
-        tensorflow::ClientSession session(root);
-        std::vector<tensorflow::Tensor> outputs;
-        
-        tensorflow::Status status = session.Run({tensor_array_concat.value, tensor_array_concat.lengths}, &outputs);
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("TensorArrayConcat")
+                .attr("dtype", dtype)
+                .attr("element_shape_except0", declared_shape),
+            {handle, flow}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
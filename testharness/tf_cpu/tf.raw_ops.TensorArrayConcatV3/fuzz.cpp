@@ -1,12 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/array_ops.h"
-#include "tensorflow/cc/ops/data_flow_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <iostream>
 #include <cstring>
 #include <vector>
@@ -17,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype; 
     switch (selector % 17) {  
@@ -82,57 +73,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -208,89 +157,76 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 10) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
         tensorflow::DataType dtype = parseDataType(data[offset++]);
-        
-        if (dtype == tensorflow::DT_STRING) {
-            return 0;
-        }
-
-        int32_t array_size = (data[offset++] % 5) + 1;
-        
-        tensorflow::TensorShape element_shape_except0;
+        if (offset >= size) return 0;
         uint8_t element_rank = parseRank(data[offset++]);
-        if (element_rank > 0) {
-            std::vector<int64_t> element_dims = parseShape(data, offset, size, element_rank);
-            for (auto dim : element_dims) {
-                element_shape_except0.AddDim(dim);
-            }
+        std::vector<int64_t> element_shape = parseShape(data, offset, size, element_rank);
+        int32_t num_elements = (offset < size) ? data[offset++] % 4 : 0;
+        bool dynamic_size = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool clear_after_read = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool known_shape = (offset < size) ? (data[offset++] % 2 == 1) : true;
+        bool identical_element_shapes = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        // Elements differ in their first dim, so only the rest is declared.
+        tensorflow::PartialTensorShape declared_shape =
+            known_shape ? tensorflow::PartialTensorShape(element_shape) : tensorflow::PartialTensorShape();
+
+        // TensorArrays are step-scoped; all runOp calls of one input share a step.
+        tensorflow::Tensor array_size(num_elements);
+        std::vector<tensorflow::Tensor> tensor_array;
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("TensorArrayV3")
+                .attr("dtype", dtype)
+                .attr("element_shape", tensorflow::PartialTensorShape())
+                .attr("dynamic_size", dynamic_size)
+                .attr("clear_after_read", clear_after_read)
+                .attr("identical_element_shapes", identical_element_shapes),
+            {array_size}, &tensor_array);
+        if (!status.ok()) {
+            return -1;
         }
+        tensorflow::Tensor handle = tensor_array[0];
+        tensorflow::Tensor flow = tensor_array[1];
+        std::vector<tensorflow::Tensor> outputs;
 
-        // Create a tensor array
-        auto size_tensor = tensorflow::ops::Const(root, tensorflow::Tensor(array_size));
-        auto tensor_array = tensorflow::ops::DataFlowOps::TensorArray(root, size_tensor, dtype);
-        
-        auto flow = tensorflow::ops::Const(root, 0.0f);
-        
-        tensorflow::Output current_flow = flow;
-        
-        for (int32_t i = 0; i < array_size; ++i) {
-            if (offset >= size) break;
-            
-            int64_t first_dim = (data[offset++] % 5) + 1;
-            
-            tensorflow::TensorShape write_shape;
-            write_shape.AddDim(first_dim);
-            for (int j = 0; j < element_shape_except0.dims(); ++j) {
-                write_shape.AddDim(element_shape_except0.dim_size(j));
+        for (int32_t i = 0; i < num_elements; ++i) {
+            tensorflow::Tensor index(i);
+            std::vector<int64_t> value_shape = {(offset < size) ? data[offset++] % 3 : 0};
+            value_shape.insert(value_shape.end(), element_shape.begin(), element_shape.end());
+            tensorflow::Tensor value = makeTensor(dtype, value_shape, data, offset, size);
+            status = tf_fuzzer_utils::runOp(
+                tf_fuzzer_utils::OpSpec("TensorArrayWriteV3"), {handle, index, value, flow}, &outputs);
+            if (!status.ok()) {
+                return -1;
             }
-            
-            tensorflow::Tensor write_tensor(dtype, write_shape);
-            fillTensorWithDataByType(write_tensor, dtype, data, offset, size);
-            
-            auto write_value = tensorflow::ops::Const(root, write_tensor);
-            auto index = tensorflow::ops::Const(root, i);
-            auto write_op = tensorflow::ops::DataFlowOps::TensorArrayWrite(
-                root, tensor_array.handle, index, write_value, current_flow);
-            current_flow = write_op;
+            flow = outputs[0];
         }
-
-        // Create a vector of int64 for element_shape_except0
-        std::vector<int64_t> element_shape_vec;
-        for (int i = 0; i < element_shape_except0.dims(); ++i) {
-            element_shape_vec.push_back(element_shape_except0.dim_size(i));
-        }
-        auto element_shape_tensor = tensorflow::ops::Const(root, tensorflow::Tensor(
-            tensorflow::TensorShape({static_cast<int64_t>(element_shape_vec.size())}), element_shape_vec));
-
-        // Use TensorArrayConcat instead of TensorArrayConcatV3
-        auto concat_result = tensorflow::ops::DataFlowOps::TensorArrayConcat(
-            root, 
-            tensor_array.handle, 
-            current_flow,
-            element_shape_tensor
-        );
-
-        tensorflow::ClientSession session(root);
-        std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({concat_result.value, concat_result.lengths}, &outputs);
-        
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("TensorArrayConcatV3")
+                .attr("dtype", dtype)
+                .attr("element_shape_except0", declared_shape),
+            {handle, flow}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
-    } 
+    }
 
     return 0;
 }
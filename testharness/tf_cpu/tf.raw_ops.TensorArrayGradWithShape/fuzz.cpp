@@ -1,12 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
-#include "tensorflow/cc/ops/array_ops.h"
-#include "tensorflow/cc/ops/data_flow_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -17,12 +14,6 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << "Error: " << message << std::endl;
-}
-}
-
 tensorflow::DataType parseDataType(uint8_t selector) {
     tensorflow::DataType dtype; 
     switch (selector % 21) {  
@@ -94,57 +85,15 @@ tensorflow::DataType parseDataType(uint8_t selector) {
 }
 
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-    auto flat = tensor.flat<T>();
-    const size_t num_elements = flat.size();
-    const size_t element_size = sizeof(T);
-
-    for (size_t i = 0; i < num_elements; ++i) {
-        if (offset + element_size <= total_size) {
-            T value;
-            std::memcpy(&value, data + offset, element_size);
-            offset += element_size;
-            flat(i) = value;
-        } else {
-            flat(i) = T{};
-        }
-    }
-}
+using tf_fuzzer_utils::fillTensorWithData;
 
 void fillTensorWithDataByType(tensorflow::Tensor& tensor,
                               tensorflow::DataType dtype, const uint8_t* data,
@@ -219,74 +168,82 @@ void fillTensorWithDataByType(tensorflow::Tensor& tensor,
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillTensorWithDataByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 20) return 0;
-    
-    size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+    size_t offset = 0;
 
     try {
-        tensorflow::DataType array_dtype = parseDataType(data[offset++]);
-        
-        uint8_t array_rank = parseRank(data[offset++]);
-        std::vector<int64_t> array_shape = parseShape(data, offset, size, array_rank);
-        
-        uint8_t shape_to_prepend_rank = parseRank(data[offset++]);
-        std::vector<int64_t> shape_to_prepend_shape = parseShape(data, offset, size, shape_to_prepend_rank);
-        
-        float flow_in_value = 1.0f;
-        if (offset + sizeof(float) <= size) {
-            std::memcpy(&flow_in_value, data + offset, sizeof(float));
-            offset += sizeof(float);
+        tensorflow::DataType dtype = parseDataType(data[offset++]);
+        if (offset >= size) return 0;
+        uint8_t element_rank = parseRank(data[offset++]);
+        std::vector<int64_t> element_shape = parseShape(data, offset, size, element_rank);
+        int32_t num_elements = (offset < size) ? data[offset++] % 4 : 0;
+        bool dynamic_size = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool clear_after_read = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool known_shape = (offset < size) ? (data[offset++] % 2 == 1) : true;
+        bool identical_element_shapes = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        tensorflow::PartialTensorShape declared_shape =
+            known_shape ? tensorflow::PartialTensorShape(element_shape) : tensorflow::PartialTensorShape();
+
+        // TensorArrays are step-scoped; all runOp calls of one input share a step.
+        tensorflow::Tensor array_size(num_elements);
+        std::vector<tensorflow::Tensor> tensor_array;
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("TensorArrayV3")
+                .attr("dtype", dtype)
+                .attr("element_shape", declared_shape)
+                .attr("dynamic_size", dynamic_size)
+                .attr("clear_after_read", clear_after_read)
+                .attr("identical_element_shapes", identical_element_shapes),
+            {array_size}, &tensor_array);
+        if (!status.ok()) {
+            return -1;
         }
-        
-        std::string source_str = "gradient_source";
-        if (offset < size) {
-            uint8_t source_len = data[offset] % 20 + 1;
-            offset++;
-            source_str = "";
-            for (uint8_t i = 0; i < source_len && offset < size; ++i) {
-                source_str += static_cast<char>((data[offset] % 26) + 'a');
-                offset++;
+        tensorflow::Tensor handle = tensor_array[0];
+        tensorflow::Tensor flow = tensor_array[1];
+        std::vector<tensorflow::Tensor> outputs;
+
+        for (int32_t i = 0; i < num_elements; ++i) {
+            tensorflow::Tensor index(i);
+            tensorflow::Tensor value = makeTensor(dtype, element_shape, data, offset, size);
+            status = tf_fuzzer_utils::runOp(
+                tf_fuzzer_utils::OpSpec("TensorArrayWriteV3"), {handle, index, value, flow}, &outputs);
+            if (!status.ok()) {
+                return -1;
             }
+            flow = outputs[0];
         }
-        
-        auto tensor_array = tensorflow::ops::TensorArray(root, 10, array_dtype);
-        
-        tensorflow::Tensor flow_in_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
-        flow_in_tensor.scalar<float>()() = flow_in_value;
-        auto flow_in_op = tensorflow::ops::Const(root, flow_in_tensor);
-        
-        tensorflow::Tensor shape_to_prepend_tensor(tensorflow::DT_INT32, 
-            tensorflow::TensorShape({static_cast<int64_t>(shape_to_prepend_shape.size())}));
-        auto shape_flat = shape_to_prepend_tensor.flat<int32_t>();
-        for (size_t i = 0; i < shape_to_prepend_shape.size(); ++i) {
-            shape_flat(i) = static_cast<int32_t>(shape_to_prepend_shape[i]);
+        int64_t prepend_rank = (offset < size) ? data[offset++] % 3 : 0;
+        tensorflow::Tensor shape_to_prepend(tensorflow::DT_INT32, tensorflow::TensorShape({prepend_rank}));
+        for (int64_t i = 0; i < prepend_rank; ++i) {
+            shape_to_prepend.flat<int32_t>()(i) = (offset < size) ? data[offset++] % 3 + 1 : 1;
         }
-        auto shape_to_prepend_op = tensorflow::ops::Const(root, shape_to_prepend_tensor);
-        
-        auto grad_op = tensorflow::ops::TensorArrayGradWithShape(
-            root, 
-            tensor_array.handle, 
-            flow_in_op, 
-            shape_to_prepend_op, 
-            source_str
-        );
-        
-        tensorflow::ClientSession session(root);
-        std::vector<tensorflow::Tensor> outputs;
-        
-        tensorflow::Status status = session.Run({grad_op.grad_handle, grad_op.flow_out}, &outputs);
+        std::vector<tensorflow::Tensor> grad;
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("TensorArrayGradWithShape").attr("source", std::string("grad")),
+            {handle, flow, shape_to_prepend}, &grad);
+        if (!status.ok()) {
+            return -1;
+        }
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("TensorArraySizeV3"), {grad[0], flow}, &outputs);
         if (!status.ok()) {
             return -1;
         }
-
     } catch (const std::exception& e) {
         tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
         return -1;
-    } 
+    }
 
     return 0;
 }
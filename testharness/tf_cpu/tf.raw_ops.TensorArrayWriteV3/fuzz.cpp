@@ -1,9 +1,7 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
-#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tf_fuzzer_utils.h"
 
 #include <cstdlib>
 #include <algorithm>
@@ -12,12 +10,6 @@
 #include <iostream>
 #include <vector>
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t*, size_t) {
-    std::cerr << message << std::endl;
-}
-}  // namespace tf_fuzzer_utils
-
 constexpr int kMaxRank = 4;
 constexpr int kMinDim = 1;
 constexpr int kMaxDim = 8;
@@ -88,72 +80,69 @@ void fillByType(tensorflow::Tensor& tensor, tensorflow::DataType dtype, const ui
     }
 }
 
+// Fills a tensor of `dtype` and `shape` from the input.
+tensorflow::Tensor makeTensor(tensorflow::DataType dtype, const std::vector<int64_t>& shape,
+                              const uint8_t* data, size_t& offset, size_t size) {
+    tensorflow::Tensor tensor(dtype, tensorflow::TensorShape(shape));
+    fillByType(tensor, dtype, data, offset, size);
+    return tensor;
+}
+
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    if (size < 4) {
-        return 0;
-    }
+    FUZZ_TRACE_INPUT();
+    if (size < 4) return 0;
 
     size_t offset = 0;
-    auto dtype = pickDataType(data[offset++]);
-    uint8_t rank = parseRank(data[offset++]);
-    std::vector<int64_t> value_shape_dims = parseShape(data, offset, size, rank);
-
-    int32_t array_size = 4;
-    if (offset + sizeof(int32_t) <= size) {
-        std::memcpy(&array_size, data + offset, sizeof(int32_t));
-        offset += sizeof(int32_t);
-        array_size = std::max<int32_t>(1, std::abs(array_size % 32));
-    }
-
-    int32_t index_value = 0;
-    if (offset + sizeof(int32_t) <= size) {
-        std::memcpy(&index_value, data + offset, sizeof(int32_t));
-        offset += sizeof(int32_t);
-    }
-    index_value = std::abs(index_value) % array_size;
 
-    tensorflow::TensorShape value_shape;
-    for (int64_t dim : value_shape_dims) {
-        value_shape.AddDim(dim);
-    }
-    tensorflow::Tensor value_tensor(dtype, value_shape);
-    fillByType(value_tensor, dtype, data, offset, size);
-
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
-    auto size_const = tensorflow::ops::Const(root.WithOpName("tensor_array_size"), array_size);
-    auto value_const = tensorflow::ops::Const(root.WithOpName("tensor_array_value"), value_tensor);
-    auto index_const = tensorflow::ops::Const(root.WithOpName("tensor_array_index"), index_value);
-
-    tensorflow::Node* tensor_array_node = nullptr;
-    tensorflow::Status status = tensorflow::NodeBuilder("TensorArrayV3Node", "TensorArrayV3")
-                                    .Input(size_const.node())
-                                    .Attr("dtype", dtype)
-                                    .Attr("element_shape", value_shape)
-                                    .Finalize(root.graph(), &tensor_array_node);
-    if (!status.ok()) {
-        tf_fuzzer_utils::logError("Failed to create TensorArrayV3 node: " + status.ToString(), data, size);
-        return 0;
-    }
-
-    tensorflow::Node* write_node = nullptr;
-    status = tensorflow::NodeBuilder("TensorArrayWriteV3Node", "TensorArrayWriteV3")
-                 .Input(tensorflow::NodeBuilder::NodeOut(tensor_array_node, 0))
-                 .Input(index_const.node())
-                 .Input(value_const.node())
-                 .Input(tensorflow::NodeBuilder::NodeOut(tensor_array_node, 1))
-                 .Attr("T", dtype)
-                 .Finalize(root.graph(), &write_node);
-    if (!status.ok()) {
-        tf_fuzzer_utils::logError("Failed to create TensorArrayWriteV3 node: " + status.ToString(), data, size);
-        return 0;
-    }
-
-    tensorflow::ClientSession session(root);
-    std::vector<tensorflow::Tensor> outputs;
-    status = session.Run({tensorflow::Output(write_node, 0)}, &outputs);
-    if (!status.ok()) {
-        tf_fuzzer_utils::logError("Session run failed: " + status.ToString(), data, size);
+    try {
+        tensorflow::DataType dtype = pickDataType(data[offset++]);
+        if (offset >= size) return 0;
+        uint8_t element_rank = parseRank(data[offset++]);
+        std::vector<int64_t> element_shape = parseShape(data, offset, size, element_rank);
+        int32_t num_elements = (offset < size) ? data[offset++] % 4 : 0;
+        bool dynamic_size = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool clear_after_read = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        bool known_shape = (offset < size) ? (data[offset++] % 2 == 1) : true;
+        bool identical_element_shapes = (offset < size) ? (data[offset++] % 2 == 1) : false;
+        tensorflow::PartialTensorShape declared_shape =
+            known_shape ? tensorflow::PartialTensorShape(element_shape) : tensorflow::PartialTensorShape();
+
+        // TensorArrays are step-scoped; all runOp calls of one input share a step.
+        tensorflow::Tensor array_size(num_elements);
+        std::vector<tensorflow::Tensor> tensor_array;
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("TensorArrayV3")
+                .attr("dtype", dtype)
+                .attr("element_shape", declared_shape)
+                .attr("dynamic_size", dynamic_size)
+                .attr("clear_after_read", clear_after_read)
+                .attr("identical_element_shapes", identical_element_shapes),
+            {array_size}, &tensor_array);
+        if (!status.ok()) {
+            return -1;
+        }
+        tensorflow::Tensor handle = tensor_array[0];
+        tensorflow::Tensor flow = tensor_array[1];
+        std::vector<tensorflow::Tensor> outputs;
+
+        int32_t write_index = (offset < size) ? data[offset++] % (num_elements + 1) : 0;
+        tensorflow::Tensor index(write_index);
+        tensorflow::Tensor value = makeTensor(dtype, element_shape, data, offset, size);
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("TensorArrayWriteV3"), {handle, index, value, flow}, &outputs);
+        if (!status.ok()) {
+            return -1;
+        }
+        flow = outputs[0];
+        status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("TensorArrayReadV3").attr("dtype", dtype),
+            {handle, index, flow}, &outputs);
+        if (!status.ok()) {
+            return -1;
+        }
+    } catch (const std::exception& e) {
+        tf_fuzzer_utils::logError("CPU Execution error: " + std::string(e.what()), data, size);
+        return -1;
     }
 
     return 0;
@@ -1,13 +1,11 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -18,160 +16,48 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-void logError(const std::string& message, const uint8_t* data, size_t size) {
-    std::cerr << message << std::endl;
-}
-}
-
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-  auto flat = tensor.flat<T>();
-  const size_t num_elements = flat.size();
-  const size_t element_size = sizeof(T);
-
-  for (size_t i = 0; i < num_elements; ++i) {
-    if (offset + element_size <= total_size) {
-      T value;
-      std::memcpy(&value, data + offset, element_size);
-      offset += element_size;
-      flat(i) = value;
-    } else {
-      flat(i) = T{};
-    }
-  }
-}
-
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-  switch (dtype) {
-    case tensorflow::DT_FLOAT:
-      fillTensorWithData<float>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_DOUBLE:
-      fillTensorWithData<double>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT32:
-      fillTensorWithData<int32_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT8:
-      fillTensorWithData<uint8_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT16:
-      fillTensorWithData<int16_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT8:
-      fillTensorWithData<int8_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT64:
-      fillTensorWithData<int64_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_BOOL:
-      fillTensorWithData<bool>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT16:
-      fillTensorWithData<uint16_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT32:
-      fillTensorWithData<uint32_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT64:
-      fillTensorWithData<uint64_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_BFLOAT16:
-      fillTensorWithData<tensorflow::bfloat16>(tensor, data, offset,
-                                               total_size);
-      break;
-    case tensorflow::DT_HALF:
-      fillTensorWithData<Eigen::half>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_COMPLEX64:
-      fillTensorWithData<tensorflow::complex64>(tensor, data, offset,
-                                                total_size);
-      break;
-    case tensorflow::DT_COMPLEX128:
-      fillTensorWithData<tensorflow::complex128>(tensor, data, offset,
-                                                 total_size);
-      break;
-    default:
-      break;
-  }
-}
+using tf_fuzzer_utils::fillTensorWithDataByType;
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 100) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         uint8_t row_pointers_rank = parseRank(data[offset++]);
         std::vector<int64_t> row_pointers_shape = parseShape(data, offset, size, row_pointers_rank);
         tensorflow::Tensor row_pointers_tensor(tensorflow::DT_INT32, tensorflow::TensorShape(row_pointers_shape));
         fillTensorWithDataByType(row_pointers_tensor, tensorflow::DT_INT32, data, offset, size);
-        auto row_pointers = tensorflow::ops::Const(root, row_pointers_tensor);
 
         uint8_t sorted_sample_ids_rank = parseRank(data[offset++]);
         std::vector<int64_t> sorted_sample_ids_shape = parseShape(data, offset, size, sorted_sample_ids_rank);
         tensorflow::Tensor sorted_sample_ids_tensor(tensorflow::DT_INT32, tensorflow::TensorShape(sorted_sample_ids_shape));
         fillTensorWithDataByType(sorted_sample_ids_tensor, tensorflow::DT_INT32, data, offset, size);
-        auto sorted_sample_ids = tensorflow::ops::Const(root, sorted_sample_ids_tensor);
 
         uint8_t sorted_token_ids_rank = parseRank(data[offset++]);
         std::vector<int64_t> sorted_token_ids_shape = parseShape(data, offset, size, sorted_token_ids_rank);
         tensorflow::Tensor sorted_token_ids_tensor(tensorflow::DT_INT32, tensorflow::TensorShape(sorted_token_ids_shape));
         fillTensorWithDataByType(sorted_token_ids_tensor, tensorflow::DT_INT32, data, offset, size);
-        auto sorted_token_ids = tensorflow::ops::Const(root, sorted_token_ids_tensor);
 
         uint8_t sorted_gains_rank = parseRank(data[offset++]);
         std::vector<int64_t> sorted_gains_shape = parseShape(data, offset, size, sorted_gains_rank);
         tensorflow::Tensor sorted_gains_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape(sorted_gains_shape));
         fillTensorWithDataByType(sorted_gains_tensor, tensorflow::DT_FLOAT, data, offset, size);
-        auto sorted_gains = tensorflow::ops::Const(root, sorted_gains_tensor);
 
         uint8_t activation_gradients_rank = parseRank(data[offset++]);
         std::vector<int64_t> activation_gradients_shape = parseShape(data, offset, size, activation_gradients_rank);
         tensorflow::Tensor activation_gradients_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape(activation_gradients_shape));
         fillTensorWithDataByType(activation_gradients_tensor, tensorflow::DT_FLOAT, data, offset, size);
-        auto activation_gradients = tensorflow::ops::Const(root, activation_gradients_tensor);
 
         tensorflow::Tensor learning_rate_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({}));
         if (offset + sizeof(float) <= size) {
@@ -182,25 +68,21 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         } else {
             learning_rate_tensor.scalar<float>()() = 0.01f;
         }
-        auto learning_rate = tensorflow::ops::Const(root, learning_rate_tensor);
 
         uint8_t embedding_table_rank = parseRank(data[offset++]);
         std::vector<int64_t> embedding_table_shape = parseShape(data, offset, size, embedding_table_rank);
         tensorflow::Tensor embedding_table_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape(embedding_table_shape));
         fillTensorWithDataByType(embedding_table_tensor, tensorflow::DT_FLOAT, data, offset, size);
-        auto embedding_table = tensorflow::ops::Const(root, embedding_table_tensor);
 
         uint8_t accumulator_rank = parseRank(data[offset++]);
         std::vector<int64_t> accumulator_shape = parseShape(data, offset, size, accumulator_rank);
         tensorflow::Tensor accumulator_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape(accumulator_shape));
         fillTensorWithDataByType(accumulator_tensor, tensorflow::DT_FLOAT, data, offset, size);
-        auto accumulator = tensorflow::ops::Const(root, accumulator_tensor);
 
         uint8_t linear_rank = parseRank(data[offset++]);
         std::vector<int64_t> linear_shape = parseShape(data, offset, size, linear_rank);
         tensorflow::Tensor linear_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape(linear_shape));
         fillTensorWithDataByType(linear_tensor, tensorflow::DT_FLOAT, data, offset, size);
-        auto linear = tensorflow::ops::Const(root, linear_tensor);
 
         tensorflow::Tensor num_minibatches_tensor(tensorflow::DT_INT32, tensorflow::TensorShape({}));
         if (offset + sizeof(int32_t) <= size) {
@@ -211,7 +93,6 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
         } else {
             num_minibatches_tensor.scalar<int32_t>()() = 1;
         }
-        auto num_minibatches_per_physical_sparse_core = tensorflow::ops::Const(root, num_minibatches_tensor);
 
         bool multiply_linear_by_learning_rate = (offset < size) ? (data[offset++] % 2 == 0) : false;
 
@@ -267,35 +148,22 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
             offset += sizeof(float);
         }
 
-        // Use raw_ops namespace for XlaSparseDenseMatmulGradWithFtrlAndStaticBufferSize
-        auto result = tensorflow::ops::Raw::XlaSparseDenseMatmulGradWithFtrlAndStaticBufferSize(
-            root,
-            row_pointers,
-            sorted_sample_ids,
-            sorted_token_ids,
-            sorted_gains,
-            activation_gradients,
-            learning_rate,
-            embedding_table,
-            accumulator,
-            linear,
-            num_minibatches_per_physical_sparse_core,
-            tensorflow::ops::Raw::XlaSparseDenseMatmulGradWithFtrlAndStaticBufferSize::Attrs()
-                .MultiplyLinearByLearningRate(multiply_linear_by_learning_rate)
-                .Beta(beta)
-                .LearningRatePower(learning_rate_power)
-                .L1RegularizationStrength(l1_regularization_strength)
-                .L2RegularizationStrength(l2_regularization_strength)
-                .MaxIdsPerSparseCore(max_ids_per_sparse_core)
-                .MaxUniqueIdsPerSparseCore(max_unique_ids_per_sparse_core)
-                .TableName(table_name)
-                .ClipWeightMin(clip_weight_min)
-                .ClipWeightMax(clip_weight_max)
-        );
-
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        tensorflow::Status status = session.Run({result.updated_embedding_table, result.updated_accumulator, result.updated_linear}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("XlaSparseDenseMatmulGradWithFtrlAndStaticBufferSize")
+                .attr("multiply_linear_by_learning_rate", multiply_linear_by_learning_rate)
+                .attr("beta", beta)
+                .attr("learning_rate_power", learning_rate_power)
+                .attr("l1_regularization_strength", l1_regularization_strength)
+                .attr("l2_regularization_strength", l2_regularization_strength)
+                .attr("max_ids_per_sparse_core", max_ids_per_sparse_core)
+                .attr("max_unique_ids_per_sparse_core", max_unique_ids_per_sparse_core)
+                .attr("table_name", table_name)
+                .attr("clip_weight_min", clip_weight_min)
+                .attr("clip_weight_max", clip_weight_max),
+            {row_pointers_tensor, sorted_sample_ids_tensor, sorted_token_ids_tensor, sorted_gains_tensor,
+             activation_gradients_tensor, learning_rate_tensor, embedding_table_tensor, accumulator_tensor,
+             linear_tensor, num_minibatches_tensor}, &outputs);
         if (!status.ok()) {
             return -1;
         }
@@ -1,11 +1,9 @@
-#include "tensorflow/cc/client/client_session.h"
-#include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/public/session_options.h"
-#include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tf_fuzzer_utils.h"
 #include <cstring>
 #include <vector>
 #include <iostream>
@@ -16,166 +14,53 @@
 #define MIN_TENSOR_SHAPE_DIMS_TF 1
 #define MAX_TENSOR_SHAPE_DIMS_TF 10
 
-namespace tf_fuzzer_utils {
-    void logError(const std::string& message, const uint8_t* data, size_t size) {
-        std::cerr << "Error: " << message << std::endl;
-    }
-}
-
 uint8_t parseRank(uint8_t byte) {
-    constexpr uint8_t range = MAX_RANK - MIN_RANK + 1;
-    uint8_t rank = byte % range + MIN_RANK;
-    return rank;
+    return tf_fuzzer_utils::parseRank(byte, MIN_RANK, MAX_RANK);
 }
 
 std::vector<int64_t> parseShape(const uint8_t* data, size_t& offset, size_t total_size, uint8_t rank) {
-    if (rank == 0) {
-        return {};
-    }
-
-    std::vector<int64_t> shape;
-    shape.reserve(rank);
-    const auto sizeof_dim = sizeof(int64_t);
-
-    for (uint8_t i = 0; i < rank; ++i) {
-        if (offset + sizeof_dim <= total_size) {
-            int64_t dim_val;
-            std::memcpy(&dim_val, data + offset, sizeof_dim);
-            offset += sizeof_dim;
-            
-            dim_val = MIN_TENSOR_SHAPE_DIMS_TF +
-                    static_cast<int64_t>((static_cast<uint64_t>(std::abs(dim_val)) %
-                                        static_cast<uint64_t>(MAX_TENSOR_SHAPE_DIMS_TF - MIN_TENSOR_SHAPE_DIMS_TF + 1)));
-
-            shape.push_back(dim_val);
-        } else {
-             shape.push_back(1);
-        }
-    }
-
-    return shape;
+    return tf_fuzzer_utils::parseShape(data, offset, total_size, rank,
+                                       MIN_TENSOR_SHAPE_DIMS_TF, MAX_TENSOR_SHAPE_DIMS_TF);
 }
 
-template <typename T>
-void fillTensorWithData(tensorflow::Tensor& tensor, const uint8_t* data,
-                        size_t& offset, size_t total_size) {
-  auto flat = tensor.flat<T>();
-  const size_t num_elements = flat.size();
-  const size_t element_size = sizeof(T);
-
-  for (size_t i = 0; i < num_elements; ++i) {
-    if (offset + element_size <= total_size) {
-      T value;
-      std::memcpy(&value, data + offset, element_size);
-      offset += element_size;
-      flat(i) = value;
-    } else {
-      flat(i) = T{};
-    }
-  }
-}
-
-void fillTensorWithDataByType(tensorflow::Tensor& tensor,
-                              tensorflow::DataType dtype, const uint8_t* data,
-                              size_t& offset, size_t total_size) {
-  switch (dtype) {
-    case tensorflow::DT_FLOAT:
-      fillTensorWithData<float>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_DOUBLE:
-      fillTensorWithData<double>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT32:
-      fillTensorWithData<int32_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT8:
-      fillTensorWithData<uint8_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT16:
-      fillTensorWithData<int16_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT8:
-      fillTensorWithData<int8_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_INT64:
-      fillTensorWithData<int64_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_BOOL:
-      fillTensorWithData<bool>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT16:
-      fillTensorWithData<uint16_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT32:
-      fillTensorWithData<uint32_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_UINT64:
-      fillTensorWithData<uint64_t>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_BFLOAT16:
-      fillTensorWithData<tensorflow::bfloat16>(tensor, data, offset,
-                                               total_size);
-      break;
-    case tensorflow::DT_HALF:
-      fillTensorWithData<Eigen::half>(tensor, data, offset, total_size);
-      break;
-    case tensorflow::DT_COMPLEX64:
-      fillTensorWithData<tensorflow::complex64>(tensor, data, offset,
-                                                total_size);
-      break;
-    case tensorflow::DT_COMPLEX128:
-      fillTensorWithData<tensorflow::complex128>(tensor, data, offset,
-                                                 total_size);
-      break;
-    default:
-      break;
-  }
-}
+using tf_fuzzer_utils::fillTensorWithDataByType;
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     if (size < 50) return 0;
     
     size_t offset = 0;
 
-    tensorflow::Scope root = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
-
     try {
         uint8_t row_pointers_rank = parseRank(data[offset++]);
         std::vector<int64_t> row_pointers_shape = parseShape(data, offset, size, row_pointers_rank);
         tensorflow::Tensor row_pointers_tensor(tensorflow::DT_INT32, tensorflow::TensorShape(row_pointers_shape));
         fillTensorWithDataByType(row_pointers_tensor, tensorflow::DT_INT32, data, offset, size);
-        auto row_pointers = tensorflow::ops::Const(root, row_pointers_tensor);
 
         uint8_t sorted_sample_ids_rank = parseRank(data[offset++]);
         std::vector<int64_t> sorted_sample_ids_shape = parseShape(data, offset, size, sorted_sample_ids_rank);
         tensorflow::Tensor sorted_sample_ids_tensor(tensorflow::DT_INT32, tensorflow::TensorShape(sorted_sample_ids_shape));
         fillTensorWithDataByType(sorted_sample_ids_tensor, tensorflow::DT_INT32, data, offset, size);
-        auto sorted_sample_ids = tensorflow::ops::Const(root, sorted_sample_ids_tensor);
 
         uint8_t sorted_token_ids_rank = parseRank(data[offset++]);
         std::vector<int64_t> sorted_token_ids_shape = parseShape(data, offset, size, sorted_token_ids_rank);
         tensorflow::Tensor sorted_token_ids_tensor(tensorflow::DT_INT32, tensorflow::TensorShape(sorted_token_ids_shape));
         fillTensorWithDataByType(sorted_token_ids_tensor, tensorflow::DT_INT32, data, offset, size);
-        auto sorted_token_ids = tensorflow::ops::Const(root, sorted_token_ids_tensor);
 
         uint8_t sorted_gains_rank = parseRank(data[offset++]);
         std::vector<int64_t> sorted_gains_shape = parseShape(data, offset, size, sorted_gains_rank);
         tensorflow::Tensor sorted_gains_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape(sorted_gains_shape));
         fillTensorWithDataByType(sorted_gains_tensor, tensorflow::DT_FLOAT, data, offset, size);
-        auto sorted_gains = tensorflow::ops::Const(root, sorted_gains_tensor);
 
         uint8_t embedding_table_rank = parseRank(data[offset++]);
         std::vector<int64_t> embedding_table_shape = parseShape(data, offset, size, embedding_table_rank);
         tensorflow::Tensor embedding_table_tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape(embedding_table_shape));
         fillTensorWithDataByType(embedding_table_tensor, tensorflow::DT_FLOAT, data, offset, size);
-        auto embedding_table = tensorflow::ops::Const(root, embedding_table_tensor);
 
         uint8_t num_minibatches_rank = parseRank(data[offset++]);
         std::vector<int64_t> num_minibatches_shape = parseShape(data, offset, size, num_minibatches_rank);
         tensorflow::Tensor num_minibatches_tensor(tensorflow::DT_INT32, tensorflow::TensorShape(num_minibatches_shape));
         fillTensorWithDataByType(num_minibatches_tensor, tensorflow::DT_INT32, data, offset, size);
-        auto num_minibatches_per_physical_sparse_core = tensorflow::ops::Const(root, num_minibatches_tensor);
 
         int input_size = 0;
         if (offset + sizeof(int) <= size) {
@@ -219,30 +104,18 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
 
         std::string table_name = "test_table";
 
-        tensorflow::Node* result_node;
-        tensorflow::Status status = tensorflow::NodeBuilder("XlaSparseDenseMatmulWithStaticBufferSize", "XlaSparseDenseMatmulWithStaticBufferSize")
-            .Input(row_pointers.node())
-            .Input(sorted_sample_ids.node())
-            .Input(sorted_token_ids.node())
-            .Input(sorted_gains.node())
-            .Input(embedding_table.node())
-            .Input(num_minibatches_per_physical_sparse_core.node())
-            .Attr("input_size", input_size)
-            .Attr("quantization_config_low", quantization_config_low)
-            .Attr("quantization_config_high", quantization_config_high)
-            .Attr("quantization_config_num_buckets", quantization_config_num_buckets)
-            .Attr("max_ids_per_sparse_core", max_ids_per_sparse_core)
-            .Attr("max_unique_ids_per_sparse_core", max_unique_ids_per_sparse_core)
-            .Attr("table_name", table_name)
-            .Finalize(root.graph(), &result_node);
-
-        if (!status.ok()) {
-            return -1;
-        }
-
-        tensorflow::ClientSession session(root);
         std::vector<tensorflow::Tensor> outputs;
-        status = session.Run({tensorflow::Output(result_node)}, &outputs);
+        tensorflow::Status status = tf_fuzzer_utils::runOp(
+            tf_fuzzer_utils::OpSpec("XlaSparseDenseMatmulWithStaticBufferSize")
+                .attr("input_size", input_size)
+                .attr("quantization_config_low", quantization_config_low)
+                .attr("quantization_config_high", quantization_config_high)
+                .attr("quantization_config_num_buckets", quantization_config_num_buckets)
+                .attr("max_ids_per_sparse_core", max_ids_per_sparse_core)
+                .attr("max_unique_ids_per_sparse_core", max_unique_ids_per_sparse_core)
+                .attr("table_name", table_name),
+            {row_pointers_tensor, sorted_sample_ids_tensor, sorted_token_ids_tensor, sorted_gains_tensor,
+             embedding_table_tensor, num_minibatches_tensor}, &outputs);
         if (!status.ok()) {
             return -1;
         }
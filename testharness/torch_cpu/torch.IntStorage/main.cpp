@@ -7,7 +7,7 @@
 // Target API: torch.IntStorage
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -8,7 +8,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing torch.accelerator" << std::endl; // keep target keyword
+    FUZZ_TRACE_INPUT(); // torch.accelerator
     (void) "torch.accelerator"; // ensure keyword is present for harness checks
     try
     {
@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -30,11 +30,8 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
         // Check if the operation was successful by comparing with expected result
         // This is just a sanity check, not a premature validation
         if (input_tensor.defined() && expected_result.defined()) {
-            bool tensors_match = torch::allclose(input_tensor, expected_result, 1e-5, 1e-8);
-            if (!tensors_match) {
-                // This is just for debugging and doesn't prevent testing edge cases
-                fuzzer_utils::compareTensors(input_tensor, expected_result, Data, Size);
-            }
+            // This is just for debugging and doesn't prevent testing edge cases
+            fuzzer_utils::compareTensors(input_tensor, expected_result, Data, Size);
         }
         
         // If there's more data, try creating another tensor and apply acos_ to it
@@ -1,3 +1,4 @@
+#define FUZZ_AUTOGRAD // Exercises autograd, so inputs do not run under InferenceMode
 #include "fuzzer_utils.h" // General fuzzing utilities
 #include <algorithm>      // For std::min/max
 #include <cmath>          // For std::sqrt
@@ -9,7 +10,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
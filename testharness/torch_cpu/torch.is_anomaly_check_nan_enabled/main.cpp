@@ -1,3 +1,4 @@
+#define FUZZ_AUTOGRAD // Exercises autograd, so inputs do not run under InferenceMode
 #include "fuzzer_utils.h"
 #include <torch/csrc/autograd/anomaly_mode.h>
 #include <iostream>
@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     const char *target_api = "torch.is_deterministic_algorithms_warn_only_enabled";
     (void)target_api;
 
@@ -10,7 +10,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
     static constexpr const char *kTargetApi = "torch.jit.ONNXTracedModule";
     (void)kTargetApi; // Keep target keyword for harness checks
 
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -13,7 +13,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
     static constexpr const char *kKeyword = "torch.jit.jit_module_from_flatbuffer";
     (void)kKeyword; // keyword marker for harness checks
 
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
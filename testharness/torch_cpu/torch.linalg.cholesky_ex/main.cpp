@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,49 +15,12 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create input tensor
-        torch::Tensor A = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // Make sure the tensor is square for Cholesky decomposition
-        // We'll reshape it if needed
-        if (A.dim() >= 2) {
-            // Get the minimum of the last two dimensions to make it square
-            int64_t min_dim = std::min(A.size(-1), A.size(-2));
-            
-            // Create a new shape with the last two dimensions set to min_dim
-            std::vector<int64_t> new_shape(A.sizes().begin(), A.sizes().end());
-            new_shape[new_shape.size() - 1] = min_dim;
-            new_shape[new_shape.size() - 2] = min_dim;
-            
-            // Reshape the tensor
-            A = A.reshape(new_shape);
-            
-            // Make the matrix symmetric positive definite (SPD)
-            // A common way to create an SPD matrix is A = X * X.t() + diagonal
-            A = torch::matmul(A, A.transpose(-2, -1));
-            
-            // Add a small positive value to the diagonal to improve numerical stability
-            // This helps ensure the matrix is positive definite
-            if (offset < Size) {
-                float diag_add = static_cast<float>(Data[offset++]) / 255.0f + 1e-3f;
-                A = A + torch::diag_embed(torch::ones(A.size(-1), A.options()) * diag_add);
-            } else {
-                A = A + torch::diag_embed(torch::ones(A.size(-1), A.options()) * 1e-3f);
-            }
-        } else {
-            // For tensors with less than 2 dimensions, reshape to a 1x1 matrix
-            A = A.reshape({1, 1});
-            
-            // Ensure it's positive
-            if (A.item<float>() <= 0) {
-                A = A.abs() + 1e-3f;
-            }
-        }
-        
-        // Convert to float or double for numerical stability
-        if (A.scalar_type() != torch::kFloat && A.scalar_type() != torch::kDouble) {
-            A = A.to(torch::kFloat);
-        }
+        // Create a Hermitian positive (semi-)definite input, sometimes close
+        // to singular
+        const uint8_t kind_byte = Data[offset++];
+        torch::Tensor A = fuzzer_utils::createMatrix(
+            Data, Size, offset,
+            kind_byte % 4 == 0 ? fuzzer_utils::MatrixKind::NearSingular : fuzzer_utils::MatrixKind::SPD);
         
         // Get check flag from input data if available
         bool check = false;
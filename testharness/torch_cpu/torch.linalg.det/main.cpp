@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,36 +15,9 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create a square matrix for determinant calculation
-        torch::Tensor input = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // Determinant requires a square matrix (n x n)
-        // If tensor is not 2D, reshape it to a square matrix if possible
-        if (input.dim() != 2 || input.size(0) != input.size(1)) {
-            // Calculate total number of elements
-            int64_t total_elements = input.numel();
-            
-            // Find a square size that can fit in the tensor
-            int64_t square_size = static_cast<int64_t>(std::sqrt(total_elements));
-            
-            // Reshape to square matrix
-            if (square_size > 0) {
-                input = input.reshape({square_size, square_size});
-            } else {
-                // If we can't reshape to a square matrix, create a small one
-                input = torch::ones({1, 1}, input.options());
-            }
-        }
-        
-        // Try to convert to a supported dtype for determinant if needed
-        if (input.scalar_type() == torch::kBool || 
-            input.scalar_type() == torch::kUInt8 || 
-            input.scalar_type() == torch::kInt8 || 
-            input.scalar_type() == torch::kInt16 || 
-            input.scalar_type() == torch::kInt32 || 
-            input.scalar_type() == torch::kInt64) {
-            input = input.to(torch::kFloat);
-        }
+        // Create a square float or complex matrix: usually well-conditioned
+        // (diagonally dominant, orthogonal, SPD, ...), sometimes near-singular
+        torch::Tensor input = fuzzer_utils::createMatrix(Data, Size, offset);
         
         // Calculate determinant
         torch::Tensor det = torch::det(input);
@@ -61,7 +34,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             
             // Edge case: identity matrix
             if (edge_case % 5 == 1) {
-                torch::Tensor identity = torch::eye(input.size(0), input.options());
+                torch::Tensor identity = torch::eye(input.size(-1), input.options());
                 torch::Tensor identity_det = torch::det(identity);
             }
             
@@ -78,10 +51,10 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             }
             
             // Edge case: singular matrix (if possible)
-            if (edge_case % 5 == 4 && input.size(0) > 1) {
+            if (edge_case % 5 == 4 && input.size(-1) > 1) {
                 torch::Tensor singular = input.clone();
                 // Make one row a multiple of another to create singularity
-                singular.index_put_({1}, singular.index({0}));
+                singular.select(-2, 1).copy_(singular.select(-2, 0));
                 torch::Tensor singular_det = torch::det(singular);
             }
         }
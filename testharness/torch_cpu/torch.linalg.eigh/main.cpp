@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,57 +15,12 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create a square matrix for eigh
-        torch::Tensor input = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // eigh requires a square matrix (n x n) with at least 2 dimensions
-        // If tensor is not at least 2D, reshape it
-        if (input.dim() < 2) {
-            // For 0D or 1D tensors, reshape to a small square matrix
-            int64_t size = 2;
-            if (input.numel() >= 4) {
-                size = 2; // 2x2 matrix
-            }
-            
-            // Try to reshape, but if there's not enough elements, create a new tensor
-            try {
-                input = input.reshape({size, size});
-            } catch (const std::exception&) {
-                // If reshape fails, create a small square matrix
-                input = torch::ones({size, size}, input.options());
-            }
-        } else {
-            // For tensors with 2+ dimensions, make the last two dimensions square
-            auto sizes = input.sizes().vec();
-            int64_t last_dim = sizes.back();
-            sizes.pop_back();
-            
-            // Make the last two dimensions square
-            if (sizes.empty()) {
-                // If we only had 2D tensor, make it square
-                input = input.reshape({last_dim, last_dim});
-            } else {
-                // For higher dimensional tensors, make last two dimensions square
-                sizes.push_back(last_dim);
-                sizes.push_back(last_dim);
-                
-                try {
-                    input = input.reshape(sizes);
-                } catch (const std::exception&) {
-                    // If reshape fails, create a tensor with the desired shape
-                    input = torch::ones(sizes, input.options());
-                }
-            }
-        }
-        
-        // Make sure the matrix is Hermitian/symmetric by adding it to its transpose/conjugate
-        // For real matrices: A + A^T is symmetric
-        // For complex matrices: A + A^H is Hermitian
-        if (input.is_complex()) {
-            input = input + input.transpose(-2, -1).conj();
-        } else {
-            input = input + input.transpose(-2, -1);
-        }
+        // Create a Hermitian positive (semi-)definite input, sometimes close
+        // to singular
+        const uint8_t kind_byte = Data[offset++];
+        torch::Tensor input = fuzzer_utils::createMatrix(
+            Data, Size, offset,
+            kind_byte % 4 == 0 ? fuzzer_utils::MatrixKind::NearSingular : fuzzer_utils::MatrixKind::SPD);
         
         // Get a byte to determine UPLO parameter
         bool upper = false; // Default to lower
@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,40 +15,10 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create input tensor
-        torch::Tensor input_tensor = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // Make sure the tensor is square for matrix inversion
-        // We don't add defensive checks, but we need to ensure the tensor has at least 2 dimensions
-        // to be able to call inverse on it
-        if (input_tensor.dim() < 2) {
-            // Add dimensions to make it at least 2D
-            input_tensor = input_tensor.unsqueeze(0);
-            if (input_tensor.dim() < 2) {
-                input_tensor = input_tensor.unsqueeze(0);
-            }
-        }
-        
-        // Make the tensor square by taking the minimum of the last two dimensions
-        // and slicing the tensor to that size
-        int64_t last_dim = input_tensor.size(-1);
-        int64_t second_last_dim = input_tensor.size(-2);
-        int64_t min_dim = std::min(last_dim, second_last_dim);
-        
-        if (min_dim > 0) {
-            input_tensor = input_tensor.slice(-1, 0, min_dim).slice(-2, 0, min_dim);
-        }
-        
-        // Convert to float or complex type if needed for numerical stability
-        // inverse requires floating point or complex input
-        if (input_tensor.dtype() == torch::kInt8 || 
-            input_tensor.dtype() == torch::kUInt8 || 
-            input_tensor.dtype() == torch::kInt16 || 
-            input_tensor.dtype() == torch::kInt32 || 
-            input_tensor.dtype() == torch::kInt64 ||
-            input_tensor.dtype() == torch::kBool) {
-            input_tensor = input_tensor.to(torch::kFloat);
-        }
+        // Create a square float or complex matrix: usually invertible
+        // (diagonally dominant, orthogonal, SPD, ...), sometimes near-singular
+        torch::Tensor input_tensor = fuzzer_utils::createMatrix(Data, Size, offset);
+        int64_t min_dim = input_tensor.size(-1);
         
         // Apply the operation
         torch::Tensor result;
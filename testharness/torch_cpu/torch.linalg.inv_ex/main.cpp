@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,40 +15,9 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create input tensor
-        torch::Tensor A = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // Make sure we have a square matrix for inv_ex
-        // If tensor is 0D or 1D, reshape to 2x2
-        if (A.dim() < 2) {
-            A = A.reshape({2, 2});
-        } else {
-            // For tensors with dim >= 2, make the last two dimensions equal
-            // to ensure a square matrix for each batch element
-            auto sizes = A.sizes().vec();
-            int64_t square_dim = std::max(sizes[sizes.size() - 1], sizes[sizes.size() - 2]);
-            sizes[sizes.size() - 1] = square_dim;
-            sizes[sizes.size() - 2] = square_dim;
-            A = A.reshape(sizes);
-        }
-        
-        // Try to make the tensor invertible by adding a scaled identity matrix
-        // This helps explore more code paths rather than always failing with singular matrices
-        if (offset + 1 < Size) {
-            uint8_t scale_factor = Data[offset++];
-            auto identity = torch::eye(A.size(-1), A.options());
-            
-            // Expand identity to match A's batch dimensions if needed
-            if (A.dim() > 2) {
-                std::vector<int64_t> expanded_sizes(A.dim(), 1);
-                expanded_sizes[A.dim() - 2] = A.size(-2);
-                expanded_sizes[A.dim() - 1] = A.size(-1);
-                identity = identity.expand(A.sizes());
-            }
-            
-            // Add scaled identity to improve conditioning
-            A = A + (scale_factor / 10.0) * identity;
-        }
+        // Create a square float or complex matrix: usually invertible
+        // (diagonally dominant, orthogonal, SPD, ...), sometimes near-singular
+        torch::Tensor A = fuzzer_utils::createMatrix(Data, Size, offset);
         
         // Apply torch.linalg.inv_ex operation
         auto result = torch::inverse(A);
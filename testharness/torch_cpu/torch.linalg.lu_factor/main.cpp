@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,46 +15,9 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create input tensor for lu_factor
-        torch::Tensor A = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // lu_factor requires a square matrix (n x n) or a batch of square matrices
-        // We'll try to handle various cases including edge cases
-        
-        // Get the tensor dimensions
-        auto dims = A.sizes().vec();
-        
-        // If tensor is 0-dim or 1-dim, reshape it to a square matrix
-        if (dims.size() <= 1) {
-            int64_t total_elements = A.numel();
-            int64_t matrix_size = std::max(static_cast<int64_t>(1), static_cast<int64_t>(std::sqrt(total_elements)));
-            
-            // Pad with zeros if needed
-            if (matrix_size * matrix_size > total_elements) {
-                A = torch::constant_pad_nd(A.reshape(-1), {0, matrix_size * matrix_size - total_elements}, 0);
-            }
-            
-            A = A.reshape({matrix_size, matrix_size});
-        }
-        // For 2+ dimensional tensors, ensure the last two dimensions are square
-        else {
-            auto last_dim = dims.back();
-            auto second_last_dim = dims[dims.size() - 2];
-            
-            // If the last two dimensions aren't equal, make them equal
-            if (last_dim != second_last_dim) {
-                int64_t square_size = std::max(last_dim, second_last_dim);
-                
-                // Create new shape with square matrix in last two dimensions
-                std::vector<int64_t> new_shape = dims;
-                new_shape[dims.size() - 2] = square_size;
-                new_shape[dims.size() - 1] = square_size;
-                
-                // Resize tensor with padding if needed
-                A = torch::constant_pad_nd(A, {0, square_size - last_dim, 0, square_size - second_last_dim}, 0);
-                A = A.reshape(new_shape);
-            }
-        }
+        // Create a square float or complex matrix: usually invertible
+        // (diagonally dominant, orthogonal, SPD, ...), sometimes near-singular
+        torch::Tensor A = fuzzer_utils::createMatrix(Data, Size, offset);
         
         // Apply lu_factor operation
         auto result = torch::lu(A, true);
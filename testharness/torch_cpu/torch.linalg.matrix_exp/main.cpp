@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,49 +15,9 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create a tensor for matrix_exp
-        torch::Tensor input_tensor = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // matrix_exp requires a square matrix (last two dimensions must be equal)
-        // If tensor has at least 2 dimensions, we'll try to make it square
-        if (input_tensor.dim() >= 2) {
-            // Get the last two dimensions
-            auto sizes = input_tensor.sizes();
-            int64_t last_dim = sizes[sizes.size() - 1];
-            int64_t second_last_dim = sizes[sizes.size() - 2];
-            
-            // If the last two dimensions are not equal, reshape to make them equal
-            if (last_dim != second_last_dim) {
-                // Choose the smaller of the two dimensions for the square matrix
-                int64_t square_dim = std::min(last_dim, second_last_dim);
-                
-                // Create a new shape vector with the last two dimensions set to square_dim
-                std::vector<int64_t> new_shape(sizes.begin(), sizes.end());
-                new_shape[new_shape.size() - 1] = square_dim;
-                new_shape[new_shape.size() - 2] = square_dim;
-                
-                // Reshape the tensor
-                input_tensor = input_tensor.reshape(new_shape);
-            }
-        } else if (input_tensor.dim() == 1) {
-            // For 1D tensor, reshape to a square matrix
-            int64_t size = input_tensor.size(0);
-            int64_t square_dim = static_cast<int64_t>(std::sqrt(size));
-            input_tensor = input_tensor.reshape({square_dim, square_dim});
-        } else if (input_tensor.dim() == 0) {
-            // For scalar tensor, reshape to a 1x1 matrix
-            input_tensor = input_tensor.reshape({1, 1});
-        }
-        
-        // Convert to float or complex if needed
-        if (input_tensor.dtype() == torch::kBool || 
-            input_tensor.dtype() == torch::kUInt8 || 
-            input_tensor.dtype() == torch::kInt8 || 
-            input_tensor.dtype() == torch::kInt16 || 
-            input_tensor.dtype() == torch::kInt32 || 
-            input_tensor.dtype() == torch::kInt64) {
-            input_tensor = input_tensor.to(torch::kFloat);
-        }
+        // Create a square float or complex matrix: usually well-conditioned
+        // (diagonally dominant, orthogonal, SPD, ...), sometimes near-singular
+        torch::Tensor input_tensor = fuzzer_utils::createMatrix(Data, Size, offset);
         
         // Apply matrix_exp operation
         torch::Tensor result = torch::matrix_exp(input_tensor);
@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,24 +15,9 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create a square matrix for slogdet
-        torch::Tensor input = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // slogdet requires a square matrix (n x n)
-        // If tensor is not 2D, reshape it to a square matrix if possible
-        if (input.dim() != 2 || input.size(0) != input.size(1)) {
-            int64_t total_elements = input.numel();
-            int64_t matrix_size = static_cast<int64_t>(std::sqrt(total_elements));
-            
-            // Ensure we have enough elements for at least a 1x1 matrix
-            if (matrix_size > 0) {
-                // Reshape to square matrix
-                input = input.reshape({matrix_size, matrix_size});
-            } else {
-                // Create a minimal 1x1 matrix if we don't have enough elements
-                input = torch::ones({1, 1}, input.options());
-            }
-        }
+        // Create a square float or complex matrix: usually well-conditioned
+        // (diagonally dominant, orthogonal, SPD, ...), sometimes near-singular
+        torch::Tensor input = fuzzer_utils::createMatrix(Data, Size, offset);
         
         // Apply slogdet operation
         auto result = torch::slogdet(input);
@@ -66,7 +51,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
                     case 1:
                         // Test with transposed matrix
                         try {
-                            auto transposed = input.transpose(0, 1);
+                            auto transposed = input.transpose(-2, -1);
                             auto trans_det = torch::slogdet(transposed);
                         } catch (...) {
                             // Ignore errors
@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,36 +15,10 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
 
-        // Create coefficient matrix A
-        torch::Tensor A = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // Ensure A has at least 2 dimensions for linalg.solve
-        if (A.dim() < 2) {
-            if (A.dim() == 0) {
-                A = A.unsqueeze(0).unsqueeze(0);
-            } else {
-                A = A.unsqueeze(0);
-            }
-        }
-        
-        // Make A square for the last two dimensions
+        // Create coefficient matrix A: a square float or complex matrix, usually
+        // invertible (diagonally dominant, orthogonal, SPD, ...), sometimes near-singular
+        torch::Tensor A = fuzzer_utils::createMatrix(Data, Size, offset);
         auto shape = A.sizes().vec();
-        int64_t n = std::max(shape[shape.size() - 1], shape[shape.size() - 2]);
-        shape[shape.size() - 1] = n;
-        shape[shape.size() - 2] = n;
-        
-        A = A.expand(shape);
-        
-        // Add a small value to the diagonal to increase chances of invertibility
-        torch::Tensor eye = torch::eye(n, A.options());
-        if (A.dim() > 2) {
-            std::vector<int64_t> expanded_shape(A.dim(), 1);
-            expanded_shape[A.dim() - 2] = n;
-            expanded_shape[A.dim() - 1] = n;
-            eye = eye.expand(expanded_shape);
-        }
-        
-        A = A + eye * 0.1;
         
         // Create right-hand side B
         torch::Tensor B;
@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,8 +15,12 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create coefficient matrix A (must be triangular)
-        torch::Tensor A = fuzzer_utils::createTensor(Data, Size, offset);
+        // Create coefficient matrix A: nonsingular triangular, sometimes close
+        // to singular
+        const uint8_t kind_byte = Data[offset++];
+        torch::Tensor A = fuzzer_utils::createMatrix(
+            Data, Size, offset,
+            kind_byte % 4 == 0 ? fuzzer_utils::MatrixKind::NearSingular : fuzzer_utils::MatrixKind::Triangular);
         
         // Create right-hand side matrix B
         if (offset < Size) {
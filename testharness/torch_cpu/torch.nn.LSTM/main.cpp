@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -42,13 +42,17 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
         }
         
         // Create LSTM module
-        torch::nn::LSTM lstm_options = torch::nn::LSTM(
-            torch::nn::LSTMOptions(input.size(-1), hidden_size)
-                .num_layers(num_layers)
-                .dropout(dropout)
-                .bidirectional(bidirectional)
-                .batch_first(batch_first)
-        );
+        const int64_t input_size = input.size(-1);
+        torch::nn::LSTM lstm_options = fuzzer_utils::cachedModule<torch::nn::LSTM>(
+            fuzzer_utils::moduleKey("LSTM", input_size, +hidden_size, +num_layers, dropout, bidirectional, batch_first),
+            [&] {
+                return torch::nn::LSTM(
+                    torch::nn::LSTMOptions(input_size, hidden_size)
+                        .num_layers(num_layers)
+                        .dropout(dropout)
+                        .bidirectional(bidirectional)
+                        .batch_first(batch_first));
+            });
         
         // Prepare initial hidden state (h0, c0)
         int64_t batch_size = batch_first ? input.size(0) : input.size(1);
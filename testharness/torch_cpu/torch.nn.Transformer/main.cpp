@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -44,7 +44,10 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
         options.dim_feedforward(dim_feedforward);
         options.dropout(dropout);
         
-        auto transformer = torch::nn::Transformer(options);
+        auto transformer = fuzzer_utils::cachedModule<torch::nn::Transformer>(
+            fuzzer_utils::moduleKey("Transformer", d_model, nhead, num_encoder_layers,
+                                    num_decoder_layers, dim_feedforward, dropout),
+            [&] { return torch::nn::Transformer(options); });
         
         // Reshape tensors if needed to match transformer requirements
         // Transformer expects [sequence_length, batch_size, d_model]
@@ -1,3 +1,4 @@
+#define FUZZ_AUTOGRAD // Exercises autograd, so inputs do not run under InferenceMode
 #include "fuzzer_utils.h" // General fuzzing utilities
 #include <iostream>       // For cerr
 #include <tuple>          // For std::get with lu_unpack result
@@ -5,7 +6,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -48,6 +49,14 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             
             // Backward pass
             output_with_grad.backward(grad_output);
+            
+            // Check the gradient against finite differences; a mismatch is already
+            // stored under diff_inputs/, so keep the input
+            const bool grad_ok = fuzzer_utils::gradCheck(
+                [&](const std::vector<torch::Tensor> &x) { return logsigmoid->forward(x[0]); }, {input}, Data, Size);
+            if (!grad_ok) {
+                return 0;
+            }
         }
     }
     catch (const std::exception &e)
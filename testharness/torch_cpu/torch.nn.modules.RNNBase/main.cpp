@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -96,10 +96,16 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
         
         torch::nn::RNN rnn_module = nullptr;
         
+        // Modules are reused across inputs with the same configuration
+        const std::string module_key = fuzzer_utils::moduleKey(
+            mode.c_str(), input_size, hidden_size, num_layers, bias, batch_first, dropout, bidirectional);
+        
         if (mode == "RNN_TANH") {
-            rnn_module = torch::nn::RNN(rnn_options.nonlinearity(torch::kTanh));
+            rnn_module = fuzzer_utils::cachedModule<torch::nn::RNN>(
+                module_key, [&] { return torch::nn::RNN(rnn_options.nonlinearity(torch::kTanh)); });
         } else if (mode == "RNN_RELU") {
-            rnn_module = torch::nn::RNN(rnn_options.nonlinearity(torch::kReLU));
+            rnn_module = fuzzer_utils::cachedModule<torch::nn::RNN>(
+                module_key, [&] { return torch::nn::RNN(rnn_options.nonlinearity(torch::kReLU)); });
         } else if (mode == "LSTM") {
             auto lstm_options = 
                 torch::nn::LSTMOptions(input_size, hidden_size)
@@ -109,7 +115,8 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
                     .dropout(dropout)
                     .bidirectional(bidirectional);
             
-            torch::nn::LSTM lstm_module(lstm_options);
+            torch::nn::LSTM lstm_module = fuzzer_utils::cachedModule<torch::nn::LSTM>(
+                module_key, [&] { return torch::nn::LSTM(lstm_options); });
             
             // Try to reshape input tensor to match LSTM requirements if needed
             try {
@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,8 +15,8 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create input tensor
-        torch::Tensor input_tensor = fuzzer_utils::createTensor(Data, Size, offset);
+        // Create a quint8 tensor with a valid scale and zero point
+        torch::Tensor quantized_input = fuzzer_utils::createQuantizedTensor(Data, Size, offset, torch::kQUInt8);
         
         // Get parameters for ELU from the remaining data
         double alpha = 1.0;
@@ -25,39 +25,6 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             offset += sizeof(double);
         }
         
-        // Get scale and zero_point for quantization
-        double scale = 0.1;
-        if (offset + sizeof(double) <= Size) {
-            std::memcpy(&scale, Data + offset, sizeof(double));
-            offset += sizeof(double);
-            // Ensure scale is positive
-            scale = std::abs(scale);
-            if (scale < 1e-6) scale = 0.1;
-        }
-        
-        int64_t zero_point = 0;
-        if (offset + sizeof(int64_t) <= Size) {
-            std::memcpy(&zero_point, Data + offset, sizeof(int64_t));
-            offset += sizeof(int64_t);
-        }
-        
-        // Quantize the input tensor
-        torch::Tensor quantized_input;
-        try {
-            // Convert to float if not already
-            if (input_tensor.scalar_type() != torch::kFloat) {
-                input_tensor = input_tensor.to(torch::kFloat);
-            }
-            
-            // Quantize the tensor
-            quantized_input = torch::quantize_per_tensor(
-                input_tensor, scale, zero_point, torch::kQUInt8);
-        } catch (const std::exception& e) {
-            // If quantization fails, try with default parameters
-            quantized_input = torch::quantize_per_tensor(
-                input_tensor.to(torch::kFloat), 0.1, 0, torch::kQUInt8);
-        }
-        
         // Apply quantized ELU using functional interface
         try {
             auto output = torch::nn::functional::elu(quantized_input, torch::nn::functional::ELUFuncOptions().alpha(alpha));
@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,8 +15,8 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create input tensor
-        torch::Tensor input_tensor = fuzzer_utils::createTensor(Data, Size, offset);
+        // Create a qint8 tensor with a valid scale and zero point
+        torch::Tensor quantized_input = fuzzer_utils::createQuantizedTensor(Data, Size, offset, torch::kQInt8);
         
         // Extract parameters for LeakyReLU
         float negative_slope = 0.01f; // Default value
@@ -25,43 +25,6 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             offset += sizeof(float);
         }
         
-        // Get scale and zero_point for quantization
-        double scale = 0.1;
-        if (offset + sizeof(double) <= Size) {
-            std::memcpy(&scale, Data + offset, sizeof(double));
-            offset += sizeof(double);
-            // Ensure scale is positive and not too small
-            scale = std::abs(scale);
-            if (scale < 1e-10) scale = 0.1;
-        }
-        
-        int64_t zero_point = 0;
-        if (offset + sizeof(int64_t) <= Size) {
-            std::memcpy(&zero_point, Data + offset, sizeof(int64_t));
-            offset += sizeof(int64_t);
-            // Ensure zero_point is in valid range for int8
-            zero_point = std::max<int64_t>(std::min<int64_t>(zero_point, 127), -128);
-        }
-        
-        // Quantize the input tensor
-        torch::Tensor quantized_input;
-        try {
-            // Convert to float if not already
-            if (input_tensor.scalar_type() != torch::kFloat) {
-                input_tensor = input_tensor.to(torch::kFloat);
-            }
-            
-            // Quantize the tensor
-            quantized_input = torch::quantize_per_tensor(
-                input_tensor, scale, zero_point, torch::kQInt8);
-        } catch (const std::exception& e) {
-            // If quantization fails, create a simple quantized tensor
-            auto options = torch::TensorOptions().dtype(torch::kFloat);
-            auto simple_tensor = torch::ones({2, 2}, options);
-            quantized_input = torch::quantize_per_tensor(
-                simple_tensor, 0.1, 0, torch::kQInt8);
-        }
-        
         // Apply quantized LeakyReLU operation directly using functional API
         torch::Tensor output = torch::nn::functional::leaky_relu(quantized_input, torch::nn::functional::LeakyReLUFuncOptions().negative_slope(negative_slope));
         
@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -14,49 +14,12 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create input tensor
-        torch::Tensor input_tensor = fuzzer_utils::createTensor(Data, Size, offset);
+        // Create a quint8 tensor with a valid scale and zero point
+        torch::Tensor q_input = fuzzer_utils::createQuantizedTensor(Data, Size, offset, torch::kQUInt8);
         
         // Ensure tensor has at least 3 dimensions (N, C, H, W) for MaxPool2d
-        if (input_tensor.dim() < 3) {
-            input_tensor = input_tensor.unsqueeze(0);
-        }
-        if (input_tensor.dim() < 3) {
-            input_tensor = input_tensor.unsqueeze(0);
-        }
-        if (input_tensor.dim() < 3) {
-            input_tensor = input_tensor.unsqueeze(0);
-        }
-        
-        // Quantize the input tensor
-        float scale = 0.1f;
-        int zero_point = 10;
-        
-        // Try to get scale and zero_point from the input data
-        if (offset + sizeof(float) + sizeof(int) <= Size) {
-            memcpy(&scale, Data + offset, sizeof(float));
-            offset += sizeof(float);
-            memcpy(&zero_point, Data + offset, sizeof(int));
-            offset += sizeof(int);
-        }
-        
-        // Ensure scale is positive and not too large
-        scale = std::abs(scale);
-        if (scale < 1e-6f) scale = 1e-6f;
-        if (scale > 1e6f) scale = 1e6f;
-        
-        // Ensure zero_point is within valid range for quint8
-        zero_point = std::max(0, std::min(zero_point, 255));
-        
-        // Quantize the tensor
-        torch::Tensor q_input;
-        try {
-            q_input = torch::quantize_per_tensor(input_tensor, scale, zero_point, torch::kQUInt8);
-        } catch (...) {
-            // If quantization fails, create a simple quantized tensor
-            auto options = torch::TensorOptions().dtype(torch::kFloat);
-            auto simple_tensor = torch::ones({1, 1, 4, 4}, options);
-            q_input = torch::quantize_per_tensor(simple_tensor, 0.1, 10, torch::kQUInt8);
+        while (q_input.dim() < 3) {
+            q_input = q_input.unsqueeze(0);
         }
         
         // Parse MaxPool2d parameters from the input data
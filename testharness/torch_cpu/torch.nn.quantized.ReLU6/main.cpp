@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,42 +15,8 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create a quantized tensor
-        torch::Tensor input_tensor = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // Get scale and zero_point for quantization
-        float scale = 0.1f;
-        int zero_point = 0;
-        
-        if (offset + sizeof(float) + sizeof(int) <= Size) {
-            std::memcpy(&scale, Data + offset, sizeof(float));
-            offset += sizeof(float);
-            
-            std::memcpy(&zero_point, Data + offset, sizeof(int));
-            offset += sizeof(int);
-        }
-        
-        // Ensure scale is positive and reasonable
-        scale = std::abs(scale);
-        if (scale < 1e-6f) scale = 1e-6f;
-        if (scale > 1e6f) scale = 1e6f;
-        
-        // Ensure zero_point is in valid range for int8
-        zero_point = std::max(-128, std::min(127, zero_point));
-        
-        // Convert to quantized tensor if not already quantized
-        torch::Tensor quantized_input;
-        if (!input_tensor.is_quantized()) {
-            // Quantize the tensor to qint8
-            quantized_input = torch::quantize_per_tensor(
-                input_tensor.to(torch::kFloat), 
-                scale, 
-                zero_point, 
-                torch::kQInt8
-            );
-        } else {
-            quantized_input = input_tensor;
-        }
+        // Create a quantized qint8 tensor with a valid scale and zero point
+        torch::Tensor quantized_input = fuzzer_utils::createQuantizedTensor(Data, Size, offset, torch::kQInt8);
         
         // Apply quantized ReLU6 using functional interface
         torch::Tensor output = torch::relu6(quantized_input);
@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,41 +15,8 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create a quantized tensor for testing
-        torch::Tensor input_tensor = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // For quantized operations, we need to quantize the tensor
-        // Get scale and zero_point from the remaining data
-        float scale = 0.1f;
-        int zero_point = 0;
-        
-        if (offset + sizeof(float) + sizeof(int) <= Size) {
-            std::memcpy(&scale, Data + offset, sizeof(float));
-            offset += sizeof(float);
-            std::memcpy(&zero_point, Data + offset, sizeof(int));
-            offset += sizeof(int);
-        }
-        
-        // Ensure scale is positive and reasonable
-        scale = std::abs(scale);
-        if (scale < 1e-6f) scale = 1e-6f;
-        if (scale > 1.0f) scale = 1.0f;
-        
-        // Ensure zero_point is in valid range for quint8
-        zero_point = std::max(0, std::min(zero_point, 255));
-        
-        // Convert to float tensor if not already
-        if (input_tensor.scalar_type() != torch::kFloat) {
-            input_tensor = input_tensor.to(torch::kFloat);
-        }
-        
-        // Quantize the tensor
-        torch::Tensor q_input = torch::quantize_per_tensor(
-            input_tensor, 
-            scale, 
-            zero_point, 
-            torch::kQUInt8
-        );
+        // Create a quint8 tensor with a valid scale and zero point
+        torch::Tensor q_input = fuzzer_utils::createQuantizedTensor(Data, Size, offset, torch::kQUInt8);
         
         // Apply quantized sigmoid using functional interface
         torch::Tensor output = torch::sigmoid(q_input);
@@ -63,6 +30,8 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
         
         // Optional: Test with different scale/zero_point
         if (offset + sizeof(float) + sizeof(int) <= Size) {
+            float scale = 0.1f;
+            int zero_point = 0;
             std::memcpy(&scale, Data + offset, sizeof(float));
             offset += sizeof(float);
             std::memcpy(&zero_point, Data + offset, sizeof(int));
@@ -73,9 +42,9 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             if (scale > 1.0f) scale = 1.0f;
             zero_point = std::max(0, std::min(zero_point, 255));
             
-            // Try with different quantization parameters
+            // Requantize the same values with different parameters
             torch::Tensor q_input2 = torch::quantize_per_tensor(
-                input_tensor, 
+                q_input.dequantize(), 
                 scale, 
                 zero_point, 
                 torch::kQUInt8
@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -15,80 +15,23 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
             return 0;
         }
         
-        // Create a quantized tensor to dequantize
-        torch::Tensor input_tensor = fuzzer_utils::createTensor(Data, Size, offset);
-        
-        // Get scale and zero_point for quantization
-        float scale = 0.1f;
-        int64_t zero_point = 0;
-        
-        // Use remaining data to influence scale and zero_point if available
-        if (offset + sizeof(float) <= Size) {
-            std::memcpy(&scale, Data + offset, sizeof(float));
-            offset += sizeof(float);
-            
-            // Ensure scale is positive and not too extreme
-            scale = std::abs(scale);
-            if (scale < 1e-10f) scale = 1e-10f;
-            if (scale > 1e10f) scale = 1e10f;
-        }
-        
-        if (offset + sizeof(int64_t) <= Size) {
-            std::memcpy(&zero_point, Data + offset, sizeof(int64_t));
-            offset += sizeof(int64_t);
-            
-            // Ensure zero_point is within valid range for int8
-            zero_point = std::max(std::min(zero_point, static_cast<int64_t>(127)), static_cast<int64_t>(-128));
-        }
-        
-        // Quantize the tensor first (we need a quantized tensor to dequantize)
+        // Create a quantized tensor to dequantize, with valid scales and
+        // zero points: per tensor (qint8 or quint8) or per channel (qint8)
+        uint8_t quant_type = Data[offset++];
         torch::Tensor quantized;
-        
-        // Try different quantization types based on input data
-        if (offset < Size) {
-            uint8_t quant_type = Data[offset++];
-            
-            if (quant_type % 3 == 0) {
-                // Per tensor quantization
-                quantized = torch::quantize_per_tensor(input_tensor, scale, zero_point, torch::kQInt8);
-            } else if (quant_type % 3 == 1) {
-                // Per channel quantization (if tensor has enough dimensions)
-                if (input_tensor.dim() > 0) {
-                    int64_t axis = 0;
-                    if (input_tensor.dim() > 1) {
-                        axis = Data[offset % Size] % input_tensor.dim();
-                    }
-                    
-                    // Create scales and zero_points for each channel
-                    int64_t num_channels = input_tensor.size(axis);
-                    std::vector<double> scales(num_channels, scale);
-                    std::vector<int64_t> zero_points(num_channels, zero_point);
-                    
-                    quantized = torch::quantize_per_channel(
-                        input_tensor, 
-                        torch::from_blob(scales.data(), {num_channels}, torch::kDouble).clone(),
-                        torch::from_blob(zero_points.data(), {num_channels}, torch::kLong).clone(),
-                        axis,
-                        torch::kQInt8
-                    );
-                } else {
-                    // Fallback to per tensor for scalars
-                    quantized = torch::quantize_per_tensor(input_tensor, scale, zero_point, torch::kQInt8);
-                }
-            } else {
-                // Try with different dtype
-                quantized = torch::quantize_per_tensor(input_tensor, scale, zero_point, torch::kQUInt8);
-            }
+        if (quant_type % 3 == 0) {
+            quantized = fuzzer_utils::createQuantizedTensor(Data, Size, offset, torch::kQInt8);
+        } else if (quant_type % 3 == 1) {
+            quantized = fuzzer_utils::createPerChannelQuantizedTensor(Data, Size, offset, torch::kQInt8);
         } else {
-            // Default quantization
-            quantized = torch::quantize_per_tensor(input_tensor, scale, zero_point, torch::kQInt8);
+            quantized = fuzzer_utils::createQuantizedTensor(Data, Size, offset, torch::kQUInt8);
         }
         
         // Apply dequantization using torch::dequantize function
         torch::Tensor dequantized = torch::dequantize(quantized);
         
         // Verify the dequantized tensor has the same shape as the original
-        if (dequantized.sizes() != input_tensor.sizes()) {
+        if (dequantized.sizes() != quantized.sizes()) {
             throw std::runtime_error("Dequantized tensor has different shape than input");
         }
         
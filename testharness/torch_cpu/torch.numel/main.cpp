@@ -5,7 +5,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -16,7 +16,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
         }
         
         // Create a tensor with various properties
-        torch::Tensor tensor = fuzzer_utils::createTensor(Data, Size, offset);
+        torch::Tensor tensor = fuzzer_utils::createTensorView(Data, Size, offset);
         
         // Apply torch.numel operation
         int64_t num_elements = tensor.numel();
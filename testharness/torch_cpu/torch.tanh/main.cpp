@@ -1,3 +1,4 @@
+#define FUZZ_AUTOGRAD // Exercises autograd, so inputs do not run under InferenceMode
 #include "fuzzer_utils.h" // General fuzzing utilities
 #include <iostream>       // For cerr
 #include <tuple>          // For std::get with lu_unpack result
@@ -5,7 +6,7 @@
 // --- Fuzzer Entry Point ---
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
-    std::cout << "Start Fuzzing" << std::endl;
+    FUZZ_TRACE_INPUT();
     try
     {
         size_t offset = 0;
@@ -52,6 +53,14 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
                     } catch (...) {
                         // Ignore backward errors
                     }
+                    
+                    // Check the gradient against finite differences; a mismatch is already
+                    // stored under diff_inputs/, so keep the input
+                    const bool grad_ok = fuzzer_utils::gradCheck(
+                        [](const std::vector<torch::Tensor> &x) { return torch::tanh(x[0]); }, {input3}, Data, Size);
+                    if (!grad_ok) {
+                        return 0;
+                    }
                 }
             }
         }
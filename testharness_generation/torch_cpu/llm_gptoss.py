@@ -84,6 +84,9 @@ def build_prompt(api_name: str, helper_dir: str, include_docs: bool = True) -> s
         "- Provide only one fenced code block with language `cpp`.\n"
         "- The file must be self-contained as a single `main.cpp`.\n"
         "- You may include and use `\"fuzzer_utils.h\"`.\n"
+        "- If the target uses autograd (backward, requires_grad, grad mode), put `#define FUZZ_AUTOGRAD` before including `\"fuzzer_utils.h\"`.\n"
+        "- When the target calls backward(), also call `fuzzer_utils::gradCheck([&](const std::vector<torch::Tensor>& x) { return <op>(x[0], ...); }, {inputs...}, data, size)` to compare its gradient with finite differences.\n"
+        "- Construct torch.nn modules through `fuzzer_utils::cachedModule<torch::nn::X>(fuzzer_utils::moduleKey(\"X\", <every constructor argument>), [&] { return torch::nn::X(options); })` so instances are reused across inputs.\n"
         "- Avoid excessive validation; let the API handle invalid inputs.\n"
         "- Focus on tensor construction variety (ranks, 0/1 dims, dtypes, shapes).\n"
         "- Implement `extern \"C\" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)`.\n"